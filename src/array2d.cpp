@@ -30,6 +30,18 @@ void array2dMoveRowsUp(float* arr,
 }
 
 
+void array2dMoveRowsUp(uint16_t* arr, 
+                       const int nRows, 
+                       const int nCols, 
+                       const int n)
+{
+    assert(n < nRows);
+    memmove(&arr[0], 
+            &arr[n * nCols], 
+            (nRows - n) * nCols * sizeof(uint16_t));
+}
+
+
 void array2dElementIndices(int* indicesArray,
                            const int nRowsQ,
                            const int nColsQ)
@@ -55,6 +67,46 @@ void array2dElementIndices(int* indicesArray,
 }
 
 
+void array2dElementIndicesOrdered(int* indicesArray,
+                                  const int nRowsQ,
+                                  const int nColsQ,
+                                  array2dDrawOrder order)
+{
+    bool colMajor = (order == ARRAY2D_COL_FORWARD || 
+                     order == ARRAY2D_COL_REVERSE);
+    bool reverse = (order == ARRAY2D_ROW_REVERSE || 
+                    order == ARRAY2D_COL_REVERSE);
+
+    int nOuter = colMajor ? nColsQ : nRowsQ;
+    int nInner = colMajor ? nRowsQ : nColsQ;
+
+    int baseIndex = 0;
+    for (int outer = 0; outer < nOuter; ++outer)
+    {
+        int k = reverse ? (nOuter - 1 - outer) : outer;
+
+        for (int inner = 0; inner < nInner; ++inner)
+        {
+            int i = colMajor ? inner : k;
+            int j = colMajor ? k : inner;
+
+            // same winding as array2dElementIndices
+            int v0 = i * (nColsQ + 1) + (j + 1);
+            int v2 = (i + 1) * (nColsQ + 1) + j;
+
+            indicesArray[baseIndex] = v0;
+            indicesArray[baseIndex + 1] = i * (nColsQ + 1) + j; // v1
+            indicesArray[baseIndex + 2] = v2;
+            indicesArray[baseIndex + 3] = v2;
+            indicesArray[baseIndex + 4] = (i + 1) * (nColsQ + 1) + (j + 1);// v3
+            indicesArray[baseIndex + 5] = v0;
+
+            baseIndex += 6;
+        }
+    }
+}
+
+
 void array2dPatchIndices(int* indicesArray,
                          const int nRowsQ,
                          const int nColsQ,
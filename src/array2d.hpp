@@ -14,6 +14,8 @@
 #ifndef ARRAY2D_HPP
 #define ARRAY2D_HPP
 
+#include <cstdint>
+
 /// For patchIndices
 ///
 typedef enum {
@@ -22,6 +24,16 @@ typedef enum {
 } array2dPatchOrder;
 
 
+/// For elementIndicesOrdered, the order in which the quads are visited
+///
+typedef enum {
+    ARRAY2D_ROW_FORWARD,    /// row by row from row 0, same as elementIndices
+    ARRAY2D_ROW_REVERSE,    /// row by row from the last row
+    ARRAY2D_COL_FORWARD,    /// column by column from column 0
+    ARRAY2D_COL_REVERSE     /// column by column from the last column
+} array2dDrawOrder;
+
+
 /// Index of a flattened 2D array in row-major order
 ///
 /// \param i        the row index of the 2D array, starts from i = 0
@@ -53,6 +65,13 @@ void array2dMoveRowsUp(float* arr,
                        const int nCols, 
                        const int n);
 
+/// array2dMoveRowsUp for 16-bit quantized arrays (see quantize.hpp)
+///
+void array2dMoveRowsUp(uint16_t* arr, 
+                       const int nRows, 
+                       const int nCols, 
+                       const int n);
+
 
 /// Indices for converting a quadrilateral grid into triangular elements
 ///
@@ -75,6 +94,27 @@ void array2dElementIndices(int* indicesArray,
                            const int nColsQ);
 
 
+/// Indices for converting a quadrilateral grid into triangular elements,
+/// with the quads visited in a given order (e.g. for front-to-back drawing)
+///
+/// Each quad has the same 6 indices as in array2dElementIndices, and the
+/// quads within a row (or column) are always visited forward
+///
+/// \param indicesArray     pointer to an array storing the element indices
+///                         (array must have a length of nRowsQ * nColsQ * 6)
+///
+/// \param nRowsQ           number of rows in the quads array
+///
+/// \param nColsQ           number of columns in the quads array
+///
+/// \param order            order of the quads
+///
+void array2dElementIndicesOrdered(int* indicesArray,
+                                  const int nRowsQ,
+                                  const int nColsQ,
+                                  array2dDrawOrder order);
+
+
 /// Indices for converting a quadrilateral grid into quadrilateral patches
 ///
 /// Example: 1x1 quad
@@ -0,0 +1,307 @@
+#include "audio_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "audio_stream.hpp"
+#include "wav_writer.hpp"
+
+namespace fs = std::filesystem;
+
+// content hashed from each end of the source file, size and modification
+// time catch most changes, the content catches files replaced by a copy
+static constexpr size_t s_HASHED_BYTES = 1 << 20;
+
+// frames copied from the decoder to the file per step
+static constexpr uint64_t s_STORE_CHUNK_FRAMES = 4096;
+
+static constexpr uint64_t s_DEFAULT_MAX_BYTES = 4ULL << 30;
+
+/// 64-bit FNV-1a hash, chained through seed
+static uint64_t s_fnv1a(const void* data, size_t len,
+                        uint64_t seed = 14695981039346656037ULL);
+
+
+AudioCache::AudioCache()
+    :   maxBytes(s_DEFAULT_MAX_BYTES),
+        isStoring(false),
+        cancel(false)
+{
+
+}
+
+
+AudioCache::~AudioCache()
+{
+    if (storeThread.joinable())
+    {
+        this->cancel.store(true);
+        storeThread.join();
+    }
+}
+
+
+void AudioCache::setDirectory(const char* directory)
+{
+    this->directory = directory;
+
+    if (!this->directory.empty())
+    {
+        std::error_code error;
+        fs::create_directories(this->directory, error);
+
+        if (error)
+        {
+            std::cout << "Audio cache: failed to create " << directory
+                      << ", " << error.message() << std::endl;
+            this->directory.clear();
+        }
+    }
+}
+
+
+void AudioCache::setMaxBytes(uint64_t maxBytes)
+{
+    this->maxBytes.store(maxBytes);
+}
+
+
+uint64_t AudioCache::getMaxBytes()
+{
+    return this->maxBytes.load();
+}
+
+
+std::string AudioCache::lookup(const char* sourcePath)
+{
+    if (directory.empty())
+    {
+        return "";
+    }
+
+    std::string path = entryPath(sourcePath);
+
+    std::error_code error;
+    if (path.empty() || !fs::exists(path, error))
+    {
+        return "";
+    }
+
+    // the modification time of an entry is its last use
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+    return path;
+}
+
+
+void AudioCache::storeAsync(const char* sourcePath)
+{
+    if (directory.empty() || isStoring.load())
+    {
+        return;
+    }
+
+    if (storeThread.joinable())
+    {
+        storeThread.join();
+    }
+
+    std::string path = entryPath(sourcePath);
+
+    std::error_code error;
+    if (path.empty() || fs::exists(path, error))
+    {
+        return;
+    }
+
+    this->cancel.store(false);
+    this->isStoring.store(true);
+    this->storeThread = std::thread(&AudioCache::storeWorker, this,
+                                    std::string(sourcePath), path);
+}
+
+
+bool AudioCache::getIsStoring()
+{
+    return this->isStoring.load();
+}
+
+
+std::string AudioCache::entryPath(const char* sourcePath)
+{
+    std::error_code error;
+    uint64_t size = fs::file_size(sourcePath, error);
+    if (error)
+    {
+        return "";
+    }
+
+    int64_t modifiedTime = fs::last_write_time(sourcePath, error)
+                           .time_since_epoch().count();
+    if (error)
+    {
+        return "";
+    }
+
+    FILE* file = fopen(sourcePath, "rb");
+    if (file == nullptr)
+    {
+        return "";
+    }
+
+    uint64_t key = s_fnv1a(&size, sizeof(size));
+    key = s_fnv1a(&modifiedTime, sizeof(modifiedTime), key);
+
+    // first and last MiB, the whole file if it is smaller
+    std::vector<unsigned char> buffer(s_HASHED_BYTES);
+
+    size_t nRead = fread(buffer.data(), 1, buffer.size(), file);
+    key = s_fnv1a(buffer.data(), nRead, key);
+
+    if (size > 2 * s_HASHED_BYTES)
+    {
+        fseek(file, -static_cast<long>(s_HASHED_BYTES), SEEK_END);
+        nRead = fread(buffer.data(), 1, buffer.size(), file);
+        key = s_fnv1a(buffer.data(), nRead, key);
+    }
+    else if (size > s_HASHED_BYTES)
+    {
+        nRead = fread(buffer.data(), 1, buffer.size(), file);
+        key = s_fnv1a(buffer.data(), nRead, key);
+    }
+
+    fclose(file);
+
+    char keyStr[17];
+    snprintf(keyStr, sizeof(keyStr), "%016llx",
+             static_cast<unsigned long long>(key));
+
+    return directory + "pcm_" + keyStr + ".wav";
+}
+
+
+void AudioCache::storeWorker(std::string sourcePath, std::string entryPath)
+{
+    AudioStream stream;
+    WavWriter writer;
+
+    // written aside, an entry is only visible once complete
+    std::string partPath = entryPath + ".part";
+
+    bool isStored = stream.open(sourcePath.c_str())
+                    && writer.open(partPath.c_str(),
+                                   stream.getChannels(),
+                                   stream.getSampleRate());
+
+    std::vector<float> buffer(s_STORE_CHUNK_FRAMES * stream.getChannels());
+    uint64_t frame = 0;
+
+    while (isStored && frame < stream.getTotalFrames())
+    {
+        if (cancel.load())
+        {
+            isStored = false;
+            break;
+        }
+
+        uint64_t nRead = stream.readFrames(buffer.data(), frame,
+                                           s_STORE_CHUNK_FRAMES);
+        if (nRead == 0)
+        {
+            // the decoder is behind
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        isStored = writer.write(buffer.data(), nRead);
+        frame += nRead;
+    }
+
+    stream.close();
+    isStored = writer.close() && isStored;
+
+    std::error_code error;
+    if (isStored)
+    {
+        fs::rename(partPath, entryPath, error);
+        isStored = !error;
+    }
+
+    if (isStored)
+    {
+        this->evict(entryPath);
+    }
+    else
+    {
+        fs::remove(partPath, error);
+    }
+
+    this->isStoring.store(false);
+}
+
+
+void AudioCache::evict(const std::string& keepPath)
+{
+    struct Entry
+    {
+        fs::file_time_type lastUse;
+        uint64_t size;
+        fs::path path;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+
+    std::error_code error;
+    for (const fs::directory_entry& file : fs::directory_iterator(directory, error))
+    {
+        std::string name = file.path().filename().string();
+        if (name.rfind("pcm_", 0) != 0 || file.path().extension() != ".wav")
+        {
+            continue;
+        }
+
+        Entry entry = {file.last_write_time(error), file.file_size(error), file.path()};
+        if (!error)
+        {
+            entries.push_back(entry);
+            totalBytes += entry.size;
+        }
+    }
+
+    // oldest first
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+
+    for (const Entry& entry : entries)
+    {
+        if (totalBytes <= maxBytes.load())
+        {
+            break;
+        }
+
+        // still mapped entries can't be removed on Windows, skipped then
+        if (entry.path != fs::path(keepPath) && fs::remove(entry.path, error))
+        {
+            totalBytes -= entry.size;
+        }
+    }
+}
+
+
+uint64_t s_fnv1a(const void* data, size_t len, uint64_t seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    uint64_t hash = seed;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+// On-disk cache of decoded audio
+//
+// MP3 and FLAC files are decoded once into float-32 WAV files in a cache
+// directory, which WavSource maps on later opens instead of decoding again.
+//
+// Entries are keyed by a hash of the source file's size, modification time,
+// and its first and last MiB of content. The least recently used entries
+// are removed when the directory grows over the size limit.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AUDIO_CACHE_HPP
+#define AUDIO_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class AudioCache
+{
+public:
+    AudioCache();
+    ~AudioCache();
+
+    AudioCache(const AudioCache&) = delete;
+    AudioCache& operator=(const AudioCache&) = delete;
+
+    /// Set the cache directory, created if missing, call before any lookup
+    ///
+    /// \param directory    path ending with a separator,
+    ///                     an empty string disables the cache
+    ///
+    void setDirectory(const char* directory);
+
+    /// \param maxBytes     size limit of the cache directory
+    ///
+    void setMaxBytes(uint64_t maxBytes);
+    uint64_t getMaxBytes();
+
+    /// \return     path of the decoded float-32 WAV of the source file,
+    ///             empty if it is not cached
+    ///
+    std::string lookup(const char* sourcePath);
+
+    /// Decode an MP3 or FLAC file into the cache on a background thread,
+    /// skipped if another file is being stored
+    ///
+    void storeAsync(const char* sourcePath);
+
+    /// \return     whether the background thread is decoding
+    ///
+    bool getIsStoring();
+
+private:
+    std::string directory;
+    std::atomic<uint64_t> maxBytes;
+
+    std::thread storeThread;
+    std::atomic_bool isStoring;
+    std::atomic_bool cancel;
+
+    /// \return     entry path of the source file, empty if it can't be read
+    std::string entryPath(const char* sourcePath);
+
+    void storeWorker(std::string sourcePath, std::string entryPath);
+
+    /// Remove the least recently used entries until under maxBytes,
+    /// keepPath is never removed
+    void evict(const std::string& keepPath);
+};
+
+#endif
@@ -1,354 +1,484 @@
 #include "audio_player.hpp"
-
+#include "audio_stream.hpp"
+#include "converted_source.hpp"
+#include "wav_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <string>
 
-#define DR_MP3_IMPLEMENTATION
-#define DR_FLAC_IMPLEMENTATION
-#include "dr_libs/dr_mp3.h"
-#include "dr_libs/dr_flac.h"
-
 void audioPlayerAudioCallback(void* userdata, Uint8* stream, int callbackBufferSize);
 
+/// Query the format the device runs at, SDL 2.0.16 for named devices and
+/// 2.24 for the default one
+///
+/// \return     false if it isn't known
+///
+static bool s_getDeviceSpec(const char* deviceName, SDL_AudioSpec* spec);
+
 AudioPlayer::AudioPlayer()//const char* filepath)
     :   device(0),
-        audioStartPtr(nullptr), audioSize(0), // will be changed after loading
-         audioBytePos(0),
+        totalFrames(0), // will be changed after loading
+        hasLoop(false),
+        loopStartSec(0.0),
+        loopEndSec(0.0),
+        playbackSource(nullptr),
+        isNativeSpecKnown(false),
         numDevices(0),
-        isPaused(true),
-        bytesPerSample(sizeof(float)) // will convert everything to float
+        bytesPerSample(sizeof(float)), // will convert everything to float
+        audioFormat(AudioFormat::UNKNOWN),
+        isCacheEnabled(false),
+        isCached(false),
+        loadedIsCached(false),
+        isLoading(false),
+        loadReady(false),
+        loadThroughputMBs(0.0),
+        loadedFormat(AudioFormat::UNKNOWN)
 {
-    
+    // no channels and no rate until a file is loaded
+    SDL_zero(audioSpec);
+    SDL_zero(nativeSpec);
 }
 
 
 AudioPlayer::~AudioPlayer()
 {
-    if (audioStartPtr != nullptr)
-    {
-        switch (audioFormat)
-        {
-            case AudioFormat::MP3:
-                drmp3_free(audioStartPtr, nullptr);
-                break;
-            case AudioFormat::WAV:
-                SDL_FreeWAV(audioStartPtr);
-                break;
-            case AudioFormat::FLAC:
-                drflac_free(audioStartPtr, NULL);
-                break;
-            default:
-                break;
-        }
+    this->cancelLoad();
 
-        audioStartPtr = nullptr;
-    }
-    else
-    {
-        // nothing, already cleared
-    }
+    // stop the callback before freeing what it reads
+    this->closeDevice();
+    this->unloadFile();
+}
 
 
-    if (device != 0)
-    {
-        SDL_CloseAudioDevice(device);
-    }
+void AudioPlayer::unloadFile()
+{
+    // unmaps the file or stops the decoder thread
+    this->playbackSource = nullptr;
+    this->convertedSource.reset();
+    this->audioSource.reset();
+
+    this->totalFrames = 0;
+    this->transport.reset(0);
+    this->hasLoop = false;
+    this->audioFormat = AudioFormat::UNKNOWN;
+    this->isCached.store(false);
 }
 
 
-void AudioPlayer::wavToFloat(const char* filepath)
+std::unique_ptr<AudioSource> AudioPlayer::openSource(const char* filepath, 
+                                                     AudioFormat format)
 {
-    if (SDL_LoadWAV(filepath, &audioSpec, &audioStartPtr, &audioSize) == nullptr)
+    if (format == AudioFormat::WAV)
     {
-        std::cout << "Failed to load audio: " << SDL_GetError() << std::endl;
+        std::unique_ptr<WavSource> wavSource(new WavSource());
+
+        if (wavSource->open(filepath, &loadStatus))
+        {
+            return wavSource;
+        }
     }
     else
     {
-        // no need to callback now, we will callback after setting desired specs
-    }
+        // decoded before, map it instead
+        std::string cachePath = isCacheEnabled.load() 
+                                ? audioCache.lookup(filepath) : "";
 
-    // copying audioSpec to desiredSpec and change format to float
-    SDL_AudioSpec desiredSpec;
-    desiredSpec.freq = audioSpec.freq;
-    desiredSpec.format = AUDIO_F32SYS;
-    desiredSpec.channels = audioSpec.channels;
-    desiredSpec.samples = audioSpec.samples;
-    desiredSpec.callback = audioPlayerAudioCallback;  
-    desiredSpec.userdata = this;            // pass the AudioPlayer object to callback
-
-    // build the audio converter
-    SDL_AudioCVT cvt;
-    if (SDL_BuildAudioCVT(&cvt,
-                          audioSpec.format,
-                          audioSpec.channels,
-                          audioSpec.freq,
-                          desiredSpec.format,
-                          desiredSpec.channels,
-                          desiredSpec.freq) < 0)
-    {
-        std::cout << "Failed to build audio converter: " << SDL_GetError() << std::endl;
-    }
-    else if (cvt.needed)
-    {
-        cvt.len = audioSize;
-        cvt.buf = (Uint8*)SDL_malloc(cvt.len * cvt.len_mult);
-        
-        // if cvt buffer allocation failed, i.e. nullptr
-        if (!cvt.buf) // if nullptr
+        if (!cachePath.empty())
         {
-            std::cout << "Failed to allocate memory for audio conversion: " << SDL_GetError() << std::endl;
-        }
-        // cvt buffer allocation success 
-        else
-        {
-            // copy the original audio data into the converter buffer
-            memcpy(cvt.buf, audioStartPtr, audioSize);
+            std::unique_ptr<WavSource> wavSource(new WavSource());
 
-            // perform the conversion
-            if (SDL_ConvertAudio(&cvt) < 0)
+            if (wavSource->open(cachePath.c_str(), &loadStatus))
             {
-                std::cout << "Audio conversion failed: " << SDL_GetError() << std::endl;
-                SDL_free(cvt.buf);
+                this->loadedIsCached = true;
+                return wavSource;
             }
-            else
-            {
-                // replace audioStartPtr and audioSize with the converted data
-                SDL_FreeWAV(audioStartPtr); // free the original WAV data
-                audioStartPtr = cvt.buf;
-                audioSize = cvt.len_cvt;
+        }
+
+        std::unique_ptr<AudioStream> audioStream(new AudioStream());
 
-                // update the audioSpec to the desired format
-                audioSpec = desiredSpec;
+        if (audioStream->open(filepath, &loadStatus))
+        {
+            if (isCacheEnabled.load())
+            {
+                audioCache.storeAsync(filepath);
             }
+            return audioStream;
         }
     }
+
+    return nullptr;
+}
+
+
+void AudioPlayer::loadFile(const char* filepath)
+{
+    // determine the file type base on the extension
+    std::string filePathStr(filepath);
+    std::string extension = filePathStr.substr(filePathStr.find_last_of('.') + 1);
+
+    AudioFormat format;
+
+    if (extension == "mp3" or extension == "MP3")
+    {
+        format = AudioFormat::MP3;
+    }    
+    else if (extension == "wav" or extension == "WAV")
+    {
+        format = AudioFormat::WAV;
+    }
+    else if (extension == "flac" or extension == "FLAC")
+    {
+        format = AudioFormat::FLAC;
+    }
     else
     {
-        // nothing
+        std::cout << "Unsupported audio format: " << extension << std::endl;
+        return;
     }
+
+    // only the latest file is loaded
+    this->cancelLoad();
+
+    this->loadStatus.bytesDone.store(0);
+    this->loadStatus.bytesTotal.store(0);
+    this->loadStatus.cancel.store(false);
+
+    this->isLoading.store(true);
+    this->loaderThread = std::thread(&AudioPlayer::loadWorker, this, 
+                                     filePathStr, format);
 }
 
 
-void AudioPlayer::mp3ToFloat(const char* filepath)
+void AudioPlayer::loadWorker(std::string filepath, AudioFormat format)
 {
-    drmp3_config config;
-    drmp3_uint64 frameCount;
+    auto loadStart = std::chrono::steady_clock::now();
+    this->loadedIsCached = false;
 
-    float* pSampleData = drmp3_open_file_and_read_pcm_frames_f32(filepath, 
-                                                                  &config, 
-                                                                  &frameCount, 
-                                                                  nullptr);
-    
-    if (pSampleData == nullptr)
+    std::unique_ptr<AudioSource> source = openSource(filepath.c_str(), format);
+
+    std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() 
+                                             - loadStart;
+    if (loadTime.count() > 0.0)
     {
-        std::cout << "Failed to load MP3 file: " << filepath << std::endl;
-        return; 
+        this->loadThroughputMBs.store(
+            1e-6 * loadStatus.bytesDone.load() / loadTime.count());
     }
 
-    // assign dr_mp3 specs into SDL_Audio specs
-    audioSpec.channels = config.channels;
-    audioSpec.freq = config.sampleRate;
-    audioSpec.format = AUDIO_F32SYS;
-    audioSpec.samples = 4096; // default SDL buffer size
-    audioSpec.callback = audioPlayerAudioCallback;
-    audioSpec.userdata = this;
+    if (source && !loadStatus.cancel.load())
+    {
+        // handed over to the GUI thread by loadReady
+        this->loadedSource = std::move(source);
+        this->loadedFormat = format;
+        this->loadReady.store(true, std::memory_order_release);
+    }
 
-    // assign dr_mp3 data to AudioPlayer 
-    // yeah, casting ptr, not the best, but I need the memory address
-    this->audioStartPtr = (Uint8*)pSampleData;
-    this->audioSize = frameCount * config.channels * sizeof(float);
-    
-    // we need the data later, no freeing pSampleData
-    pSampleData = nullptr;
-    
+    this->isLoading.store(false);
 }
 
 
-void AudioPlayer::flacToFloat(const char* filepath)
+bool AudioPlayer::pollLoad()
 {
-    unsigned int channels;
-    unsigned int sampleRate;
-    drflac_uint64 totalPCMFrameCount;
-    float* pSampleData = drflac_open_file_and_read_pcm_frames_f32(filepath, 
-                                                                  &channels, 
-                                                                  &sampleRate, 
-                                                                  &totalPCMFrameCount, 
-                                                                  NULL);
-    if (pSampleData == NULL) 
+    if (!loadReady.load(std::memory_order_acquire))
     {
-        std::cout << "Failed to load FLAC file: " << filepath << std::endl;
-    }    
+        return false;
+    }
+
+    loaderThread.join();
+    this->loadReady.store(false);
+
+    // the callback reads the old audio until the device is closed
+    this->pause();
+    this->closeDevice();
+    this->unloadFile();
 
-    // assign dr_flac specs into SDL_Audio specs
-    audioSpec.channels = channels;
-    audioSpec.freq = sampleRate;
-    audioSpec.format = AUDIO_F32SYS;
-    audioSpec.samples = 4096; // default SDL buffer size
-    audioSpec.callback = audioPlayerAudioCallback;
-    audioSpec.userdata = this;
+    this->audioSource = std::move(loadedSource);
+    this->audioFormat = loadedFormat;
+    this->isCached.store(loadedIsCached);
 
-    // assign dr_flac data to AudioPlayer 
-    // yeah, casting ptr, not the best, but I need the memory address
-    this->audioStartPtr = (Uint8*)pSampleData;
-    this->audioSize = totalPCMFrameCount * channels * sizeof(float);
+    // on the device picked before, if any
+    this->setupDevice(deviceName.empty() ? nullptr : deviceName.c_str());
 
-    // we need the data later, no freeing pSampleData
-    pSampleData = nullptr;
+    return true;
 }
 
 
-void AudioPlayer::loadFile(const char* filepath)
+void AudioPlayer::cancelLoad()
 {
-    // determine the file type base on the extension
-    std::string filePathStr(filepath);
-    std::string extension = filePathStr.substr(filePathStr.find_last_of('.') + 1);
-
-    if (extension == "mp3" or extension == "MP3")
-    {
-        mp3ToFloat(filepath);
-        this->audioFormat = AudioFormat::MP3;
-    }    
-    else if (extension == "wav" or extension == "WAV")
+    if (loaderThread.joinable())
     {
-        wavToFloat(filepath);
-        this->audioFormat = AudioFormat::WAV;
+        this->loadStatus.cancel.store(true);
+        loaderThread.join();
     }
-    else if (extension == "flac" or extension == "FLAC")
+
+    this->loadedSource.reset();
+    this->loadReady.store(false);
+}
+
+
+bool AudioPlayer::getIsLoading()
+{
+    return this->isLoading.load() || this->loadReady.load();
+}
+
+
+float AudioPlayer::getLoadProgress()
+{
+    uint64_t bytesTotal = loadStatus.bytesTotal.load();
+
+    if (bytesTotal == 0)
     {
-        flacToFloat(filepath);
-        this->audioFormat = AudioFormat::FLAC;
-    }
-    else
-    {
-        std::cout << "Unsupported audio format: " << extension << std::endl;
-        return;
+        return 0.0f;
     }
 
-    this->setupDevice();
+    return std::min(1.0f, static_cast<float>(loadStatus.bytesDone.load()) 
+                          / static_cast<float>(bytesTotal));
+}
+
+
+double AudioPlayer::getLoadThroughputMBs()
+{
+    return this->loadThroughputMBs.load();
+}
+
+
+double AudioPlayer::getDecodeThroughputMBs()
+{
+    return audioSource ? audioSource->getDecodeThroughputMBs() : 0.0;
 }
 
 
 void AudioPlayer::play()
 {
-    // queue the audio (so we play when available,
-    // as oppososed to a callback function)
-    this->isPaused.store(false);
-    // int status = SDL_QueueAudio(device, audioStartPtr, audioSize);
-    SDL_PauseAudioDevice(device, 0);    
+    // the device keeps running, the callback starts on its next block
+    transport.play();
+    this->applyWithoutDevice();
 }
 
 
 void AudioPlayer::pause()
 {
-    SDL_PauseAudioDevice(device, 1);
-    this->isPaused.store(true);
+    transport.pause();
+    this->applyWithoutDevice();
 }
 
 
 void AudioPlayer::skipBackward()
 {
-    this-> audioBytePos = 0;
+    transport.seek(0);
+    this->applyWithoutDevice();
 }
 
 
 bool AudioPlayer::getIsPaused()
 {
-    return this->isPaused.load();
+    return !transport.getIsPlaying();
 }
 
 
-void AudioPlayer::setAudioPosition(Uint32 toTimeSec)
+void AudioPlayer::setAudioPosition(double toTimeSec)
 {
-    // std::lock_guard<std::mutex> lock(audioMutex);
+    transport.seek(this->secToFrame(toTimeSec));
+    this->applyWithoutDevice();
+}
 
-    Uint32 bytesPerSec = audioSpec.freq * audioSpec.channels * bytesPerSample;
 
-    // clamp
-    this->audioBytePos.store(std::min(toTimeSec * bytesPerSec, audioSize));
+bool AudioPlayer::setLoopRegion(double startSec, double endSec)
+{
+    if (!transport.setLoop(this->secToFrame(startSec), this->secToFrame(endSec)))
+    {
+        return false;
+    }
+
+    // kept in seconds for a device at another rate
+    this->hasLoop = true;
+    this->loopStartSec = startSec;
+    this->loopEndSec = endSec;
+
+    this->applyWithoutDevice();
+    return true;
 }
 
 
-float AudioPlayer::getCurrentTimeSec()
+void AudioPlayer::clearLoopRegion()
 {
-    Uint32 bytesPerSec = audioSpec.freq * audioSpec.channels * bytesPerSample;
+    transport.clearLoop();
+    this->hasLoop = false;
+    this->applyWithoutDevice();
+}
+
+
+bool AudioPlayer::getIsLooping()
+{
+    return this->hasLoop;
+}
+
+
+uint64_t AudioPlayer::secToFrame(double timeSec)
+{
+    double frame = std::round(timeSec * audioSpec.freq);
 
-    if (bytesPerSec == 0)
+    // clamp
+    frame = std::fmax(frame, 0.0);
+    return std::min(static_cast<uint64_t>(frame), totalFrames);
+}
+
+
+void AudioPlayer::applyWithoutDevice()
+{
+    // no callback to take the commands, e.g. the device failed to open
+    if (device == 0)
     {
-        return 0;
+        transport.beginBlock();
+        transport.endBlock();
     }
+}
+
+
+int AudioPlayer::getDeviceFreq()
+{
+    return (device != 0) ? audioSpec.freq : 0;
+}
+
+
+int AudioPlayer::getDeviceChannels()
+{
+    return (device != 0) ? audioSpec.channels : 0;
+}
+
+
+int AudioPlayer::getDeviceBufferFrames()
+{
+    return (device != 0) ? audioSpec.samples : 0;
+}
+
+
+bool AudioPlayer::getIsConverting()
+{
+    return convertedSource != nullptr;
+}
+
 
-    // std::lock_guard<std::mutex> lock(audioMutex);
-    Uint32 playedBytes = this->audioBytePos.load();
+bool AudioPlayer::getIsDeviceNative()
+{
+    return device != 0
+           && isNativeSpecKnown
+           && audioSpec.freq == nativeSpec.freq
+           && audioSpec.channels == nativeSpec.channels
+           && nativeSpec.format == AUDIO_F32SYS;
+}
 
-    float playedTimeSec =   static_cast<float>(playedBytes) 
-                          / static_cast<float>(bytesPerSec);
 
-    float totalDurationSec = this->getTotalTimeSec();
-    if (playedTimeSec > totalDurationSec)
+double AudioPlayer::getCurrentTimeSec()
+{
+    if (audioSpec.freq == 0)
     {
-        playedTimeSec = totalDurationSec;
+        return 0;
     }
 
-    return playedTimeSec;
+    uint64_t playedFrames = std::min(transport.getPosition(), totalFrames);
+
+    return static_cast<double>(playedFrames) / audioSpec.freq;
 }
 
 
-float AudioPlayer::getTotalTimeSec()
+double AudioPlayer::getTotalTimeSec()
 {
-    Uint32 bytesPerSec = audioSpec.freq * audioSpec.channels * bytesPerSample;
-
-    if (bytesPerSec == 0)
+    if (audioSpec.freq == 0)
     {
         return 0;
     }
 
-    return static_cast<float>(audioSize) / static_cast<float>(bytesPerSec); 
+    return static_cast<double>(totalFrames) / audioSpec.freq;
+}
+
+
+uint64_t AudioPlayer::getCurrentFrame()
+{
+    return transport.getPosition();
+}
+
+
+uint64_t AudioPlayer::getTotalFrames()
+{
+    return this->totalFrames;
 }
 
 
 int AudioPlayer::getFreq()
 {
-    return audioSpec.freq;
+    return audioSource ? audioSource->getSampleRate() : 0;
 }
 
 
-void AudioPlayer::getAudioData(float* buffer, int numSamples)
+int AudioPlayer::getChannels()
+{
+    return audioSource ? audioSource->getChannels() : 0;
+}
+
+
+void AudioPlayer::getAudioData(float* buffer, int numFrames)
 {   
-    // determining the buffer size 
-    Uint32 bufferSize = (numSamples * sizeof(float));
+    int channels = this->getChannels();
+    uint64_t nFrames = static_cast<uint64_t>(numFrames);
     
-    if (!(isPaused.load()))
+    if (transport.getIsPlaying() && audioSource && audioSpec.freq > 0)
     {
-        Uint32 currentBytePos = this->audioBytePos.load();
+        // the file's own frames, the device may run at another rate
+        uint64_t currentFrame = transport.getPosition() 
+                                * audioSource->getSampleRate() / audioSpec.freq;
         
         // ignore audio data when it is smaller than the buffer (i.e start)
-        if (( currentBytePos > bufferSize) &&
-            ( currentBytePos < audioSize))
+        if (( currentFrame > nFrames) &&
+            ( currentFrame < audioSource->getTotalFrames()))
         {
-            // buffer start position in the audio stream, in bytes
-            Uint32 bufferStartPosition = currentBytePos - bufferSize;
-
-            // pointer to the data start point
-            Uint8* dataPtr = audioStartPtr + bufferStartPosition;
-
-            // copy audio stream data to the buffer
-            // (already converted to float in constructor)
-            memcpy(buffer, dataPtr, bufferSize);
+            // from the source, for streams the history kept behind
+            // the playback position
+            audioSource->peekFrames(buffer, currentFrame - nFrames, nFrames);
         }
         else
         {
             // fill in with zero if there is not enough audio samples in the stream
-            memset(buffer, 0, bufferSize);
+            memset(buffer, 0, numFrames * channels * sizeof(float));
         }
     }
     else
     {
         // fill in with zero if audio stream is paused
-        memset(buffer, 0, bufferSize);        
+        memset(buffer, 0, numFrames * channels * sizeof(float));        
     }
 }
 
 
+void AudioPlayer::setCacheDirectory(const char* directory)
+{
+    // the loader thread reads the directory
+    this->cancelLoad();
+    audioCache.setDirectory(directory);
+}
+
+
+void AudioPlayer::setCacheEnabled(bool enabled)
+{
+    this->isCacheEnabled.store(enabled);
+}
+
+
+void AudioPlayer::setCacheMaxBytes(uint64_t maxBytes)
+{
+    audioCache.setMaxBytes(maxBytes);
+}
+
+
+bool AudioPlayer::getIsCached()
+{
+    return this->isCached.load();
+}
+
+
 std::vector<std::string> AudioPlayer::getAvailableDevices()
 {
     this->numDevices = SDL_GetNumAudioDevices(0); // 0 for playback devices
@@ -371,6 +501,7 @@ void AudioPlayer::closeDevice()
     if (device != 0)
     {
         SDL_CloseAudioDevice(device);
+        this->device = 0;
     }
     else
     {
@@ -381,66 +512,199 @@ void AudioPlayer::closeDevice()
 
 void AudioPlayer::setupDevice(const char* deviceName)
 {
-    // close the previously opened audio device if it exists
-    if (device != 0)
+    // kept for the next files
+    this->deviceName = deviceName ? deviceName : "";
+
+    // carried over to the new device, which may run at another rate
+    double positionSec = this->getCurrentTimeSec();
+    bool wasPlaying = transport.getIsPlaying();
+
+    // the callback stops before its source changes
+    this->closeDevice();
+    this->playbackSource = nullptr;
+    this->convertedSource.reset();
+
+    if (!audioSource)
     {
-        SDL_CloseAudioDevice(device);
+        // opened once a file is loaded
+        return;
+    }
+
+    int sourceRate = audioSource->getSampleRate();
+    int sourceChannels = audioSource->getChannels();
+
+    SDL_AudioSpec desiredSpec;
+    SDL_zero(desiredSpec);
+    desiredSpec.freq = sourceRate;
+    desiredSpec.channels = sourceChannels;
+    desiredSpec.format = AUDIO_F32SYS;
+    desiredSpec.samples = 4096; // default SDL buffer size
+    desiredSpec.callback = audioPlayerAudioCallback;
+    desiredSpec.userdata = this;
+
+    // ask for what the device runs at, so SDL has nothing to convert
+    this->isNativeSpecKnown = s_getDeviceSpec(deviceName, &nativeSpec);
+
+    if (isNativeSpecKnown)
+    {
+        if (nativeSpec.freq > 0)
+        {
+            desiredSpec.freq = nativeSpec.freq;
+        }
+        if (nativeSpec.channels > 0)
+        {
+            desiredSpec.channels = nativeSpec.channels;
+        }
     }
 
-    // set the device for playback for 0, or '1' for recording.
-    device = SDL_OpenAudioDevice(
-        deviceName, 0, &audioSpec, nullptr, SDL_AUDIO_ALLOW_ANY_CHANGE
+    // the format stays float, the callback only copies floats
+    this->device = SDL_OpenAudioDevice(
+        deviceName, 0, &desiredSpec, &audioSpec,
+        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE 
+        | SDL_AUDIO_ALLOW_CHANNELS_CHANGE 
+        | SDL_AUDIO_ALLOW_SAMPLES_CHANGE
     );
-    
 
     if (device == 0)
     {
         std::cout << "AudioPlayer device error: " << SDL_GetError() << std::endl; 
-    }  
+
+        // keep the timeline of the file without a device
+        this->audioSpec = desiredSpec;
+        audioSpec.freq = sourceRate;
+        audioSpec.channels = sourceChannels;
+    }
+
+    if (audioSpec.freq != sourceRate || audioSpec.channels != sourceChannels)
+    {
+        // converted once here rather than by SDL behind the callback
+        this->convertedSource.reset(new ConvertedSource(audioSource.get(),
+                                                        audioSpec.channels,
+                                                        audioSpec.freq));
+        this->playbackSource = convertedSource.get();
+    }
+    else
+    {
+        this->playbackSource = audioSource.get();
+    }
+
+    this->totalFrames = playbackSource->getTotalFrames();
+
+    // no callback yet, taken with its first block
+    transport.reset(totalFrames);
+    transport.seek(this->secToFrame(positionSec));
+    if (hasLoop)
+    {
+        transport.setLoop(this->secToFrame(loopStartSec), this->secToFrame(loopEndSec));
+    }
+    if (wasPlaying)
+    {
+        transport.play();
+    }
+
+    if (device != 0)
+    {
+        // runs until closed, silent while the transport is stopped
+        SDL_PauseAudioDevice(device, 0);
+    }
+    else
+    {
+        this->applyWithoutDevice();
+    }
+}
+
+
+bool s_getDeviceSpec(const char* deviceName, SDL_AudioSpec* spec)
+{
+    SDL_zero(*spec);
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+    if (deviceName == nullptr)
+    {
+        char* defaultName = nullptr;
+
+        if (SDL_GetDefaultAudioInfo(&defaultName, spec, 0) == 0)
+        {
+            SDL_free(defaultName);
+            return true;
+        }
+        return false;
+    }
+#endif
+
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+    if (deviceName != nullptr)
+    {
+        int numDevices = SDL_GetNumAudioDevices(0);
+
+        for (int i = 0; i < numDevices; ++i)
+        {
+            const char* name = SDL_GetAudioDeviceName(i, 0);
+
+            if (name && strcmp(name, deviceName) == 0)
+            {
+                return SDL_GetAudioDeviceSpec(i, 0, spec) == 0;
+            }
+        }
+    }
+#endif
+
+    (void)deviceName;
+    return false;
 }
 
 
 void audioPlayerAudioCallback(void* userdata, Uint8* stream, 
                               int callbackBufferSize)
 {
-    // written by ChatGPT o1-preview
-    // need a callback to keep track of audioBytePos
+    // no locks and no SDL calls, the transport is only read and written
+    // through its atomic words
 
     AudioPlayer* audioPlayer = static_cast<AudioPlayer*>(userdata);
+    Transport& transport = audioPlayer->transport;
 
-    if (audioPlayer->isPaused.load())
-    {
-        // Fill the stream with silence if paused
-        SDL_memset(stream, 0, callbackBufferSize);
-        return;
-    }
+    Uint32 frameBytes = audioPlayer->audioSpec.channels * sizeof(float);
+    uint64_t callbackFrames = callbackBufferSize / frameBytes;
+    float* out = reinterpret_cast<float*>(stream);
 
-    Uint32 currentBytePos = audioPlayer->audioBytePos.load(std::memory_order_relaxed);
+    transport.beginBlock();
 
-    Uint32 remaining = audioPlayer->audioSize - currentBytePos;
-    Uint32 toCopy = (callbackBufferSize > static_cast<int>(remaining)) ? remaining : callbackBufferSize;
+    uint64_t copiedFrames = 0;
 
-    if (toCopy > 0)
+    if (audioPlayer->playbackSource)
     {
-        // Copy audio data from audioStartPtr to the stream
-        SDL_memcpy(stream, 
-                   audioPlayer->audioStartPtr + currentBytePos, 
-                   toCopy);
-        audioPlayer->audioBytePos.fetch_add(toCopy, std::memory_order_relaxed);
-    }
+        AudioSource& audioSource = *audioPlayer->playbackSource;
+        int channels = audioPlayer->audioSpec.channels;
 
-    if (toCopy < static_cast<Uint32>(callbackBufferSize))
-    {
-        // Fill the rest of the stream with silence (if we've reached the end)
-        SDL_memset(stream + toCopy, 0, callbackBufferSize - toCopy);
+        // segments end on the loop end and the end of the stream
+        uint64_t frame;
+        uint64_t segmentFrames;
+
+        while (copiedFrames < callbackFrames 
+               && (segmentFrames = transport.nextSegment(
+                       &frame, callbackFrames - copiedFrames)) > 0)
+        {
+            // whole frames from the source, already in the device's format,
+            // fewer if a decoder is behind (e.g. right after a seek)
+            uint64_t nRead = audioSource.readFrames(&out[copiedFrames * channels],
+                                                    frame,
+                                                    segmentFrames);
+            transport.advance(nRead);
+            copiedFrames += nRead;
+
+            if (nRead < segmentFrames)
+            {
+                break;
+            }
+        }
     }
 
-    // If we've reached the end of the audio, stop playback
-    if (currentBytePos >= audioPlayer->audioSize)
+    Uint32 copiedBytes = static_cast<Uint32>(copiedFrames * frameBytes);
+    if (copiedBytes < static_cast<Uint32>(callbackBufferSize))
     {
-        // Optionally, you can loop or reset the position
-        // For now, we'll pause the audio
-        audioPlayer->isPaused.store(true);
-        SDL_PauseAudioDevice(audioPlayer->device, 1);
+        // silence while stopped, after the end or while the source is behind
+        memset(stream + copiedBytes, 0, callbackBufferSize - copiedBytes);
     }
+
+    transport.endBlock();
 }
@@ -3,6 +3,20 @@
 // Library for audio player
 //
 // Audio playback using SDL2, MP3 and FLAC support provided by dr_libs
+//
+// Every format is read through an AudioSource: MP3 and FLAC are decoded while
+// playing (see audio_stream.hpp), WAV is memory-mapped (see wav_source.hpp),
+// memory use doesn't grow with the file length
+//
+// The device is opened at its own rate and channel count when SDL can tell
+// them, and a file in another format is converted by a ConvertedSource
+// (see converted_source.hpp), so SDL never converts behind the callback.
+// Frame positions are counted at the device rate.
+//
+// Play, pause, seek and the loop region go through a Transport (see
+// transport.hpp): the device runs while it's open, and the callback applies
+// the commands at the start of its next block and stops on its own at the
+// end of the stream.
 // 
 //===----------------------------------------------------------------------===//
 // Basic SDL2 .wav player https://www.youtube.com/watch?v=hZ0TGCUcY2g&t=711s
@@ -13,9 +27,16 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include <SDL2/SDL.h>
 
+#include "audio_source.hpp"
+#include "audio_cache.hpp"
+#include "transport.hpp"
+
 /// TODO: maybe change it to single channel?
 
 class AudioPlayer
@@ -27,14 +48,67 @@ public:
     // AudioPlayer(const AudioPlayer&) = delete;
     // AudioPlayer& operator=(const AudioPlayer&) = delete;
 
-    /// Load an audio file for playback, will convert buffer to Float-32
+    /// Start loading an audio file for playback on a loader thread,
+    /// samples are read as Float-32
     /// 
     /// Currently supporting .wav .flac and .mp3
     ///
+    /// The current file keeps playing until pollLoad() swaps the new one in,
+    /// a load still running is cancelled
+    ///
     /// \param filepath     filepath of the playback audio file
     ///
     void loadFile(const char* filepath);
 
+    /// Swap in the file of a finished load, call once per frame
+    ///
+    /// Reopens the playback device for the new file, paused at the
+    /// beginning
+    ///
+    /// \return     whether a new file was swapped in
+    ///
+    bool pollLoad();
+
+    /// Stop a running load, the current file is kept
+    ///
+    void cancelLoad();
+
+    /// \return     whether a load is running or waiting for pollLoad()
+    ///
+    bool getIsLoading();
+
+    /// \return     progress of the running load in [0, 1]
+    ///
+    float getLoadProgress();
+
+    /// \return     file bytes read per second by the last load in MB/s
+    ///
+    double getLoadThroughputMBs();
+
+    /// \return     compressed input decoded per second in MB/s,
+    ///             0 for WAV files and cached files
+    ///
+    double getDecodeThroughputMBs();
+
+    /// Set the directory of the decoded audio cache (see audio_cache.hpp)
+    ///
+    /// \param directory    path ending with a separator, or an empty
+    ///                     string to disable it
+    ///
+    void setCacheDirectory(const char* directory);
+
+    /// Use the decoded audio cache for MP3 and FLAC when loading
+    ///
+    void setCacheEnabled(bool enabled);
+
+    /// \param maxBytes     size limit of the cache directory
+    ///
+    void setCacheMaxBytes(uint64_t maxBytes);
+
+    /// \return     whether the last loaded file came from the cache
+    ///
+    bool getIsCached();
+
     /// Start playing the audio at the current playback position
     ///
     void play();
@@ -53,40 +127,97 @@ public:
 
     /// Set the current audio playback position to a specific time in sec
     ///
-    /// \param toTimeSec    time in second, if exceeded the audio length
-    ///                     the time will be set to the end of stream
+    /// \param toTimeSec    time in second, rounded to the nearest frame,
+    ///                     if exceeded the audio length the time will be
+    ///                     set to the end of stream
+    ///
+    void setAudioPosition(double toTimeSec);
+
+    /// Loop between two times once the playback reaches the region,
+    /// wrapping on the exact frame, cleared when another file is loaded
+    ///
+    /// \param startSec     start of the region in seconds
+    ///
+    /// \param endSec       end of the region in seconds, clamped to the
+    ///                     audio length
     ///
-    void setAudioPosition(Uint32 toTimeSec);
+    /// \return             false if the region is empty
+    ///
+    bool setLoopRegion(double startSec, double endSec);
+
+    /// Play through the loop region
+    ///
+    void clearLoopRegion();
+
+    /// \return     whether a loop region is set
+    ///
+    bool getIsLooping();
 
     /// \return     current playback time in seconds
     ///
-    float getCurrentTimeSec();
+    double getCurrentTimeSec();
 
     /// \return     audio stream length in seconds
     ///
-    float getTotalTimeSec();
+    double getTotalTimeSec();
+
+    /// \return     current playback position in sample frames
+    ///             at the device rate
+    ///
+    uint64_t getCurrentFrame();
 
-    /// \return     audio file sample frequency in Hz
+    /// \return     audio stream length in sample frames at the device rate
+    ///
+    uint64_t getTotalFrames();
+
+    /// \return     audio file sample frequency in Hz,
+    ///             0 if nothing is loaded
     ///
     int getFreq();
 
-    /// Fill in a buffer array with floating point audio samples from the 
-    /// current playing point to user specified number of samples before the 
-    /// current playing point.
+    /// \return     number of channels of the audio file,
+    ///             0 if nothing is loaded
     ///
-    /// If the buffer size exceeds the sample avaliable, this function will
-    /// fill the buffer with zeros. 
+    int getChannels();
+
+    /// \return     sample rate the device was opened at in Hz,
+    ///             0 if no device is open
     ///
-    /// Note:   will get numSamples amount of sample regardless
-    ///         of the number of channels.
+    int getDeviceFreq();
+
+    /// \return     number of channels the device was opened with
+    ///
+    int getDeviceChannels();
+
+    /// \return     frames per callback
+    ///
+    int getDeviceBufferFrames();
+
+    /// \return     whether the file is resampled or remapped to the device's
+    ///             format, otherwise the callback only copies
+    ///
+    bool getIsConverting();
+
+    /// \return     whether the device's own format is known and was opened
+    ///             as is, otherwise SDL may still convert the float output
+    ///
+    bool getIsDeviceNative();
+
+    /// Fill in a buffer array with the interleaved floating point frames 
+    /// from user specified number of frames before the current playing 
+    /// point to the current playing point.
+    ///
+    /// If the buffer size exceeds the frames avaliable, this function will
+    /// fill the buffer with zeros. 
     ///
     /// \param buffer       pointer to the buffer array, the buffer must have
-    ///                     enough space to hold all the samples
+    ///                     enough space to hold numFrames * getChannels() 
+    ///                     samples (see channel_mix.hpp for splitting them)
     ///
-    /// \param numSamples   number of sample points to extra from the audio 
-    ///                     stream, regardless of the number of channels
+    /// \param numFrames    number of sample frames to extract from the audio 
+    ///                     stream
     ///
-    void getAudioData(float* buffer, int numSamples);
+    void getAudioData(float* buffer, int numFrames);
 
    /// Note:   Uses std::string because char* pointer might change
     ///
@@ -101,7 +232,10 @@ public:
     ///
     void closeDevice();
 
-    /// Select and setup an audio playback device
+    /// Select and setup an audio playback device, kept for the next files
+    ///
+    /// Opened at the device's own rate and channels if SDL reports them,
+    /// the playback position and state carry over
     ///
     /// \param deviceName   defaulted to system default audio playback device
     ///
@@ -110,15 +244,31 @@ public:
 private:
     SDL_AudioDeviceID device;
     
-    // .WAV file properties
+    // spec the device was opened with
     SDL_AudioSpec audioSpec;
-    Uint8* audioStartPtr;   // pointer to audio stream
-    Uint32 audioSize;       // total size of audio stream in bytes
-    std::atomic_uint32_t audioBytePos;
+    uint64_t totalFrames;   // length of the audio stream in device frames
+
+    // playback position and state, shared with the callback
+    Transport transport;
+
+    // loop region of the UI, in seconds to carry over to another device
+    bool hasLoop;
+    double loopStartSec, loopEndSec;
+
+    // samples of the loaded file, as float
+    std::unique_ptr<AudioSource> audioSource;
+
+    // the file in the device's format if they differ, the callback reads
+    // playbackSource, which is one of the two
+    std::unique_ptr<AudioSource> convertedSource;
+    AudioSource* playbackSource;
+
+    // selected device, empty for the default one
+    std::string deviceName;
+    SDL_AudioSpec nativeSpec;
+    bool isNativeSpecKnown;
    
     int numDevices;         
-
-    std::atomic_bool isPaused;
     
     // for getting audio data
     Uint8 bytesPerSample;
@@ -133,9 +283,37 @@ private:
 
     AudioFormat audioFormat;
 
-    void wavToFloat(const char* filepath);
-    void mp3ToFloat(const char* filepath);
-    void flacToFloat(const char* filepath);
+    // decoded MP3 and FLAC, written after the first load
+    AudioCache audioCache;
+    std::atomic_bool isCacheEnabled;
+    std::atomic_bool isCached;
+    bool loadedIsCached;
+
+    // background loading, loadedSource is handed over by loadReady
+    std::thread loaderThread;
+    AudioSourceLoadStatus loadStatus;
+    std::atomic_bool isLoading;
+    std::atomic_bool loadReady;
+    std::atomic<double> loadThroughputMBs;
+    std::unique_ptr<AudioSource> loadedSource;
+    AudioFormat loadedFormat;
+
+    /// Runs on the loader thread
+    void loadWorker(std::string filepath, AudioFormat format);
+
+    /// Open the file as an AudioSource
+    /// \return     nullptr if it can't be opened or was cancelled
+    std::unique_ptr<AudioSource> openSource(const char* filepath, 
+                                            AudioFormat format);
+
+    /// Free the loaded audio, the device must be closed
+    void unloadFile();
+
+    /// \return     time in device frames, clamped to the audio length
+    uint64_t secToFrame(double timeSec);
+
+    /// Apply the transport commands on this thread if there is no device
+    void applyWithoutDevice();
 
     friend void audioPlayerAudioCallback(void* userdata, 
                                          Uint8* stream, 
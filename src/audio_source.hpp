@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+// Interface for the audio data behind AudioPlayer
+//
+// Sources hand out interleaved float frames by absolute frame index, so the
+// player doesn't need to know whether the samples are decoded ahead in a
+// ring, mapped from disk, or held in memory.
+//
+// readFrames() is called from the audio callback for playback, and must not
+// block. peekFrames() is called for analysis, usually just behind the last
+// frame read for playback.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AUDIO_SOURCE_HPP
+#define AUDIO_SOURCE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/// Progress of AudioSource opening, shared with the thread that waits on it
+///
+struct AudioSourceLoadStatus
+{
+    // bytes read from the file while opening, out of bytesTotal
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<uint64_t> bytesTotal{0};
+
+    // set by the waiting thread, the source stops reading and fails to open
+    std::atomic_bool cancel{false};
+};
+
+class AudioSource
+{
+public:
+    virtual ~AudioSource() {}
+
+    virtual int getChannels() = 0;
+
+    virtual int getSampleRate() = 0;
+
+    /// \return     length of the source in frames
+    ///
+    virtual uint64_t getTotalFrames() = 0;
+
+    /// Copy frames for playback, frames not available are filled with zeros
+    ///
+    /// \param dst      interleaved float output
+    ///                 (array must have a length of nFrames * channels)
+    ///
+    /// \param frame    index of the first frame
+    ///
+    /// \param nFrames  number of frames
+    ///
+    /// \return         number of frames available from frame onward,
+    ///                 can be smaller than nFrames if the source is behind,
+    ///                 the playback position should only advance by this
+    ///
+    virtual uint64_t readFrames(float* dst, uint64_t frame, uint64_t nFrames) = 0;
+
+    /// Copy frames for analysis, same as readFrames() but doesn't move any
+    /// read-ahead window
+    ///
+    virtual uint64_t peekFrames(float* dst, uint64_t frame, uint64_t nFrames) = 0;
+
+    /// \return     input consumed per second of decoding in MB/s,
+    ///             0 if the source doesn't decode
+    ///
+    virtual double getDecodeThroughputMBs() { return 0.0; }
+};
+
+#endif
@@ -0,0 +1,507 @@
+#include "audio_stream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#define DR_MP3_IMPLEMENTATION
+#define DR_FLAC_IMPLEMENTATION
+#include "dr_libs/dr_mp3.h"
+#include "dr_libs/dr_flac.h"
+
+// frames decoded per step, small enough to react to seeks quickly
+static constexpr uint64_t s_DECODE_CHUNK_FRAMES = 4096;
+
+// poll interval of the decoder thread when the ring is full,
+// the audio callback never has to wake it up
+static constexpr auto s_IDLE_SLEEP = std::chrono::milliseconds(2);
+
+// MP3 has no index, seek points are built when opening
+static constexpr drmp3_uint32 s_MAX_MP3_SEEK_POINTS = 4096;
+
+// dr_mp3 reads an MP3 three times while opening: for the frame count,
+// then for the frame count again and the seek points
+static constexpr uint64_t s_MP3_OPEN_PASSES = 3;
+
+// the decoders read the file through these, to count bytes and cancel
+struct AudioStream::Decoder
+{
+    drmp3 mp3;
+    std::vector<drmp3_seek_point> mp3SeekPoints;
+
+    drflac* flac = nullptr;
+
+    FILE* file = nullptr;
+    uint64_t bytesRead = 0;
+
+    // only while opening
+    AudioSourceLoadStatus* status = nullptr;
+};
+
+static size_t s_onRead(void* userData, void* dst, size_t bytesToRead);
+static bool s_onSeek(void* userData, int offset, bool fromStart);
+
+static size_t s_mp3OnRead(void* userData, void* dst, size_t bytesToRead);
+static drmp3_bool32 s_mp3OnSeek(void* userData, int offset, drmp3_seek_origin origin);
+static size_t s_flacOnRead(void* userData, void* dst, size_t bytesToRead);
+static drflac_bool32 s_flacOnSeek(void* userData, int offset, drflac_seek_origin origin);
+
+
+AudioStream::AudioStream(uint64_t ringFrames, uint64_t historyFrames)
+    :   codec(Codec::NONE),
+        decoder(new Decoder()),
+        channels(0),
+        sampleRate(0),
+        totalFrames(0),
+        ringFrames(ringFrames),
+        historyFrames(historyFrames),
+        generation(0),
+        validStart(0),
+        writeFrame(0),
+        playFrame(0),
+        seekRequest(-1),
+        decodeBytes(0),
+        decodeNanoseconds(0),
+        running(false)
+{
+
+}
+
+
+AudioStream::~AudioStream()
+{
+    this->close();
+}
+
+
+bool AudioStream::open(const char* filepath, AudioSourceLoadStatus* status)
+{
+    this->close();
+
+    std::string filePathStr(filepath);
+    std::string extension = filePathStr.substr(filePathStr.find_last_of('.') + 1);
+
+    Codec newCodec;
+    if (extension == "mp3" or extension == "MP3")
+    {
+        newCodec = Codec::MP3;
+    }
+    else if (extension == "flac" or extension == "FLAC")
+    {
+        newCodec = Codec::FLAC;
+    }
+    else
+    {
+        std::cout << "Unsupported stream format: " << extension << std::endl;
+        return false;
+    }
+
+    decoder->file = fopen(filepath, "rb");
+    if (decoder->file == nullptr)
+    {
+        std::cout << "Failed to open file: " << filepath << std::endl;
+        return false;
+    }
+
+    fseek(decoder->file, 0, SEEK_END);
+    uint64_t fileSize = static_cast<uint64_t>(ftell(decoder->file));
+    fseek(decoder->file, 0, SEEK_SET);
+
+    decoder->bytesRead = 0;
+    decoder->status = status;
+    if (status != nullptr)
+    {
+        uint64_t nPasses = (newCodec == Codec::MP3) ? s_MP3_OPEN_PASSES : 1;
+        status->bytesTotal.store(nPasses * fileSize);
+        status->bytesDone.store(0);
+    }
+
+    bool isOpened = false;
+
+    if (newCodec == Codec::MP3)
+    {
+        if (drmp3_init(&decoder->mp3, s_mp3OnRead, s_mp3OnSeek, decoder.get(), nullptr))
+        {
+            this->codec = Codec::MP3;
+            this->channels = decoder->mp3.channels;
+            this->sampleRate = decoder->mp3.sampleRate;
+            this->totalFrames.store(drmp3_get_pcm_frame_count(&decoder->mp3));
+
+            // scans the frame headers, no synthesis
+            drmp3_uint32 nSeekPoints = s_MAX_MP3_SEEK_POINTS;
+            decoder->mp3SeekPoints.resize(nSeekPoints);
+            if (drmp3_calculate_seek_points(&decoder->mp3, &nSeekPoints,
+                                            decoder->mp3SeekPoints.data()))
+            {
+                decoder->mp3SeekPoints.resize(nSeekPoints);
+                drmp3_bind_seek_table(&decoder->mp3, nSeekPoints,
+                                      decoder->mp3SeekPoints.data());
+            }
+
+            drmp3_seek_to_pcm_frame(&decoder->mp3, 0);
+            isOpened = true;
+        }
+    }
+    else
+    {
+        decoder->flac = drflac_open(s_flacOnRead, s_flacOnSeek, decoder.get(), nullptr);
+        if (decoder->flac != nullptr)
+        {
+            this->codec = Codec::FLAC;
+            this->channels = decoder->flac->channels;
+            this->sampleRate = decoder->flac->sampleRate;
+            this->totalFrames.store(decoder->flac->totalPCMFrameCount);
+            isOpened = true;
+        }
+    }
+
+    // the status belongs to the caller
+    decoder->status = nullptr;
+
+    bool isCancelled = (status != nullptr) && status->cancel.load();
+
+    if (!isOpened || isCancelled)
+    {
+        if (!isCancelled)
+        {
+            std::cout << "Failed to open stream: " << filepath << std::endl;
+        }
+        this->close();
+        return false;
+    }
+
+    if (status != nullptr)
+    {
+        status->bytesDone.store(status->bytesTotal.load());
+    }
+
+    // fixed memory, independent of the file length
+    ring.assign(ringFrames * channels, 0.0f);
+
+    this->generation.store(0);
+    this->validStart.store(0);
+    this->writeFrame.store(0);
+    this->playFrame.store(0);
+    this->seekRequest.store(-1);
+    this->decodeBytes.store(0);
+    this->decodeNanoseconds.store(0);
+
+    this->running.store(true);
+    this->decoderThread = std::thread(&AudioStream::decodeLoop, this);
+
+    return true;
+}
+
+
+void AudioStream::close()
+{
+    if (decoderThread.joinable())
+    {
+        this->running.store(false);
+        decoderThread.join();
+    }
+
+    switch (codec)
+    {
+        case Codec::MP3:
+            drmp3_uninit(&decoder->mp3);
+            decoder->mp3SeekPoints.clear();
+            break;
+        case Codec::FLAC:
+            drflac_close(decoder->flac);
+            decoder->flac = nullptr;
+            break;
+        default:
+            break;
+    }
+
+    if (decoder->file != nullptr)
+    {
+        fclose(decoder->file);
+        decoder->file = nullptr;
+    }
+
+    this->codec = Codec::NONE;
+    this->channels = 0;
+    this->sampleRate = 0;
+    this->totalFrames.store(0);
+
+    std::vector<float>().swap(ring);
+}
+
+
+int AudioStream::getChannels()
+{
+    return this->channels;
+}
+
+
+int AudioStream::getSampleRate()
+{
+    return this->sampleRate;
+}
+
+
+uint64_t AudioStream::getTotalFrames()
+{
+    return this->totalFrames.load();
+}
+
+
+double AudioStream::getDecodeThroughputMBs()
+{
+    uint64_t nanoseconds = decodeNanoseconds.load(std::memory_order_relaxed);
+
+    if (nanoseconds == 0)
+    {
+        return 0.0;
+    }
+
+    // bytes per nanosecond to MB/s
+    return 1e3 * decodeBytes.load(std::memory_order_relaxed) / nanoseconds;
+}
+
+
+uint64_t AudioStream::readFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    uint64_t nCopied = 0;
+
+    if (!copyFrames(dst, frame, nFrames, nCopied))
+    {
+        // jumped out of the buffered window, decode from there,
+        // unless the decoder is already seeking
+        bool seeking = generation.load(std::memory_order_acquire) % 2 == 1;
+        if (!seeking && frame < totalFrames.load())
+        {
+            this->seekRequest.store(static_cast<int64_t>(frame));
+        }
+        return 0;
+    }
+
+    // the read-ahead follows playback
+    this->playFrame.store(frame + nCopied, std::memory_order_release);
+
+    return nCopied;
+}
+
+
+uint64_t AudioStream::peekFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    uint64_t nCopied = 0;
+    copyFrames(dst, frame, nFrames, nCopied);
+
+    return nCopied;
+}
+
+
+bool AudioStream::copyFrames(float* dst, uint64_t frame, uint64_t nFrames,
+                             uint64_t& nCopied)
+{
+    nCopied = 0;
+
+    uint64_t generationBefore = generation.load(std::memory_order_acquire);
+    uint64_t start = validStart.load(std::memory_order_acquire);
+    uint64_t end = writeFrame.load(std::memory_order_acquire);
+
+    bool inWindow = (generationBefore % 2 == 0)
+                    && !ring.empty()
+                    && frame >= start && frame <= end;
+
+    if (inWindow)
+    {
+        uint64_t n = std::min(nFrames, end - frame);
+        uint64_t slot = frame % ringFrames;
+        uint64_t nFirst = std::min(n, ringFrames - slot);
+
+        // the ring may wrap around in the middle
+        memcpy(dst, &ring[slot * channels], nFirst * channels * sizeof(float));
+        memcpy(dst + nFirst * channels, &ring[0],
+               (n - nFirst) * channels * sizeof(float));
+
+        // discard the copy if the decoder seeked or overwrote it meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (generation.load(std::memory_order_relaxed) != generationBefore
+            || validStart.load(std::memory_order_relaxed) > frame)
+        {
+            inWindow = false;
+        }
+        else
+        {
+            nCopied = n;
+        }
+    }
+
+    memset(dst + nCopied * channels, 0,
+           (nFrames - nCopied) * channels * sizeof(float));
+
+    return inWindow;
+}
+
+
+void AudioStream::decodeLoop()
+{
+    while (running.load())
+    {
+        // seek requested by a reader
+        // --------------------------
+        int64_t seek = seekRequest.exchange(-1);
+        uint64_t target = static_cast<uint64_t>(seek);
+
+        // stale requests can land in the window after an earlier seek
+        bool inWindow = target >= validStart.load(std::memory_order_relaxed)
+                        && target <= writeFrame.load(std::memory_order_relaxed);
+
+        if (seek >= 0 && !inWindow)
+        {
+            // odd generation, readers back off while the window moves
+            this->generation.fetch_add(1, std::memory_order_acq_rel);
+
+            if (!seekDecoder(target))
+            {
+                std::cout << "AudioStream: failed to seek to frame "
+                          << target << std::endl;
+            }
+            this->validStart.store(target, std::memory_order_release);
+            this->writeFrame.store(target, std::memory_order_release);
+            this->playFrame.store(target, std::memory_order_release);
+
+            this->generation.fetch_add(1, std::memory_order_release);
+        }
+
+        // decode ahead
+        // ------------
+        uint64_t write = writeFrame.load(std::memory_order_relaxed);
+        uint64_t play = playFrame.load(std::memory_order_acquire);
+        uint64_t total = totalFrames.load();
+
+        // keep historyFrames behind the playback position intact
+        uint64_t limit = play + ringFrames - historyFrames;
+
+        uint64_t n = std::min(s_DECODE_CHUNK_FRAMES, ringFrames - write % ringFrames);
+        n = (limit > write) ? std::min(n, limit - write) : 0;
+        n = (total > write) ? std::min(n, total - write) : 0;
+
+        if (n == 0)
+        {
+            std::this_thread::sleep_for(s_IDLE_SLEEP);
+            continue;
+        }
+
+        // invalidate the oldest frames before overwriting their slots
+        if (write + n > ringFrames)
+        {
+            uint64_t newStart = write + n - ringFrames;
+            if (newStart > validStart.load(std::memory_order_relaxed))
+            {
+                this->validStart.store(newStart, std::memory_order_release);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto decodeStart = std::chrono::steady_clock::now();
+        uint64_t bytesBefore = decoder->bytesRead;
+
+        uint64_t nDecoded = decode(&ring[(write % ringFrames) * channels], n);
+
+        auto decodeTime = std::chrono::steady_clock::now() - decodeStart;
+        this->decodeBytes.fetch_add(decoder->bytesRead - bytesBefore,
+                                    std::memory_order_relaxed);
+        this->decodeNanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(decodeTime).count(),
+            std::memory_order_relaxed);
+
+        this->writeFrame.store(write + nDecoded, std::memory_order_release);
+
+        // the header's frame count was off, or the file is truncated
+        if (nDecoded < n)
+        {
+            this->totalFrames.store(write + nDecoded);
+        }
+    }
+}
+
+
+uint64_t AudioStream::decode(float* dst, uint64_t nFrames)
+{
+    switch (codec)
+    {
+        case Codec::MP3:
+            return drmp3_read_pcm_frames_f32(&decoder->mp3, nFrames, dst);
+        case Codec::FLAC:
+            return drflac_read_pcm_frames_f32(decoder->flac, nFrames, dst);
+        default:
+            return 0;
+    }
+}
+
+
+bool AudioStream::seekDecoder(uint64_t frame)
+{
+    switch (codec)
+    {
+        case Codec::MP3:
+            return drmp3_seek_to_pcm_frame(&decoder->mp3, frame);
+        case Codec::FLAC:
+            return drflac_seek_to_pcm_frame(decoder->flac, frame);
+        default:
+            return false;
+    }
+}
+
+
+size_t s_onRead(void* userData, void* dst, size_t bytesToRead)
+{
+    AudioStream::Decoder* decoder = static_cast<AudioStream::Decoder*>(userData);
+    AudioSourceLoadStatus* status = decoder->status;
+
+    // a short read looks like the end of file to dr_libs
+    if (status != nullptr && status->cancel.load(std::memory_order_relaxed))
+    {
+        return 0;
+    }
+
+    size_t nRead = fread(dst, 1, bytesToRead, decoder->file);
+    decoder->bytesRead += nRead;
+
+    if (status != nullptr)
+    {
+        status->bytesDone.fetch_add(nRead, std::memory_order_relaxed);
+    }
+
+    return nRead;
+}
+
+
+bool s_onSeek(void* userData, int offset, bool fromStart)
+{
+    AudioStream::Decoder* decoder = static_cast<AudioStream::Decoder*>(userData);
+
+    return fseek(decoder->file, offset, fromStart ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+
+size_t s_mp3OnRead(void* userData, void* dst, size_t bytesToRead)
+{
+    return s_onRead(userData, dst, bytesToRead);
+}
+
+
+drmp3_bool32 s_mp3OnSeek(void* userData, int offset, drmp3_seek_origin origin)
+{
+    return s_onSeek(userData, offset, origin == drmp3_seek_origin_start);
+}
+
+
+size_t s_flacOnRead(void* userData, void* dst, size_t bytesToRead)
+{
+    return s_onRead(userData, dst, bytesToRead);
+}
+
+
+drflac_bool32 s_flacOnSeek(void* userData, int offset, drflac_seek_origin origin)
+{
+    return s_onSeek(userData, offset, origin == drflac_seek_origin_start);
+}
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+// Streaming MP3 and FLAC decoder with bounded memory
+//
+// A decoder thread uses the incremental dr_mp3 / dr_flac APIs to keep a
+// read-ahead ring of decoded float frames in front of the playback position,
+// and a little history behind it for the spectrogram. Memory is fixed by the
+// ring size no matter how long the file is.
+//
+// The readers (audio callback and analysis) never block: the ring is read
+// with a sequence counter like a seqlock, and reads outside the buffered
+// window ask the decoder thread to seek.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AUDIO_STREAM_HPP
+#define AUDIO_STREAM_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio_source.hpp"
+
+class AudioStream : public AudioSource
+{
+public:
+    /// \param ringFrames       capacity of the decoded ring in frames,
+    ///                         defaulted to 2^18 (~6 s at 44.1 kHz)
+    ///
+    /// \param historyFrames    frames kept behind the playback position
+    ///                         for peekFrames(), must be smaller than
+    ///                         ringFrames, defaulted to 2^15
+    ///
+    AudioStream(uint64_t ringFrames = 1 << 18, uint64_t historyFrames = 1 << 15);
+    ~AudioStream();
+
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+
+    /// Open an .mp3 or .flac file and start decoding from the beginning
+    ///
+    /// Opening an MP3 reads through the whole file to build the seek table,
+    /// call it from a loading thread for long files.
+    ///
+    /// \param status   progress of reading the file while opening,
+    ///                 and cancellation, can be nullptr
+    ///
+    /// \return         false if the file can't be opened or was cancelled
+    ///
+    bool open(const char* filepath, AudioSourceLoadStatus* status = nullptr);
+
+    /// Stop the decoder thread and close the file
+    ///
+    void close();
+
+    int getChannels() override;
+    int getSampleRate() override;
+    uint64_t getTotalFrames() override;
+
+    uint64_t readFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+    uint64_t peekFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+
+    double getDecodeThroughputMBs() override;
+
+    // opaque dr_libs decoders and file, see audio_stream.cpp
+    struct Decoder;
+
+private:
+    enum class Codec
+    {
+        NONE,
+        MP3,
+        FLAC
+    };
+
+    Codec codec;
+
+    std::unique_ptr<Decoder> decoder;
+
+    int channels;
+    int sampleRate;
+    std::atomic<uint64_t> totalFrames;
+
+    // ring of decoded frames, frame f lives at slot f % ringFrames
+    std::vector<float> ring;
+    uint64_t ringFrames;
+    uint64_t historyFrames;
+
+    // frames [validStart, writeFrame) are in the ring,
+    // odd generation while the decoder thread seeks
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> validStart;
+    std::atomic<uint64_t> writeFrame;
+
+    // last frame read for playback, the read-ahead follows it
+    std::atomic<uint64_t> playFrame;
+
+    // frame to seek to, -1 for none
+    std::atomic<int64_t> seekRequest;
+
+    // compressed bytes read and time spent in decode()
+    std::atomic<uint64_t> decodeBytes;
+    std::atomic<uint64_t> decodeNanoseconds;
+
+    std::atomic_bool running;
+    std::thread decoderThread;
+
+    void decodeLoop();
+
+    /// Decode from the current decoder position
+    /// \return     frames decoded, smaller than nFrames at the end of file
+    uint64_t decode(float* dst, uint64_t nFrames);
+    bool seekDecoder(uint64_t frame);
+
+    /// Copy what is buffered from frame onward, the rest is zeroed
+    /// \return     whether frame is in the buffered window
+    bool copyFrames(float* dst, uint64_t frame, uint64_t nFrames,
+                    uint64_t& nCopied);
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include "batch_analysis.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <pffft.h>
+
+#include "audio_stream.hpp"
+#include "channel_mix.hpp"
+#include "fft.hpp"
+#include "npy_writer.hpp"
+#include "smoothing.hpp"
+#include "wav_source.hpp"
+
+/// Open the file by its extension
+///
+/// \return     nullptr if it isn't supported or can't be opened
+///
+static std::unique_ptr<AudioSource> s_openSource(const char* filepath);
+
+
+BatchAnalyzer::BatchAnalyzer(const BatchAnalysisOptions& options)
+    :   options(options),
+        nCols(options.fftLen / 2 - 2),
+        streamStart(0),
+        nextRowEnd(0),
+        nRows(0),
+        rowsWritten(0),
+        audioSeconds(0.0)
+{
+    const int fftLen = options.fftLen;
+    const size_t rowSize = (fftLen / 2) * sizeof(float);
+
+    this->signalBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    this->complexBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    this->workBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    this->magnitudeBuffer = static_cast<float*>(pffft_aligned_malloc(rowSize));
+
+    smoothingHalfGaussian(&colKernel[0], s_N_CONV_ROWS);
+
+    this->previousRows = static_cast<float*>(pffft_aligned_malloc((s_N_CONV_ROWS - 1) * rowSize));
+    this->workRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+    this->workFFTRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+    this->workConvRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+
+    this->rows.resize(static_cast<size_t>(s_ROWS_PER_WRITE) * nCols);
+}
+
+
+BatchAnalyzer::~BatchAnalyzer()
+{
+    pffft_aligned_free(signalBuffer);
+    pffft_aligned_free(complexBuffer);
+    pffft_aligned_free(workBuffer);
+    pffft_aligned_free(magnitudeBuffer);
+    pffft_aligned_free(previousRows);
+    pffft_aligned_free(workRow);
+    pffft_aligned_free(workFFTRow);
+    pffft_aligned_free(workConvRow);
+}
+
+
+bool BatchAnalyzer::analyzeFile(const char* inputPath, const char* outputPath)
+{
+    this->rowsWritten = 0;
+    this->audioSeconds = 0.0;
+
+    std::unique_ptr<AudioSource> source = s_openSource(inputPath);
+    if (!source)
+    {
+        return false;
+    }
+
+    int channels = source->getChannels();
+    int sourceRate = source->getSampleRate();
+    int rate = (options.sampleRate > 0) ? options.sampleRate : sourceRate;
+
+    if (!resampler.init(1, sourceRate, rate))
+    {
+        return false;
+    }
+
+    NpyWriter writer;
+    if (!writer.open(outputPath, nCols))
+    {
+        return false;
+    }
+
+    // every file starts from silence
+    memset(previousRows, 0, (s_N_CONV_ROWS - 1) * (options.fftLen / 2) * sizeof(float));
+    this->stream.clear();
+    this->streamStart = 0;
+    this->nextRowEnd = options.signalLen;
+    this->nRows = 0;
+
+    frames.resize(static_cast<size_t>(s_CHUNK_FRAMES) * channels);
+    mono.resize(s_CHUNK_FRAMES);
+
+    bool isWritten = true;
+    uint64_t frame = 0;
+
+    while (isWritten && frame < source->getTotalFrames())
+    {
+        uint64_t nRead = source->readFrames(frames.data(), frame, s_CHUNK_FRAMES);
+        if (nRead == 0)
+        {
+            // the decoder is behind
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        frame += nRead;
+
+        channelMixDownmix(mono.data(), frames.data(), static_cast<int>(nRead), channels);
+
+        size_t streamLen = stream.size();
+        stream.resize(streamLen + resampler.getMaxOutputFrames(static_cast<int>(nRead)));
+        int nOut = resampler.process(mono.data(), static_cast<int>(nRead), &stream[streamLen]);
+        stream.resize(streamLen + nOut);
+
+        // every row whose signal is complete
+        while (streamStart + stream.size() >= nextRowEnd)
+        {
+            this->analyzeRow(&stream[nextRowEnd - options.signalLen - streamStart],
+                             &rows[static_cast<size_t>(nRows) * nCols]);
+            this->nextRowEnd += options.hopLen;
+
+            if (++nRows == s_ROWS_PER_WRITE)
+            {
+                isWritten = writer.write(rows.data(), nRows);
+                this->nRows = 0;
+            }
+        }
+
+        // keep from the start of the next row's signal on
+        uint64_t nDropped = std::min(nextRowEnd - options.signalLen - streamStart,
+                                     static_cast<uint64_t>(stream.size()));
+        stream.erase(stream.begin(), stream.begin() + nDropped);
+        this->streamStart += nDropped;
+    }
+
+    if (isWritten && nRows > 0)
+    {
+        isWritten = writer.write(rows.data(), nRows);
+    }
+
+    this->rowsWritten = writer.getRowsWritten();
+    this->audioSeconds = static_cast<double>(frame) / sourceRate;
+
+    isWritten = writer.close() && isWritten;
+    if (!isWritten)
+    {
+        std::cout << "Failed to write: " << outputPath << std::endl;
+    }
+
+    return isWritten;
+}
+
+
+uint64_t BatchAnalyzer::getRowsWritten()
+{
+    return this->rowsWritten;
+}
+
+
+double BatchAnalyzer::getAudioSeconds()
+{
+    return this->audioSeconds;
+}
+
+
+void BatchAnalyzer::analyzeRow(const float* signal, float* row)
+{
+    const int fftLen = options.fftLen;
+
+    memcpy(signalBuffer, signal, options.signalLen * sizeof(float));
+    memset(&signalBuffer[options.signalLen], 0, (fftLen - options.signalLen) * sizeof(float));
+
+    fftForwardFFT(signalBuffer, complexBuffer, workBuffer);
+
+    fftComplexToRealDB(magnitudeBuffer, complexBuffer, fftLen / 2, true);
+
+    if (options.smoothing)
+    {
+        smoothingBlurRow(&magnitudeBuffer[1],
+                         &magnitudeBuffer[1],
+                         previousRows,
+                         workRow,
+                         workFFTRow,
+                         workConvRow,
+                         colKernel,
+                         fftLen,
+                         s_N_CONV_ROWS);
+    }
+
+    //  omit DC and the freq before Nyquist
+    memcpy(row, &magnitudeBuffer[1], nCols * sizeof(float));
+}
+
+
+std::unique_ptr<AudioSource> s_openSource(const char* filepath)
+{
+    std::string filePathStr(filepath);
+    std::string extension = filePathStr.substr(filePathStr.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (extension == "wav")
+    {
+        std::unique_ptr<WavSource> wavSource(new WavSource());
+
+        if (wavSource->open(filepath))
+        {
+            return wavSource;
+        }
+    }
+    else if (extension == "mp3" || extension == "flac")
+    {
+        std::unique_ptr<AudioStream> audioStream(new AudioStream());
+
+        if (audioStream->open(filepath))
+        {
+            return audioStream;
+        }
+    }
+    else
+    {
+        std::cout << "Unsupported audio format: " << extension << std::endl;
+        return nullptr;
+    }
+
+    std::cout << "Failed to open: " << filepath << std::endl;
+    return nullptr;
+}
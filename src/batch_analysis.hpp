@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+// Spectrogram of a whole file without a window or an OpenGL context
+//
+// The same chain as a SpectrogramLane on the CPU: the file is downmixed to
+// mono, optionally resampled, and every hopLen samples the last signalLen
+// samples go through fftForwardFFT, fftComplexToRealDB and smoothingBlurRow.
+// The rows are written to a .npy matrix (see npy_writer.hpp) as they come,
+// so memory doesn't grow with the file length.
+//
+// fftInit() must be called once with the options' fftLen before any
+// analyzer is used. Each analyzer owns its buffers, so one per thread can
+// analyze files in parallel.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef BATCH_ANALYSIS_HPP
+#define BATCH_ANALYSIS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "resampler.hpp"
+
+struct BatchAnalysisOptions
+{
+    // length of the FFT (see fftInit)
+    int fftLen = 8192;
+
+    // samples per row, zero padded to fftLen
+    int signalLen = 2048;
+
+    // samples between rows
+    int hopLen = 2048;
+
+    // resampled to before the analysis, 0 for the file's own rate
+    int sampleRate = 0;
+
+    // blur along the rows and columns like the spectrogram (see smoothing.hpp)
+    bool smoothing = true;
+};
+
+class BatchAnalyzer
+{
+public:
+    /// \param options  must have signalLen <= fftLen and a positive hopLen
+    ///
+    BatchAnalyzer(const BatchAnalysisOptions& options);
+    ~BatchAnalyzer();
+
+    BatchAnalyzer(const BatchAnalyzer&) = delete;
+    BatchAnalyzer& operator=(const BatchAnalyzer&) = delete;
+
+    /// Analyze a .wav, .mp3 or .flac file into a .npy matrix of
+    /// rows x (fftLen/2 - 2) float-32, column j is FFT bin j + 1 in dB
+    /// scaled to [0, 1], a trailing part shorter than signalLen is dropped
+    ///
+    /// \return     false if the file can't be read or the matrix written
+    ///
+    bool analyzeFile(const char* inputPath, const char* outputPath);
+
+    /// \return     rows written for the last file
+    ///
+    uint64_t getRowsWritten();
+
+    /// \return     length of the last file in seconds
+    ///
+    double getAudioSeconds();
+
+private:
+    static constexpr int s_N_CONV_ROWS = 10;    // as in SpectrogramLane
+    static constexpr int s_CHUNK_FRAMES = 8192; // read from the file per step
+    static constexpr int s_ROWS_PER_WRITE = 64;
+
+    BatchAnalysisOptions options;
+    int nCols;
+
+    // fftLen and fftLen/2, aligned for pffft
+    float* signalBuffer;
+    float* complexBuffer;
+    float* workBuffer;
+    float* magnitudeBuffer;
+    float colKernel[s_N_CONV_ROWS];
+    float* previousRows;
+    float* workRow;
+    float* workFFTRow;
+    float* workConvRow;
+
+    Resampler resampler;
+
+    // file frames, their downmix, and the mono signal from streamStart on
+    std::vector<float> frames;
+    std::vector<float> mono;
+    std::vector<float> stream;
+    uint64_t streamStart;
+    uint64_t nextRowEnd;
+
+    std::vector<float> rows;
+    int nRows;
+
+    uint64_t rowsWritten;
+    double audioSeconds;
+
+    /// Spectrum of signalLen samples into a row of nCols
+    void analyzeRow(const float* signal, float* row);
+};
+
+#endif
@@ -0,0 +1,282 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "fft.hpp"
+#include "batch_analysis.hpp"
+
+// Headless batch analysis, no SDL or OpenGL
+//
+// usage: spectrolysis_batch [options] <file list> <output directory>
+//
+// The file list has one audio file path per line. Each file is written to
+// the output directory as <name>.npy (see batch_analysis.hpp), files are
+// analyzed in parallel, one per worker thread.
+
+
+/// Print the usage to the console
+///
+void printUsage();
+
+
+/// Read the file list, empty lines are skipped
+///
+/// \return     false if the list can't be opened
+///
+bool readFileList(const char* listPath, std::vector<std::string>& inputPaths);
+
+
+/// \return     output path of every input, <name>.npy in the output directory,
+///             <name>_<n>.npy for repeated names
+///
+std::vector<std::string> makeOutputPaths(const std::vector<std::string>& inputPaths,
+                                         std::string outputDir);
+
+
+/// Parse a positive integer option value
+///
+/// \return     false if it isn't one
+///
+bool parsePositive(const char* arg, int& value);
+
+
+int main(int argc, char* argv[])
+{
+    BatchAnalysisOptions options;
+    int nThreads = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<const char*> positional;
+
+    // command line
+    // ------------
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool isValid = true;
+
+        if (strcmp(arg, "--fft") == 0 && hasValue)
+        {
+            isValid = parsePositive(argv[++i], options.fftLen);
+        }
+        else if (strcmp(arg, "--signal") == 0 && hasValue)
+        {
+            isValid = parsePositive(argv[++i], options.signalLen);
+        }
+        else if (strcmp(arg, "--hop") == 0 && hasValue)
+        {
+            isValid = parsePositive(argv[++i], options.hopLen);
+        }
+        else if (strcmp(arg, "--rate") == 0 && hasValue)
+        {
+            isValid = parsePositive(argv[++i], options.sampleRate);
+        }
+        else if (strcmp(arg, "--threads") == 0 && hasValue)
+        {
+            isValid = parsePositive(argv[++i], nThreads);
+        }
+        else if (strcmp(arg, "--no-smoothing") == 0)
+        {
+            options.smoothing = false;
+        }
+        else if (arg[0] == '-')
+        {
+            isValid = false;
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+
+        if (!isValid)
+        {
+            std::cout << "Invalid option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    // power of 2 larger than 32, see fftInit
+    bool isFFTLenValid = options.fftLen > 32 
+                         && (options.fftLen & (options.fftLen - 1)) == 0;
+
+    if (positional.size() != 2 || !isFFTLenValid || options.signalLen > options.fftLen)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::string> inputPaths;
+    if (!readFileList(positional[0], inputPaths))
+    {
+        std::cout << "Failed to open the file list: " << positional[0] << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> outputPaths = makeOutputPaths(inputPaths, positional[1]);
+
+    nThreads = std::max(1, std::min(nThreads, static_cast<int>(inputPaths.size())));
+
+    // worker pool
+    // -----------
+    // shared by every analyzer, only read after this
+    fftInit(options.fftLen);
+
+    std::atomic<size_t> nextFile(0);
+    std::atomic<size_t> nFailed(0);
+    std::atomic<uint64_t> audioMilliseconds(0);
+    std::mutex consoleMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]()
+    {
+        BatchAnalyzer analyzer(options);
+
+        // files are taken one at a time, long and short ones even out
+        for (size_t i = nextFile.fetch_add(1); i < inputPaths.size(); i = nextFile.fetch_add(1))
+        {
+            bool isAnalyzed = analyzer.analyzeFile(inputPaths[i].c_str(), 
+                                                   outputPaths[i].c_str());
+            if (isAnalyzed)
+            {
+                audioMilliseconds.fetch_add(
+                    static_cast<uint64_t>(analyzer.getAudioSeconds() * 1000.0));
+            }
+            else
+            {
+                nFailed.fetch_add(1);
+            }
+
+            std::lock_guard<std::mutex> lock(consoleMutex);
+            std::cout << (isAnalyzed ? "done   " : "FAILED ") << inputPaths[i] 
+                      << " -> " << outputPaths[i] 
+                      << " (" << analyzer.getRowsWritten() << " rows)" << std::endl;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nThreads; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for (std::thread& thread : workers)
+    {
+        thread.join();
+    }
+
+    fftCleanUp();
+
+    // summary
+    // -------
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double audioSeconds = audioMilliseconds.load() / 1000.0;
+
+    std::cout << inputPaths.size() - nFailed.load() << " of " << inputPaths.size() 
+              << " files in " << elapsed.count() << " s on " << nThreads << " threads, "
+              << audioSeconds / std::max(elapsed.count(), 1e-9) << "x realtime" 
+              << std::endl;
+
+    return (nFailed.load() == 0) ? 0 : 1;
+}
+
+
+void printUsage()
+{
+    std::cout << "usage: spectrolysis_batch [options] <file list> <output directory>\n"
+              << "\n"
+              << "  <file list>         text file, one .wav .mp3 or .flac path per line\n"
+              << "  <output directory>  <name>.npy per file, rows x (fft/2 - 2) float32\n"
+              << "\n"
+              << "  --fft N             FFT length, power of 2 (default 8192)\n"
+              << "  --signal N          samples per row, at most the FFT length (default 2048)\n"
+              << "  --hop N             samples between rows (default 2048)\n"
+              << "  --rate HZ           resample before the analysis (default: file rate)\n"
+              << "  --threads N         worker threads (default: number of cores)\n"
+              << "  --no-smoothing      skip the row and column blur\n";
+}
+
+
+bool readFileList(const char* listPath, std::vector<std::string>& inputPaths)
+{
+    std::ifstream list(listPath);
+    if (!list)
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(list, line))
+    {
+        // lists written on Windows
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            inputPaths.push_back(line);
+        }
+    }
+    return true;
+}
+
+
+std::vector<std::string> makeOutputPaths(const std::vector<std::string>& inputPaths,
+                                         std::string outputDir)
+{
+    if (!outputDir.empty() && outputDir.back() != '/' && outputDir.back() != '\\')
+    {
+        outputDir += '/';
+    }
+
+    std::vector<std::string> outputPaths;
+    std::set<std::string> usedNames;
+
+    for (const std::string& inputPath : inputPaths)
+    {
+        // file name without the directory and the extension
+        size_t nameStart = inputPath.find_last_of("/\\");
+        nameStart = (nameStart == std::string::npos) ? 0 : nameStart + 1;
+
+        std::string name = inputPath.substr(nameStart);
+        size_t extensionStart = name.find_last_of('.');
+        if (extensionStart != std::string::npos && extensionStart > 0)
+        {
+            name.resize(extensionStart);
+        }
+
+        std::string uniqueName = name;
+        for (int n = 1; usedNames.count(uniqueName) > 0; ++n)
+        {
+            uniqueName = name + "_" + std::to_string(n);
+        }
+        usedNames.insert(uniqueName);
+
+        outputPaths.push_back(outputDir + uniqueName + ".npy");
+    }
+    return outputPaths;
+}
+
+
+bool parsePositive(const char* arg, int& value)
+{
+    char* end = nullptr;
+    long parsed = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || parsed <= 0 || parsed > (1 << 30))
+    {
+        return false;
+    }
+
+    value = static_cast<int>(parsed);
+    return true;
+}
@@ -255,4 +255,13 @@ glm::mat4 Camera::getPVMMat()
     transform[3] = glm::vec4(translationVec, 1.0f);
     
     return transform;
-}
\ No newline at end of file
+}
+
+
+glm::vec3 Camera::getViewDirection()
+{
+    // clip space depth is the 3rd row of the model matrix times the
+    // position (no projection), the uniform scaling and the translation
+    // do not change the direction
+    return glm::vec3(rotationMat[0][2], rotationMat[1][2], rotationMat[2][2]);
+}
@@ -63,6 +63,13 @@ public:
     /// Also use for updating the last camera state for the undo button
     glm::mat4 getPVMMat();
 
+    /// Direction in model space along which the depth increases
+    /// (the orthographic view direction), for front-to-back sorting
+    ///
+    /// Note:   does not update the undo state, unlike getPVMMat()
+    ///
+    glm::vec3 getViewDirection();
+
 private:
     // settings
     double sensitivity;
@@ -0,0 +1,336 @@
+#include "capture_recorder.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+
+// bytes before the samples of a file from WavWriter
+static constexpr uint64_t s_WAV_HEADER_SIZE = 80;
+
+// how often the writer wakes up, and patches the header
+static constexpr std::chrono::milliseconds s_POLL_INTERVAL(20);
+static constexpr std::chrono::milliseconds s_FLUSH_INTERVAL(1000);
+
+
+CaptureRecorder::CaptureRecorder()
+    :   ring(nullptr),
+        channels(0),
+        sampleRate(0),
+        maxFileFrames(0),
+        recording(false),
+        stopping(false),
+        isWriting(false),
+        fileCount(0),
+        fileNumber(0),
+        framesWritten(0),
+        framesDropped(0),
+        nextSample(0)
+{
+
+}
+
+
+CaptureRecorder::~CaptureRecorder()
+{
+    this->stop();
+}
+
+
+bool CaptureRecorder::start(SampleRing* ring,
+                            int channels,
+                            int sampleRate,
+                            const char* folderPath,
+                            int maxFileSec,
+                            uint64_t maxFileBytes)
+{
+    if (recording)
+    {
+        this->stop();
+    }
+
+    if (ring == nullptr || ring->getCapacity() == 0 || channels <= 0)
+    {
+        std::cout << "Capture Recorder: no samples to record" << std::endl;
+        return false;
+    }
+
+    // time stamped output name, numbered as the files rotate
+    // -------------------------------------------------------
+    char timeStamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timeStamp, sizeof(timeStamp), "%Y%m%d_%H%M%S",
+                  std::localtime(&now));
+
+    this->filePrefix = std::string(folderPath) + "/spectrolysis_mic_" + timeStamp;
+
+    this->ring = ring;
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+
+    // the tighter of the two limits, at least a frame per file
+    // --------------------------------------------------------
+    uint64_t bytesPerFrame = channels * sizeof(float);
+
+    this->maxFileFrames = 0;
+    if (maxFileSec > 0)
+    {
+        this->maxFileFrames = static_cast<uint64_t>(maxFileSec) * sampleRate;
+    }
+    if (maxFileBytes > 0)
+    {
+        uint64_t byteFrames = (maxFileBytes > s_WAV_HEADER_SIZE)
+                              ? (maxFileBytes - s_WAV_HEADER_SIZE) / bytesPerFrame
+                              : 0;
+        byteFrames = std::max<uint64_t>(byteFrames, 1);
+
+        this->maxFileFrames = (maxFileFrames > 0)
+                              ? std::min(maxFileFrames, byteFrames)
+                              : byteFrames;
+    }
+
+    // from the samples published from now on
+    this->nextSample = ring->getWriteCount();
+    this->nextSample -= nextSample % channels;
+
+    this->chunk.resize(s_CHUNK_FRAMES * channels);
+    this->silence.assign(s_CHUNK_FRAMES * channels, 0.0f);
+    this->fileCount = 0;
+    this->fileNumber = 0;
+    this->framesWritten = 0;
+    this->framesDropped = 0;
+
+    if (!openNextFile())
+    {
+        return false;
+    }
+
+    this->stopping = false;
+    this->isWriting = true;
+    this->recording = true;
+
+    this->writer = std::thread(&CaptureRecorder::writerLoop, this);
+
+    return true;
+}
+
+
+void CaptureRecorder::stop()
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        this->stopping = true;
+    }
+    stopCondition.notify_one();
+    writer.join();
+
+    this->recording = false;
+
+    std::cout << "Capture Recorder: " << framesWritten << " frames written to "
+              << fileCount << " file(s), " << framesDropped << " dropped, "
+              << filePrefix << std::endl;
+}
+
+
+bool CaptureRecorder::getIsRecording()
+{
+    return recording && isWriting;
+}
+
+
+std::string CaptureRecorder::getOutputPath()
+{
+    std::lock_guard<std::mutex> lock(pathMutex);
+    return outputPath;
+}
+
+
+int CaptureRecorder::getFileCount()
+{
+    return fileCount;
+}
+
+
+uint64_t CaptureRecorder::getFramesWritten()
+{
+    return framesWritten;
+}
+
+
+uint64_t CaptureRecorder::getFramesDropped()
+{
+    return framesDropped;
+}
+
+
+void CaptureRecorder::writerLoop()
+{
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        bool isStopping;
+        {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            stopCondition.wait_for(lock, s_POLL_INTERVAL,
+                                   [this] { return stopping; });
+            isStopping = stopping;
+        }
+
+        // what was published before stop() is kept
+        if (!drain())
+        {
+            std::cout << "Capture Recorder: failed to write "
+                      << getOutputPath() << std::endl;
+            break;
+        }
+
+        if (isStopping)
+        {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastFlush >= s_FLUSH_INTERVAL)
+        {
+            file.flush();
+            lastFlush = now;
+        }
+    }
+
+    file.close();
+    this->isWriting = false;
+}
+
+
+bool CaptureRecorder::drain()
+{
+    // up to here only, so a slow disk can't keep the writer in here
+    uint64_t end = ring->getWriteCount();
+
+    while (nextSample < end)
+    {
+        uint64_t nSkipped = 0;
+        uint64_t nSamples = ring->readNext(chunk.data(), &nextSample,
+                                           std::min<uint64_t>(chunk.size(), end - nextSample),
+                                           channels, &nSkipped);
+
+        // overwritten before the writer got to them, the gap is kept
+        if (nSkipped > 0)
+        {
+            uint64_t nDropped = nSkipped / channels;
+            if (!writeSilence(nDropped))
+            {
+                return false;
+            }
+
+            this->framesDropped += nDropped;
+            this->framesWritten += nDropped;
+        }
+
+        if (nSamples == 0)
+        {
+            break;
+        }
+
+        uint64_t nFrames = nSamples / channels;
+        if (!writeFrames(chunk.data(), nFrames))
+        {
+            return false;
+        }
+
+        this->framesWritten += nFrames;
+    }
+
+    return true;
+}
+
+
+bool CaptureRecorder::writeFrames(const float* frames, uint64_t nFrames)
+{
+    while (nFrames > 0)
+    {
+        // rotated only once there is more to write, no empty last file
+        if (maxFileFrames > 0 && file.getFramesWritten() >= maxFileFrames)
+        {
+            if (!openNextFile())
+            {
+                return false;
+            }
+        }
+
+        uint64_t room = (maxFileFrames > 0)
+                        ? maxFileFrames - file.getFramesWritten()
+                        : nFrames;
+        uint64_t len = std::min(nFrames, room);
+
+        if (!file.write(frames, len))
+        {
+            return false;
+        }
+
+        frames += len * channels;
+        nFrames -= len;
+    }
+
+    return true;
+}
+
+
+bool CaptureRecorder::writeSilence(uint64_t nFrames)
+{
+    while (nFrames > 0)
+    {
+        uint64_t len = std::min<uint64_t>(nFrames, s_CHUNK_FRAMES);
+
+        if (!writeFrames(silence.data(), len))
+        {
+            return false;
+        }
+
+        nFrames -= len;
+    }
+
+    return true;
+}
+
+
+bool CaptureRecorder::openNextFile()
+{
+    file.close();
+
+    // the same time stamp as a recording just before, numbered after it
+    std::string filepath;
+    while (true)
+    {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "_%03d.wav", fileNumber++);
+        filepath = filePrefix + suffix;
+
+        FILE* existing = fopen(filepath.c_str(), "rb");
+        if (existing == nullptr)
+        {
+            break;
+        }
+        fclose(existing);
+    }
+
+    if (!file.open(filepath.c_str(), channels, sampleRate))
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pathMutex);
+        this->outputPath = filepath;
+    }
+    ++fileCount;
+
+    return true;
+}
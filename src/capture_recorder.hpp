@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+// CaptureRecorder class for recording a SampleRing to disk
+//
+// A writer thread follows the ring's write counter and appends whatever the
+// producer (the microphone callback) published since its last pass to a
+// float-32 WAV file, so the callback itself never touches the disk and a
+// capture of any length takes the same memory. Files are rotated once they
+// reach a duration or a size, and their header is patched about once a
+// second, so a file being written already opens as a complete WAV. Files
+// already there are never overwritten, a recording started again within
+// the same second is numbered after them.
+//
+// If the disk falls so far behind that the producer overwrote samples not
+// yet written, the writer skips ahead, counts the frames dropped and writes
+// as much silence in their place, so the time in the files stays the time
+// of the capture.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CAPTURE_RECORDER_HPP
+#define CAPTURE_RECORDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+#include "sample_ring.hpp"
+#include "wav_writer.hpp"
+
+class CaptureRecorder
+{
+public:
+    CaptureRecorder();
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    /// Start recording the samples written to a ring from now on,
+    /// file names are time stamped and numbered
+    ///
+    /// \param ring             ring of interleaved frames, not owned,
+    ///                         must not be reallocated until stop()
+    ///
+    /// \param channels         channels per frame in the ring
+    ///
+    /// \param sampleRate       sample rate written to the WAV headers
+    ///
+    /// \param folderPath       existing output folder
+    ///
+    /// \param maxFileSec       start a new file after this many seconds,
+    ///                         0 for no limit
+    ///
+    /// \param maxFileBytes     start a new file before it outgrows this,
+    ///                         0 for no limit
+    ///
+    /// \return                 whether the first file could be created
+    ///
+    bool start(SampleRing* ring,
+               int channels,
+               int sampleRate,
+               const char* folderPath,
+               int maxFileSec = 0,
+               uint64_t maxFileBytes = 0);
+
+    /// Stop recording, writes what the ring holds up to now and closes the
+    /// file
+    ///
+    void stop();
+
+    /// \return     false once stopped, or if the writer failed
+    ///
+    bool getIsRecording();
+
+    /// \return     path of the file being written
+    ///
+    std::string getOutputPath();
+
+    /// \return     number of files created since start()
+    ///
+    int getFileCount();
+
+    /// \return     number of frames written since start(), the silence
+    ///             in place of the dropped ones included
+    ///
+    uint64_t getFramesWritten();
+
+    /// \return     number of frames overwritten before they were written,
+    ///             written as silence
+    ///
+    uint64_t getFramesDropped();
+
+private:
+    // frames copied out of the ring per write
+    static constexpr uint64_t s_CHUNK_FRAMES = 4096;
+
+    // settings
+    SampleRing* ring;
+    int channels;
+    int sampleRate;
+    std::string filePrefix;
+    uint64_t maxFileFrames;     // 0 for no limit
+    bool recording;
+
+    // writer thread
+    std::thread writer;
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stopping;
+
+    std::atomic<bool> isWriting;
+    std::atomic<int> fileCount;
+    int fileNumber;             // of the next file, past existing ones
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> framesDropped;
+
+    // writer thread only, but the path is read by the UI
+    WavWriter file;
+    std::mutex pathMutex;
+    std::string outputPath;
+    uint64_t nextSample;        // ring count of the next sample to write
+    std::vector<float> chunk;
+    std::vector<float> silence; // zeros, as long as chunk
+
+    void writerLoop();
+
+    /// Write everything published up to now
+    ///
+    /// \return     false on a write error
+    ///
+    bool drain();
+
+    /// Append frames, rotating the file where the limit falls
+    bool writeFrames(const float* frames, uint64_t nFrames);
+
+    /// Append nFrames of zeros in place of frames dropped
+    bool writeSilence(uint64_t nFrames);
+
+    /// Close the current file and create the next numbered one
+    bool openNextFile();
+};
+
+#endif
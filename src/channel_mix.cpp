@@ -0,0 +1,164 @@
+#include "channel_mix.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHANNEL_MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+
+void channelMixDownmix(float* dst,
+                       const float* src,
+                       const int nFrames,
+                       const int channels)
+{
+    if (channels == 1)
+    {
+        memcpy(dst, src, nFrames * sizeof(float));
+        return;
+    }
+
+    int i = 0;
+
+    if (channels == 2)
+    {
+#ifdef CHANNEL_MIX_SSE2
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        for (; i + 4 <= nFrames; i += 4)
+        {
+            // [L0 R0 L1 R1] [L2 R2 L3 R3] -> [L0 L1 L2 L3] [R0 R1 R2 R3]
+            __m128 a = _mm_loadu_ps(&src[2 * i]);
+            __m128 b = _mm_loadu_ps(&src[2 * i + 4]);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+            _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+#endif
+
+        for (; i < nFrames; ++i)
+        {
+            dst[i] = (src[2 * i] + src[2 * i + 1]) * 0.5f;
+        }
+        return;
+    }
+
+    const float scale = 1.0f / channels;
+
+    for (; i < nFrames; ++i)
+    {
+        const float* frame = &src[i * channels];
+
+        float sum = frame[0];
+        for (int c = 1; c < channels; ++c)
+        {
+            sum += frame[c];
+        }
+        dst[i] = sum * scale;
+    }
+}
+
+
+void channelMixExtract(float* dst,
+                       const float* src,
+                       const int nFrames,
+                       const int channels,
+                       const int channel)
+{
+    if (channels == 1)
+    {
+        memcpy(dst, src, nFrames * sizeof(float));
+        return;
+    }
+
+    int i = 0;
+
+#ifdef CHANNEL_MIX_SSE2
+    if (channels == 2)
+    {
+        for (; i + 4 <= nFrames; i += 4)
+        {
+            __m128 a = _mm_loadu_ps(&src[2 * i]);
+            __m128 b = _mm_loadu_ps(&src[2 * i + 4]);
+            __m128 out = (channel == 0)
+                         ? _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))
+                         : _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+            _mm_storeu_ps(&dst[i], out);
+        }
+    }
+#endif
+
+    for (; i < nFrames; ++i)
+    {
+        dst[i] = src[i * channels + channel];
+    }
+}
+
+
+void channelMixMidSide(float* mid,
+                       float* side,
+                       const float* src,
+                       const int nFrames,
+                       const int channels)
+{
+    int i = 0;
+
+#ifdef CHANNEL_MIX_SSE2
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    if (channels == 2)
+    {
+        for (; i + 4 <= nFrames; i += 4)
+        {
+            __m128 a = _mm_loadu_ps(&src[2 * i]);
+            __m128 b = _mm_loadu_ps(&src[2 * i + 4]);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+            _mm_storeu_ps(&mid[i], _mm_mul_ps(_mm_add_ps(left, right), half));
+            _mm_storeu_ps(&side[i], _mm_mul_ps(_mm_sub_ps(left, right), half));
+        }
+    }
+#endif
+
+    for (; i < nFrames; ++i)
+    {
+        float left = src[i * channels];
+        float right = src[i * channels + 1];
+
+        mid[i] = (left + right) * 0.5f;
+        side[i] = (left - right) * 0.5f;
+    }
+}
+
+
+int channelMixGetNumOutputs(channelMixMode mode, int channels)
+{
+    if (channels < 2)
+    {
+        return 1;
+    }
+
+    if (mode == CHANNEL_MIX_EACH)
+    {
+        return channels;
+    }
+
+    return (mode == CHANNEL_MIX_SPLIT || mode == CHANNEL_MIX_MID_SIDE) ? 2 : 1;
+}
+
+
+void channelMixGetTiles(int nOutputs, int* nCols, int* nRows)
+{
+    int cols = 1;
+    while (cols * cols < nOutputs)
+    {
+        ++cols;
+    }
+
+    *nCols = cols;
+    *nRows = (nOutputs + cols - 1) / cols;
+}
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// Library for splitting interleaved multichannel audio into the mono
+// signals the spectrogram is computed from
+//
+// Frames are interleaved as [ch0 ch1 ... chN-1 ch0 ch1 ...] (SDL_AudioSpec,
+// WAV), the outputs are planar. Stereo, by far the most common input, uses
+// SSE2 when available, with a scalar fallback giving identical results.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CHANNEL_MIX_HPP
+#define CHANNEL_MIX_HPP
+
+/// Signals analysed from a multichannel input
+///
+typedef enum {
+    CHANNEL_MIX_DOWNMIX,    /// average of all channels, one spectrogram
+    CHANNEL_MIX_SELECT,     /// a single channel, one spectrogram
+    CHANNEL_MIX_SPLIT,      /// the first two channels, one spectrogram each
+    CHANNEL_MIX_MID_SIDE,   /// (L + R)/2 and (L - R)/2, one spectrogram each
+    CHANNEL_MIX_EACH        /// every channel, one spectrogram each
+} channelMixMode;
+
+/// Placement of the spectrograms when there are several
+///
+typedef enum {
+    CHANNEL_MIX_STACKED,        /// one behind the other along the time axis
+    CHANNEL_MIX_SIDE_BY_SIDE,   /// next to each other along the frequency axis
+    CHANNEL_MIX_TILED           /// in a grid, rows along the time axis
+} channelMixLayout;
+
+
+/// Average all channels into one
+///
+/// \param dst          output array (array must have a length of nFrames)
+///
+/// \param src          interleaved input
+///                     (array must have a length of nFrames * channels)
+///
+/// \param nFrames      number of frames
+///
+/// \param channels     number of channels in src
+///
+void channelMixDownmix(float* dst,
+                       const float* src,
+                       const int nFrames,
+                       const int channels);
+
+
+/// Copy out a single channel
+///
+/// \param channel      index of the channel, must be smaller than channels
+///
+void channelMixExtract(float* dst,
+                       const float* src,
+                       const int nFrames,
+                       const int channels,
+                       const int channel);
+
+
+/// Mid (L + R)/2 and side (L - R)/2 of the first two channels,
+/// any other channel is ignored
+///
+/// \param mid          output array (array must have a length of nFrames)
+///
+/// \param side         output array (array must have a length of nFrames)
+///
+/// \param channels     number of channels in src, must be at least 2
+///
+void channelMixMidSide(float* mid,
+                       float* side,
+                       const float* src,
+                       const int nFrames,
+                       const int channels);
+
+
+/// \return     number of spectrograms drawn in the mode,
+///             1 if the input has a single channel
+///
+int channelMixGetNumOutputs(channelMixMode mode, int channels);
+
+
+/// Grid of the tiled layout, as square as it gets with more columns than
+/// rows, e.g. 3 x 2 for 5 spectrograms
+///
+/// \param nOutputs     number of spectrograms, at least 1
+///
+/// \param nCols        number of tiles along the frequency axis
+///
+/// \param nRows        number of tiles along the time axis
+///
+void channelMixGetTiles(int nOutputs, int* nCols, int* nRows);
+
+#endif
@@ -0,0 +1,200 @@
+#include "colormap.hpp"
+
+#include <cassert>
+#include <cmath>
+
+/// 3x3 matrix multiplication, m is in row-major order (math style)
+static void s_mat3Mul(float* out, const float m[9], const float* v)
+{
+    out[0] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2];
+    out[1] = m[3] * v[0] + m[4] * v[1] + m[5] * v[2];
+    out[2] = m[6] * v[0] + m[7] * v[1] + m[8] * v[2];
+}
+
+
+static float s_clamp01(float x)
+{
+    return fminf(fmaxf(x, 0.0f), 1.0f);
+}
+
+
+/// 6th order polynomial fit of matplotlib's colormaps, coefficients c0..c6
+/// for r, g and b respectively (public domain fit by Matt Zucker)
+static void s_polynomial(float* rgb, const float c[7][3], float t)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        // Horner's method
+        float value = c[6][k];
+        for (int n = 5; n >= 0; --n)
+        {
+            value = value * t + c[n][k];
+        }
+        rgb[k] = value;
+    }
+}
+
+
+static const float s_viridis[7][3] = {
+    { 0.2777273272234177f,  0.005407344544966578f,  0.3340998053353061f},
+    { 0.1050930431085774f,  1.404613529898575f,     1.384590162594685f},
+    {-0.3308618287255563f,  0.214847559468213f,     0.09509516302823659f},
+    {-4.634230498983486f,  -5.799100973351585f,   -19.33244095627987f},
+    { 6.228269936347081f,  14.17993336680509f,     56.69055260068105f},
+    { 4.776384997670288f, -13.74514537774601f,    -65.35303263337234f},
+    {-5.435455855934631f,   4.645852612178535f,    26.3124352495832f}
+};
+
+static const float s_magma[7][3] = {
+    {-0.002136485053939582f, -0.000749655052795221f, -0.005386127855323933f},
+    { 0.2516605407371642f,    0.6775232436837668f,    2.494026599312351f},
+    { 8.353717279216625f,    -3.577719514958484f,     0.3144679030132573f},
+    {-27.66873308576866f,    14.26473078096533f,    -13.64921318813922f},
+    { 52.17613981234068f,   -27.94360607168351f,     12.94416944238394f},
+    {-50.76852536473588f,    29.04658282127291f,      4.23415299384598f},
+    { 18.65570506591883f,   -11.48977351997711f,     -5.601961508734096f}
+};
+
+static const float s_inferno[7][3] = {
+    { 0.0002189403691192265f,  0.001651004631001012f, -0.01948089843709184f},
+    { 0.1065134194856116f,     0.5639564367884091f,    3.932712388889277f},
+    { 11.60249308247187f,     -3.972853965665698f,   -15.9423941062914f},
+    {-41.70399613139459f,     17.43639888205313f,     44.35414519872813f},
+    { 77.162935699427f,      -33.40235894210092f,    -81.80730925738993f},
+    {-71.31942824499214f,     32.62606426397723f,     73.20951985803202f},
+    { 25.13112622477341f,    -12.24266895238567f,    -23.07032500287172f}
+};
+
+
+void colormapSrgbToOklab(float* lab, const float* rgb)
+{
+    static const float m1[9] = {
+        0.4122214708f,  0.5363325363f,  0.0514459929f,
+        0.2119034982f,  0.6806995451f,  0.1073969566f,
+        0.0883024619f,  0.2817188376f,  0.6299787005f
+    };
+
+    static const float m2[9] = {
+        0.2104542553f,  0.7936177850f, -0.0040720468f,
+        1.9779984951f, -2.4285922050f,  0.4505937099f,
+        0.0259040371f,  0.7827717662f, -0.8086757660f
+    };
+
+    float lms[3];
+    s_mat3Mul(lms, m1, rgb);
+
+    // cube root, cbrtf handles negative values unlike pow in GLSL
+    for (int k = 0; k < 3; ++k)
+    {
+        lms[k] = cbrtf(lms[k]);
+    }
+
+    s_mat3Mul(lab, m2, lms);
+}
+
+
+void colormapOklabToSrgb(float* rgb, const float* lab)
+{
+    static const float m2_[9] = {
+        1.0000000000f,  0.3963377774f,  0.2158037573f,
+        1.0000000000f, -0.1055613458f, -0.0638541728f,
+        1.0000000000f, -0.0894841775f, -1.2914855480f
+    };
+
+    static const float m1_[9] = {
+         4.0767416621f, -3.3077115913f,  0.2309699292f,
+        -1.2684380046f,  2.6097574011f, -0.3413193965f,
+        -0.0041960863f, -0.7034186147f,  1.7076147010f
+    };
+
+    float lms[3];
+    s_mat3Mul(lms, m2_, lab);
+
+    for (int k = 0; k < 3; ++k)
+    {
+        lms[k] = lms[k] * lms[k] * lms[k];
+    }
+
+    s_mat3Mul(rgb, m1_, lms);
+}
+
+
+void colormapOklabRamp(float* lut,
+                       const int lutLen,
+                       const float* rgb0,
+                       const float* rgb1)
+{
+    assert(lutLen >= 2);
+
+    // convert to OKLAB before interpolate
+    float lab0[3];
+    float lab1[3];
+    colormapSrgbToOklab(lab0, rgb0);
+    colormapSrgbToOklab(lab1, rgb1);
+
+    for (int i = 0; i < lutLen; ++i)
+    {
+        float height = static_cast<float>(i) / static_cast<float>(lutLen - 1);
+
+        float lab[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            lab[k] = height * lab0[k] + (1.0f - height) * lab1[k];
+        }
+
+        colormapOklabToSrgb(&lut[3 * i], lab);
+    }
+}
+
+
+void colormapFill(float* lut,
+                  const int lutLen,
+                  const colormapType type,
+                  const float* rgb0,
+                  const float* rgb1)
+{
+    assert(lutLen >= 2);
+
+    switch (type)
+    {
+        case COLORMAP_OKLAB:
+            colormapOklabRamp(lut, lutLen, rgb0, rgb1);
+            break;
+        case COLORMAP_VIRIDIS:
+        case COLORMAP_MAGMA:
+        case COLORMAP_INFERNO:
+        {
+            const float (*coefficients)[3] =
+                (type == COLORMAP_VIRIDIS) ? s_viridis :
+                (type == COLORMAP_MAGMA)   ? s_magma   : s_inferno;
+
+            for (int i = 0; i < lutLen; ++i)
+            {
+                float t = static_cast<float>(i) / static_cast<float>(lutLen - 1);
+                s_polynomial(&lut[3 * i], coefficients, t);
+            }
+            break;
+        }
+        default:
+            assert(false && "colormap not supported");
+    }
+
+    // OKLAB to RGB can land slightly outside of the gamut
+    for (int i = 0; i < lutLen * 3; ++i)
+    {
+        lut[i] = s_clamp01(lut[i]);
+    }
+}
+
+
+const char* colormapGetName(const colormapType type)
+{
+    switch (type)
+    {
+        case COLORMAP_OKLAB:    return "OKLAB Ramp";
+        case COLORMAP_VIRIDIS:  return "Viridis";
+        case COLORMAP_MAGMA:    return "Magma";
+        case COLORMAP_INFERNO:  return "Inferno";
+        default:                return "Unknown";
+    }
+}
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+// Library for baking perceptual colormaps into lookup tables (LUT)
+//
+// The colormaps are evaluated once on the CPU, the fragment shader only has
+// to fetch the color from the LUT texture (see ColormapTexture)
+//
+//===----------------------------------------------------------------------===//
+// Variable Conventions:
+//  lut:        RGB interleaved lookup table [r0, g0, b0, r1, g1, b1, ...]
+//              lut[0] is the color of height 0, lut[lutLen - 1] is height 1
+//  lutLen:     number of colors in the lookup table
+
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+
+/// Range of LUT length, also the texture width of ColormapTexture
+constexpr int COLORMAP_MIN_LUT_LEN = 256;
+constexpr int COLORMAP_MAX_LUT_LEN = 4096;
+
+
+/// Available colormaps
+///
+typedef enum {
+    COLORMAP_OKLAB,     /// ramp between two user colors interpolated in OKLAB
+    COLORMAP_VIRIDIS,   /// matplotlib viridis (polynomial approximation)
+    COLORMAP_MAGMA,     /// matplotlib magma (polynomial approximation)
+    COLORMAP_INFERNO    /// matplotlib inferno (polynomial approximation)
+} colormapType;
+
+
+/// Convert an RGB color to the OKLAB colorspace
+///
+/// Note:   same as srgb_to_oklab() in the old rect.fs, the input is NOT
+///         linearized, so the ramp looks the same as before
+///
+/// \param lab      OKLAB output, len = 3
+///
+/// \param rgb      RGB input in [0, 1], len = 3
+///
+void colormapSrgbToOklab(float* lab, const float* rgb);
+
+
+/// Convert an OKLAB color back to RGB, inverse of colormapSrgbToOklab()
+///
+/// \param rgb      RGB output, not clamped, len = 3
+///
+/// \param lab      OKLAB input, len = 3
+///
+void colormapOklabToSrgb(float* rgb, const float* lab);
+
+
+/// Fill a LUT with a ramp interpolated in the OKLAB colorspace
+///
+/// \param lut      pointer to the lookup table
+///                 (array must have a length of lutLen * 3)
+///
+/// \param lutLen   number of colors in the lookup table, must be >= 2
+///
+/// \param rgb0     color at height 1 (top of the spectrogram), len = 3
+///
+/// \param rgb1     color at height 0 (noise floor), len = 3
+///
+void colormapOklabRamp(float* lut,
+                       const int lutLen,
+                       const float* rgb0,
+                       const float* rgb1);
+
+
+/// Fill a LUT with one of the available colormaps, output clamped to [0, 1]
+///
+/// \param lut      pointer to the lookup table
+///                 (array must have a length of lutLen * 3)
+///
+/// \param lutLen   number of colors in the lookup table, must be >= 2
+///
+/// \param type     colormap type
+///
+/// \param rgb0     color at height 1, only used by COLORMAP_OKLAB, len = 3
+///
+/// \param rgb1     color at height 0, only used by COLORMAP_OKLAB, len = 3
+///
+void colormapFill(float* lut,
+                  const int lutLen,
+                  const colormapType type,
+                  const float* rgb0,
+                  const float* rgb1);
+
+
+/// \return     display name of the colormap, for the GUI
+///
+const char* colormapGetName(const colormapType type);
+
+#endif
@@ -0,0 +1,136 @@
+#include "colormap_texture.hpp"
+
+#include <vector>
+#include <algorithm>
+
+ColormapTexture::ColormapTexture(const int lutLen,
+                                 const colormapType type,
+                                 const glm::vec3 rgb0,
+                                 const glm::vec3 rgb1)
+    :   texture(0),
+        lutLen(lutLen),
+        type(type),
+        rgb0(rgb0),
+        rgb1(rgb1)
+{
+    // clamp the LUT length to what we (and the driver) support
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+    this->lutLen = std::max(COLORMAP_MIN_LUT_LEN, 
+                            std::min(lutLen, COLORMAP_MAX_LUT_LEN));
+    if (maxTextureSize > 0)
+    {
+        this->lutLen = std::min(this->lutLen, static_cast<int>(maxTextureSize));
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // allocate once, rebuild() only substitutes the data
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->lutLen, 1,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    // linear filtering between neighbouring colors
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    this->rebuild();
+}
+
+
+ColormapTexture::~ColormapTexture()
+{
+    glDeleteTextures(1, &texture);
+}
+
+
+void ColormapTexture::bind(const int textureUnit) const
+{
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+
+void ColormapTexture::setColormap(const colormapType type,
+                                  const glm::vec3 rgb0,
+                                  const glm::vec3 rgb1)
+{
+    // the endpoints only matter for the OKLAB ramp
+    bool changed = (type != this->type) ||
+                   (type == COLORMAP_OKLAB &&
+                    (rgb0 != this->rgb0 || rgb1 != this->rgb1));
+
+    this->type = type;
+    this->rgb0 = rgb0;
+    this->rgb1 = rgb1;
+
+    if (changed)
+    {
+        this->rebuild();
+    }
+    else
+    {
+        // nothing, the LUT is still valid
+    }
+}
+
+
+GLuint ColormapTexture::getTextureID()
+{
+    return this->texture;
+}
+
+
+int ColormapTexture::getLutLen()
+{
+    return this->lutLen;
+}
+
+
+colormapType ColormapTexture::getType()
+{
+    return this->type;
+}
+
+
+glm::vec3 ColormapTexture::getColor0()
+{
+    return this->rgb0;
+}
+
+
+glm::vec3 ColormapTexture::getColor1()
+{
+    return this->rgb1;
+}
+
+
+void ColormapTexture::rebuild()
+{
+    // bake the colormap on the CPU
+    // ----------------------------
+    std::vector<float> lut(lutLen * 3);
+    colormapFill(lut.data(), lutLen, type, &rgb0[0], &rgb1[0]);
+
+    // quantize to RGBA8
+    std::vector<unsigned char> texels(lutLen * 4);
+    for (int i = 0; i < lutLen; ++i)
+    {
+        texels[4 * i]     = static_cast<unsigned char>(lut[3 * i] * 255.0f + 0.5f);
+        texels[4 * i + 1] = static_cast<unsigned char>(lut[3 * i + 1] * 255.0f + 0.5f);
+        texels[4 * i + 2] = static_cast<unsigned char>(lut[3 * i + 2] * 255.0f + 0.5f);
+        texels[4 * i + 3] = 255;
+    }
+
+    // upload to the GPU
+    // -----------------
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lutLen, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+// ColormapTexture class for uploading a colormap LUT to an OpenGL texture
+//
+// OpenGL ES 3.0 has no 1D texture, the LUT is stored as a lutLen x 1
+// 2D texture and sampled with texture(lut, vec2(u, 0.5)) in the shader
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COLORMAP_TEXTURE_HPP
+#define COLORMAP_TEXTURE_HPP
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "colormap.hpp"
+
+class ColormapTexture
+{
+public:
+    /// Bake the colormap and upload it to the GPU
+    ///
+    /// \param lutLen   number of texels in the LUT, clamped to
+    ///                 [COLORMAP_MIN_LUT_LEN, COLORMAP_MAX_LUT_LEN]
+    ///                 and GL_MAX_TEXTURE_SIZE, defaulted to 1024
+    ///
+    /// \param type     colormap type, defaulted to COLORMAP_OKLAB
+    ///
+    /// \param rgb0     color at height 1, only used by COLORMAP_OKLAB
+    ///
+    /// \param rgb1     color at height 0, only used by COLORMAP_OKLAB
+    ///
+    ColormapTexture(const int lutLen = 1024,
+                    const colormapType type = COLORMAP_OKLAB,
+                    const glm::vec3 rgb0 = glm::vec3(0.906f, 1.000f, 0.529f),
+                    const glm::vec3 rgb1 = glm::vec3(0.000f, 0.502f, 0.502f));
+
+    ~ColormapTexture();
+
+    /// Bind the LUT to a texture unit
+    ///
+    /// \param textureUnit  texture unit index, i.e. GL_TEXTURE0 + textureUnit
+    ///
+    void bind(const int textureUnit = 0) const;
+
+    /// Change the colormap, the LUT is only rebuilt and re-uploaded when
+    /// the type or the endpoints (for COLORMAP_OKLAB) actually changed
+    ///
+    /// \param type     colormap type
+    ///
+    /// \param rgb0     color at height 1, only used by COLORMAP_OKLAB
+    ///
+    /// \param rgb1     color at height 0, only used by COLORMAP_OKLAB
+    ///
+    void setColormap(const colormapType type,
+                     const glm::vec3 rgb0,
+                     const glm::vec3 rgb1);
+
+    /// \return     the OpenGL texture ID, e.g. for drawing a colorbar in ImGui
+    ///
+    GLuint getTextureID();
+
+    /// \return     number of texels in the LUT
+    ///
+    int getLutLen();
+
+    colormapType getType();
+    glm::vec3 getColor0();
+    glm::vec3 getColor1();
+
+private:
+    GLuint texture;
+    int lutLen;
+
+    colormapType type;
+    glm::vec3 rgb0;
+    glm::vec3 rgb1;
+
+    /// Bake the LUT on the CPU and upload it to the texture
+    void rebuild();
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "converted_source.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "channel_mix.hpp"
+
+
+ConvertedSource::ConvertedSource(AudioSource* source, int channels, int sampleRate)
+    :   source(source),
+        channels(channels),
+        sampleRate(sampleRate)
+{
+    int sourceRate = source->getSampleRate();
+
+    this->totalFrames = (sourceRate > 0)
+                        ? source->getTotalFrames() * sampleRate / sourceRate
+                        : 0;
+
+    this->initStream(playback);
+    this->initStream(peek);
+}
+
+
+int ConvertedSource::getChannels()
+{
+    return this->channels;
+}
+
+
+int ConvertedSource::getSampleRate()
+{
+    return this->sampleRate;
+}
+
+
+uint64_t ConvertedSource::getTotalFrames()
+{
+    return this->totalFrames;
+}
+
+
+uint64_t ConvertedSource::readFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    return this->convert(playback, dst, frame, nFrames, false);
+}
+
+
+uint64_t ConvertedSource::peekFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    return this->convert(peek, dst, frame, nFrames, true);
+}
+
+
+double ConvertedSource::getDecodeThroughputMBs()
+{
+    return source->getDecodeThroughputMBs();
+}
+
+
+void ConvertedSource::initStream(Stream& stream)
+{
+    int sourceChannels = source->getChannels();
+
+    stream.resampler.init(sourceChannels, source->getSampleRate(), sampleRate);
+
+    // sized up front, the callback doesn't allocate, the filter history
+    // included
+    stream.resampler.reserve(s_CHUNK_FRAMES);
+    int maxOut = stream.resampler.getMaxOutputFrames(
+        s_CHUNK_FRAMES + stream.resampler.getNumTaps());
+
+    stream.inBuffer.resize(s_CHUNK_FRAMES * sourceChannels);
+    stream.outBuffer.resize(static_cast<size_t>(maxOut) * sourceChannels);
+    stream.outStart = 0;
+    stream.outEnd = 0;
+    stream.nextFrame = 0;
+    stream.isStarted = false;
+}
+
+
+uint64_t ConvertedSource::convert(Stream& stream, float* dst, uint64_t frame,
+                                  uint64_t nFrames, bool isPeek)
+{
+    int sourceChannels = source->getChannels();
+    uint64_t sourceTotal = source->getTotalFrames();
+
+    if (!stream.isStarted || frame != stream.nextFrame)
+    {
+        stream.resampler.reset(frame);
+        stream.outStart = 0;
+        stream.outEnd = 0;
+        stream.nextFrame = frame;
+        stream.isStarted = true;
+    }
+
+    uint64_t available = (frame < totalFrames) ? totalFrames - frame : 0;
+    uint64_t toConvert = std::min(nFrames, available);
+    uint64_t done = 0;
+
+    while (done < toConvert)
+    {
+        if (stream.outStart < stream.outEnd)
+        {
+            uint64_t n = std::min(static_cast<uint64_t>(stream.outEnd - stream.outStart),
+                                  toConvert - done);
+
+            this->mapChannels(&dst[done * channels],
+                              &stream.outBuffer[stream.outStart * sourceChannels],
+                              n);
+
+            stream.outStart += n;
+            stream.nextFrame += n;
+            done += n;
+            continue;
+        }
+
+        // refill from where the filter needs its input
+        uint64_t inFrame = stream.resampler.getNextInputFrame();
+        uint64_t nRead;
+
+        if (inFrame < sourceTotal)
+        {
+            uint64_t len = std::min(static_cast<uint64_t>(s_CHUNK_FRAMES),
+                                    sourceTotal - inFrame);
+
+            nRead = isPeek
+                    ? source->peekFrames(stream.inBuffer.data(), inFrame, len)
+                    : source->readFrames(stream.inBuffer.data(), inFrame, len);
+
+            if (nRead == 0)
+            {
+                // a decoder is behind, try again on the next read
+                break;
+            }
+        }
+        else
+        {
+            // past the end, flush the last half filter with silence
+            std::fill(stream.inBuffer.begin(), stream.inBuffer.end(), 0.0f);
+            nRead = s_CHUNK_FRAMES;
+        }
+
+        size_t maxOut = static_cast<size_t>(
+            stream.resampler.getMaxOutputFrames(static_cast<int>(nRead)));
+        if (stream.outBuffer.size() < maxOut * sourceChannels)
+        {
+            stream.outBuffer.resize(maxOut * sourceChannels);
+        }
+
+        stream.outStart = 0;
+        stream.outEnd = stream.resampler.process(stream.inBuffer.data(),
+                                                 static_cast<int>(nRead),
+                                                 stream.outBuffer.data());
+    }
+
+    if (done < nFrames)
+    {
+        memset(&dst[done * channels], 0, (nFrames - done) * channels * sizeof(float));
+    }
+
+    return done;
+}
+
+
+void ConvertedSource::mapChannels(float* dst, const float* src, uint64_t nFrames)
+{
+    int sourceChannels = source->getChannels();
+    int nCommon = std::min(sourceChannels, channels);
+
+    if (sourceChannels == channels)
+    {
+        memcpy(dst, src, nFrames * channels * sizeof(float));
+    }
+    else if (channels == 1)
+    {
+        channelMixDownmix(dst, src, static_cast<int>(nFrames), sourceChannels);
+    }
+    else if (sourceChannels == 1)
+    {
+        for (uint64_t i = 0; i < nFrames; ++i)
+        {
+            std::fill(&dst[i * channels], &dst[(i + 1) * channels], src[i]);
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < nFrames; ++i)
+        {
+            memcpy(&dst[i * channels], &src[i * sourceChannels], nCommon * sizeof(float));
+            std::fill(&dst[i * channels + nCommon], &dst[(i + 1) * channels], 0.0f);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+// AudioSource in the playback device's format
+//
+// Wraps the source of a file whose rate or channel count differs from what
+// the device opened with, so SDL is never asked to convert. Frames are
+// resampled with Resampler as they are read and the channels mapped after:
+// copied when the counts match, mono duplicated to every output, downmixed
+// to a mono output, otherwise the first channels copied and the rest silent.
+//
+// Playback and analysis each keep their own filter history, so peeking
+// doesn't disturb the stream read by the callback. Reading anywhere other
+// than where the last read ended (e.g. after a seek) restarts the filter at
+// that frame.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CONVERTED_SOURCE_HPP
+#define CONVERTED_SOURCE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "audio_source.hpp"
+#include "resampler.hpp"
+
+class ConvertedSource : public AudioSource
+{
+public:
+    /// \param source       source in the file's format, not owned,
+    ///                     must outlive this
+    ///
+    /// \param channels     number of output channels
+    ///
+    /// \param sampleRate   output sample rate in Hz
+    ///
+    ConvertedSource(AudioSource* source, int channels, int sampleRate);
+
+    ConvertedSource(const ConvertedSource&) = delete;
+    ConvertedSource& operator=(const ConvertedSource&) = delete;
+
+    int getChannels() override;
+    int getSampleRate() override;
+
+    /// \return     length of the source at the output rate
+    ///
+    uint64_t getTotalFrames() override;
+
+    uint64_t readFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+    uint64_t peekFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+
+    double getDecodeThroughputMBs() override;
+
+private:
+    // input frames per refill
+    static constexpr int s_CHUNK_FRAMES = 1024;
+
+    struct Stream
+    {
+        Resampler resampler;
+
+        // converted but not yet read, at the source's channel count
+        std::vector<float> inBuffer;
+        std::vector<float> outBuffer;
+        size_t outStart, outEnd;
+
+        // output frame the pending frames start at
+        uint64_t nextFrame;
+        bool isStarted;
+    };
+
+    AudioSource* source;
+    int channels;
+    int sampleRate;
+    uint64_t totalFrames;
+
+    Stream playback;
+    Stream peek;
+
+    void initStream(Stream& stream);
+
+    /// Convert from the source, read or peeked
+    uint64_t convert(Stream& stream, float* dst, uint64_t frame,
+                     uint64_t nFrames, bool isPeek);
+
+    /// Source channels to output channels
+    void mapChannels(float* dst, const float* src, uint64_t nFrames);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "dynamic_resolution.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+DynamicResolution::DynamicResolution(float budgetMs, float minScale)
+    :   enabled(false),
+        budgetMs(budgetMs),
+        minScale(std::max(0.1f, std::min(minScale, 1.0f))),
+        scale(1.0f),
+        framesOver(0),
+        framesUnder(0),
+        cooldown(0)
+{
+
+}
+
+
+float DynamicResolution::update(float gpuFrameMs)
+{
+    if (!enabled || std::isnan(gpuFrameMs) || gpuFrameMs <= 0.0f)
+    {
+        return this->getScale();
+    }
+
+    if (cooldown > 0)
+    {
+        // still measuring frames from before the last change
+        --cooldown;
+        return scale;
+    }
+
+    if (gpuFrameMs > budgetMs)
+    {
+        ++framesOver;
+        this->framesUnder = 0;
+    }
+    else if (gpuFrameMs < s_HEADROOM * budgetMs)
+    {
+        ++framesUnder;
+        this->framesOver = 0;
+    }
+    else
+    {
+        // within budget, keep the scale
+        this->framesOver = 0;
+        this->framesUnder = 0;
+    }
+
+    if (framesOver >= s_FRAMES_OVER_BUDGET)
+    {
+        // cost goes with the pixel count, scale^2, aim right at the budget
+        this->setScale(scale * std::sqrt(budgetMs / gpuFrameMs));
+    }
+    else if (framesUnder >= s_FRAMES_UNDER_BUDGET)
+    {
+        // creep back up slowly
+        this->setScale(scale + s_STEP_UP);
+    }
+
+    return scale;
+}
+
+
+float DynamicResolution::getScale()
+{
+    return enabled ? scale : 1.0f;
+}
+
+
+void DynamicResolution::setEnabled(bool enabled)
+{
+    if (enabled != this->enabled)
+    {
+        // start again from the full resolution
+        this->scale = 1.0f;
+        this->framesOver = 0;
+        this->framesUnder = 0;
+        this->cooldown = 0;
+    }
+
+    this->enabled = enabled;
+}
+
+
+bool DynamicResolution::getEnabled()
+{
+    return enabled;
+}
+
+
+void DynamicResolution::setBudgetMs(float budgetMs)
+{
+    this->budgetMs = std::max(budgetMs, 0.1f);
+}
+
+
+float DynamicResolution::getBudgetMs()
+{
+    return budgetMs;
+}
+
+
+void DynamicResolution::setScale(float scale)
+{
+    this->scale = std::max(minScale, std::min(scale, 1.0f));
+    this->framesOver = 0;
+    this->framesUnder = 0;
+    this->cooldown = s_COOLDOWN_FRAMES;
+}
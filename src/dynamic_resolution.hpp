@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+// DynamicResolution class, a render scale controller
+//
+// Lowers the render scale of the viewport when the measured GPU frame time
+// goes over budget, and raises it back when there is headroom. The scale is
+// applied per axis, so the pixel count (and roughly the fill cost) goes
+// with scale^2.
+//
+// Decreases react after a few frames over budget, increases need a longer
+// streak under budget (hysteresis), so the scale does not oscillate.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+class DynamicResolution
+{
+public:
+    /// \param budgetMs     GPU frame time budget in ms, defaulted to 8 ms
+    ///
+    /// \param minScale     lowest render scale per axis, defaulted to 0.5
+    ///
+    DynamicResolution(float budgetMs = 8.0f, float minScale = 0.5f);
+
+    /// Feed the latest GPU frame time, call once per rendered frame
+    ///
+    /// \param gpuFrameMs   GPU frame time in ms, NaN is ignored
+    ///
+    /// \return             render scale to use for the next frame
+    ///
+    float update(float gpuFrameMs);
+
+    /// \return     render scale per axis in [minScale, 1],
+    ///             1 while disabled
+    ///
+    float getScale();
+
+    void setEnabled(bool enabled);
+    bool getEnabled();
+
+    void setBudgetMs(float budgetMs);
+    float getBudgetMs();
+
+private:
+    // consecutive samples before changing the scale
+    static constexpr int s_FRAMES_OVER_BUDGET = 3;
+    static constexpr int s_FRAMES_UNDER_BUDGET = 30;
+
+    // samples ignored after a change, GPU results lag a few frames behind
+    static constexpr int s_COOLDOWN_FRAMES = 8;
+
+    // fraction of the budget under which the scale goes up
+    static constexpr float s_HEADROOM = 0.75f;
+    static constexpr float s_STEP_UP = 0.05f;
+
+    bool enabled;
+    float budgetMs;
+    float minScale;
+    float scale;
+
+    int framesOver;
+    int framesUnder;
+    int cooldown;
+
+    void setScale(float scale);
+};
+
+#endif
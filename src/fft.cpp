@@ -129,6 +129,34 @@ void fftComplexToRealDB(float* realBuffer,
 }
 
 
+void fftComplexToPower(float* powerBuffer, 
+                       const float* complexBuffer,
+                       const int powerBufferLen)
+{
+    // |X|^2 / N^2, same reference as fftComplexToRealDB
+    const float fftLenFloat = static_cast<float>(s_fftLen);
+    const float norm = 1.0f / (fftLenFloat * fftLenFloat);
+
+    // DC component
+    powerBuffer[0] = complexBuffer[0] * complexBuffer[0] * norm;
+
+    // Nyquist component
+    if (powerBufferLen >= s_fftLen / 2 + 1)
+    {
+        powerBuffer[s_fftLen / 2] = complexBuffer[1] * complexBuffer[1] * norm;
+    }
+
+    // the rest, no transcendental in the loop so it vectorizes
+    const int len = std::min(powerBufferLen, s_fftLen / 2);
+    for (int i = 1; i < len; ++i)
+    {
+        float real = complexBuffer[2 * i];
+        float imag = complexBuffer[2 * i + 1];
+        powerBuffer[i] = (real * real + imag * imag) * norm;
+    }
+}
+
+
 float fftBinWidth(const float sampleFreq)
 {
     return sampleFreq / s_fftLen;
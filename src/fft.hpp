@@ -95,6 +95,28 @@ void fftComplexToRealDB(float* realBuffer,
                         const float floorDB = -120);
 
 
+/// Converts complex FFT data to power, without any log,
+/// for mapping to Decibel on the GPU (see rect.vs)
+///
+/// Normalized such that 10 * log10(power) gives the same Decibel values
+/// as fftComplexToRealDB()
+/// 
+/// \param powerBuffer      where the one-sided power result resides
+///                         order: [DC bin1 bin2 ...Nyquist]
+///                         (array must have a length of powerBufferLen)
+///
+/// \param complexBuffer    where the input complex array resides
+///                         order: [DC Nyquist real1 imag1 real2 imag2 ...]
+///                         (array must have a length of powerBufferLen)
+///
+/// \param powerBufferLen   the length of the powerBuffer, 
+///                         must be smaller or equal to fftLen/2 + 1
+///
+void fftComplexToPower(float* powerBuffer, 
+                       const float* complexBuffer,
+                       const int powerBufferLen);
+
+
 /// Obtain the frequency binwidth
 ///
 /// \param sampleFreq       sample frequency
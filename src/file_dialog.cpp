@@ -28,3 +28,33 @@ const char* fileDialogGetAudioPath()
                                  nullptr,
                                  0);
 }
+
+
+static const char* s_csvFilterPatterns[1] = {"*.csv"};
+
+const char* fileDialogGetCSVSavePath()
+{
+    return tinyfd_saveFileDialog(nullptr,
+                                 "profile.csv",
+                                 1,
+                                 s_csvFilterPatterns,
+                                 "CSV files");
+}
+
+
+static const char* s_wavFilterPatterns[2] = {"*.wav", "*.WAV"};
+
+const char* fileDialogGetWavSavePath()
+{
+    return tinyfd_saveFileDialog(nullptr,
+                                 "recording.wav",
+                                 2,
+                                 s_wavFilterPatterns,
+                                 "WAV files");
+}
+
+
+const char* fileDialogGetFolderPath()
+{
+    return tinyfd_selectFolderDialog(nullptr, nullptr);
+}
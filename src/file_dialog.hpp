@@ -1,7 +1,21 @@
 //===----------------------------------------------------------------------===//
 //
-// file dialog library for opening audio files
+// file dialog library for opening audio files and saving exports
 // 
 //===----------------------------------------------------------------------===//
 
-const char* fileDialogGetAudioPath();
\ No newline at end of file
+const char* fileDialogGetAudioPath();
+
+/// \return     path picked in a save dialog for a CSV file,
+///             nullptr if cancelled
+///
+const char* fileDialogGetCSVSavePath();
+
+/// \return     path picked in a save dialog for a WAV file,
+///             nullptr if cancelled
+///
+const char* fileDialogGetWavSavePath();
+
+/// \return     folder picked in a dialog, nullptr if cancelled
+///
+const char* fileDialogGetFolderPath();
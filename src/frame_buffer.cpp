@@ -2,41 +2,26 @@
 #include "frame_buffer.hpp"
 
 #include <iostream>
+#include <algorithm>
 
 #include <glad/glad.h>
 
 
 FrameBuffer::FrameBuffer(int width, int height)
+	:	width(std::max(width, 1)),
+		height(std::max(height, 1))
 {
 	glGenFramebuffers(1, &fbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
 	glGenTextures(1, &texture);
+	glGenRenderbuffers(1, &rbo);
+
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexImage2D(
-		GL_TEXTURE_2D, 0, GL_RGB, width, height, 
-		0, GL_RGB, GL_UNSIGNED_BYTE, NULL
-	);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glFramebufferTexture2D(
-		GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0
-	);
-
-	glGenRenderbuffers(1, &rbo);
-	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	glFramebufferRenderbuffer(
-		GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo
-	);
-
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
-
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	this->allocate();
 }
 
 FrameBuffer::~FrameBuffer()
@@ -61,23 +46,54 @@ void FrameBuffer::unbind() const
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-// // no need for SDL2
-// void FrameBuffer::rescaleFrameBuffer(float width, float height)
-// {
-// 	glBindTexture(GL_TEXTURE_2D, texture);
-// 	glTexImage2D(
-// 		GL_TEXTURE_2D, 0, GL_RGB, width, height, 
-// 		0, GL_RGB, GL_UNSIGNED_BYTE, NULL
-// 	);
-// 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-// 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-// 	glFramebufferTexture2D(
-// 		GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0
-// 	);
-
-// 	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-// 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-// 	glFramebufferRenderbuffer(
-// 		GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo
-// 	);
-// }
\ No newline at end of file
+void FrameBuffer::rescale(int width, int height)
+{
+	width = std::max(width, 1);
+	height = std::max(height, 1);
+
+	if (width == this->width && height == this->height)
+	{
+		return;
+	}
+
+	this->width = width;
+	this->height = height;
+	this->allocate();
+}
+
+int FrameBuffer::getWidth()
+{
+	return width;
+}
+
+int FrameBuffer::getHeight()
+{
+	return height;
+}
+
+void FrameBuffer::allocate()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(
+		GL_TEXTURE_2D, 0, GL_RGB, width, height, 
+		0, GL_RGB, GL_UNSIGNED_BYTE, NULL
+	);
+	glFramebufferTexture2D(
+		GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0
+	);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(
+		GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo
+	);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
@@ -19,10 +19,25 @@ public:
     void bind() const;
     void unbind() const;
 
+    /// Reallocate the attachments, does nothing if the size is unchanged
+    ///
+    /// \param width    in device pixels
+    /// \param height   in device pixels
+    ///
+    void rescale(int width, int height);
+
+    int getWidth();
+    int getHeight();
+
 private:
     unsigned int fbo;
     unsigned int texture;
     unsigned int rbo;
+
+    int width;
+    int height;
+
+    void allocate();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,394 @@
+#include "frame_capture.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include "image_writer.hpp"
+
+FrameCapture::FrameCapture(int ringLen, int maxQueuedFrames)
+    :   nextBuffer(0),
+        maxQueuedFrames(std::max(maxQueuedFrames, 1)),
+        format(FRAME_CAPTURE_PNG),
+        fps(60),
+        recording(false),
+        stopping(false),
+        framesWritten(0),
+        framesDropped(0),
+        y4mFile(nullptr),
+        y4mWidth(0),
+        y4mHeight(0)
+{
+    ring.resize(std::max(ringLen, 1));
+
+    for (PackBuffer& buffer : ring)
+    {
+        glGenBuffers(1, &buffer.pbo);
+        buffer.fence = nullptr;
+        buffer.width = 0;
+        buffer.height = 0;
+        buffer.capacity = 0;
+    }
+}
+
+
+FrameCapture::~FrameCapture()
+{
+    this->stop();
+
+    for (PackBuffer& buffer : ring)
+    {
+        if (buffer.fence != nullptr)
+        {
+            glDeleteSync(buffer.fence);
+        }
+        glDeleteBuffers(1, &buffer.pbo);
+    }
+}
+
+
+bool FrameCapture::start(const char* folderPath,
+                         frameCaptureFormat format,
+                         int fps)
+{
+    if (recording)
+    {
+        this->stop();
+    }
+
+    // time stamped output name
+    // ------------------------
+    char timeStamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timeStamp, sizeof(timeStamp), "%Y%m%d_%H%M%S",
+                  std::localtime(&now));
+
+    this->outputPath = std::string(folderPath) + "/spectrolysis_" + timeStamp;
+    this->format = format;
+    this->fps = std::max(fps, 1);
+
+    if (format == FRAME_CAPTURE_Y4M)
+    {
+        this->outputPath += ".y4m";
+
+        // the header is written with the first frame, once the size is known
+        this->y4mFile = fopen(outputPath.c_str(), "wb");
+        if (y4mFile == nullptr)
+        {
+            std::cout << "Frame Capture: failed to open "
+                      << outputPath << std::endl;
+            return false;
+        }
+        this->y4mWidth = 0;
+        this->y4mHeight = 0;
+    }
+
+    this->framesWritten = 0;
+    this->framesDropped = 0;
+    this->stopping = false;
+    this->recording = true;
+
+    this->writer = std::thread(&FrameCapture::writerLoop, this);
+
+    return true;
+}
+
+
+void FrameCapture::stop()
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    // keep the frames still in flight
+    this->collectFrames(true);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        this->stopping = true;
+    }
+    queueCondition.notify_one();
+    writer.join();
+
+    this->recording = false;
+
+    std::cout << "Frame Capture: " << framesWritten << " frames written, "
+              << framesDropped << " dropped, " << outputPath << std::endl;
+}
+
+
+void FrameCapture::captureFrame(int width, int height)
+{
+    if (!recording || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // hand finished readbacks to the writer first, frees ring buffers
+    this->collectFrames(false);
+
+    PackBuffer& buffer = ring[nextBuffer];
+    if (buffer.fence != nullptr)
+    {
+        // the GPU is more than ringLen frames behind, skip this frame
+        ++framesDropped;
+        return;
+    }
+
+    GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    if (buffer.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        buffer.capacity = size;
+    }
+
+    // returns right away, the copy happens on the GPU timeline
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer.width = width;
+    buffer.height = height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    this->nextBuffer = (nextBuffer + 1) % static_cast<int>(ring.size());
+}
+
+
+bool FrameCapture::getIsRecording()
+{
+    return recording;
+}
+
+
+frameCaptureFormat FrameCapture::getFormat()
+{
+    return format;
+}
+
+
+long long FrameCapture::getFramesWritten()
+{
+    return framesWritten;
+}
+
+
+long long FrameCapture::getFramesDropped()
+{
+    return framesDropped;
+}
+
+
+std::string FrameCapture::getOutputPath()
+{
+    return outputPath;
+}
+
+
+void FrameCapture::collectFrames(bool wait)
+{
+    // oldest first, keeps the frames in order
+    int ringLen = static_cast<int>(ring.size());
+
+    for (int k = 0; k < ringLen; ++k)
+    {
+        PackBuffer& buffer = ring[(nextBuffer + k) % ringLen];
+        if (buffer.fence == nullptr)
+        {
+            continue;
+        }
+
+        GLenum status = wait
+            ? glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                               1000000000) // 1 s
+            : glClientWaitSync(buffer.fence, 0, 0);
+
+        if (status == GL_TIMEOUT_EXPIRED && !wait)
+        {
+            // not done yet, neither are the newer ones
+            break;
+        }
+
+        glDeleteSync(buffer.fence);
+        buffer.fence = nullptr;
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            ++framesDropped;
+            continue;
+        }
+
+        GLsizeiptr size = static_cast<GLsizeiptr>(buffer.width) * buffer.height * 4;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+        const unsigned char* rgba = static_cast<const unsigned char*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)
+        );
+
+        if (rgba != nullptr)
+        {
+            // the writer is never waited on, except when flushing
+            this->enqueue(rgba, buffer.width, buffer.height, wait);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        else
+        {
+            ++framesDropped;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
+
+void FrameCapture::enqueue(const unsigned char* rgba,
+                           int width, int height,
+                           bool force)
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    if (!force && static_cast<int>(queue.size()) >= maxQueuedFrames)
+    {
+        // the disk is falling behind
+        ++framesDropped;
+        return;
+    }
+
+    Frame frame;
+    if (!freeBuffers.empty())
+    {
+        frame.rgba = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+    }
+
+    size_t size = static_cast<size_t>(width) * height * 4;
+    frame.rgba.resize(size);
+    memcpy(frame.rgba.data(), rgba, size);
+    frame.width = width;
+    frame.height = height;
+
+    queue.push_back(std::move(frame));
+
+    lock.unlock();
+    queueCondition.notify_one();
+}
+
+
+void FrameCapture::writerLoop()
+{
+    long long index = 0;
+    std::vector<unsigned char> work;
+    std::vector<unsigned char> scaled;
+
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this] {
+                return !queue.empty() || stopping;
+            });
+
+            if (queue.empty())
+            {
+                // stopping and drained
+                break;
+            }
+
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        this->writeFrame(frame, index, work, scaled);
+        ++index;
+
+        // recycle the pixel buffer
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (static_cast<int>(freeBuffers.size()) < maxQueuedFrames)
+        {
+            freeBuffers.push_back(std::move(frame.rgba));
+        }
+    }
+
+    if (y4mFile != nullptr)
+    {
+        fclose(y4mFile);
+        this->y4mFile = nullptr;
+    }
+}
+
+
+void FrameCapture::writeFrame(Frame& frame, long long index,
+                              std::vector<unsigned char>& work,
+                              std::vector<unsigned char>& scaled)
+{
+    bool ok = false;
+
+    if (format == FRAME_CAPTURE_PNG)
+    {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "_%06lld.png", index);
+        std::string filepath = outputPath + suffix;
+
+        ok = imageWriterPNG(filepath.c_str(), frame.rgba.data(),
+                            frame.width, frame.height, true);
+    }
+    else
+    {
+        // the stream size is fixed by the first frame, 4:2:0 needs it even
+        if (y4mWidth == 0)
+        {
+            this->y4mWidth = frame.width & ~1;
+            this->y4mHeight = frame.height & ~1;
+
+            if (y4mWidth == 0 || y4mHeight == 0 ||
+                !imageWriterY4MHeader(y4mFile, y4mWidth, y4mHeight, fps))
+            {
+                this->y4mWidth = 0;
+                ++framesDropped;
+                return;
+            }
+        }
+
+        const unsigned char* rgba = frame.rgba.data();
+
+        if (frame.width != y4mWidth || frame.height != y4mHeight)
+        {
+            // viewport resized or render scale changed, nearest neighbour
+            scaled.resize(static_cast<size_t>(y4mWidth) * y4mHeight * 4);
+            for (int row = 0; row < y4mHeight; ++row)
+            {
+                int srcRow = static_cast<int>(
+                    static_cast<long long>(row) * frame.height / y4mHeight
+                );
+                for (int col = 0; col < y4mWidth; ++col)
+                {
+                    int srcCol = static_cast<int>(
+                        static_cast<long long>(col) * frame.width / y4mWidth
+                    );
+                    memcpy(&scaled[(static_cast<size_t>(row) * y4mWidth + col) * 4],
+                           &rgba[(static_cast<size_t>(srcRow) * frame.width + srcCol) * 4],
+                           4);
+                }
+            }
+            rgba = scaled.data();
+        }
+
+        work.resize(static_cast<size_t>(y4mWidth) * y4mHeight * 3 / 2);
+        ok = imageWriterY4MFrame(y4mFile, rgba, work.data(),
+                                 y4mWidth, y4mHeight, true);
+    }
+
+    if (ok)
+    {
+        ++framesWritten;
+    }
+    else
+    {
+        ++framesDropped;
+    }
+}
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+// FrameCapture class for recording the viewport to disk
+//
+// Frames are read back asynchronously: glReadPixels() into a ring of pixel
+// pack buffers with a fence each, and the buffers are only mapped a few
+// frames later once their fence has signaled, so the render loop never
+// waits on the GPU. Mapped frames are copied into a bounded queue and
+// encoded by a writer thread. When the GPU or the disk falls behind,
+// frames are dropped (and counted) instead of stalling the render loop.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+
+typedef enum {
+    FRAME_CAPTURE_PNG,  /// numbered PNG sequence, uncompressed
+    FRAME_CAPTURE_Y4M   /// single YUV4MPEG2 4:2:0 stream, fixed size
+} frameCaptureFormat;
+
+class FrameCapture
+{
+public:
+    /// \param ringLen          number of pixel pack buffers in flight,
+    ///                         frames are read this many frames late,
+    ///                         defaulted to 3
+    ///
+    /// \param maxQueuedFrames  frames waiting for the writer thread
+    ///                         before new frames are dropped,
+    ///                         defaulted to 8
+    ///
+    FrameCapture(int ringLen = 3, int maxQueuedFrames = 8);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /// Start recording into a folder, file names are time stamped
+    ///
+    /// \param folderPath   existing output folder
+    ///
+    /// \param fps          nominal frame rate written to the Y4M header
+    ///
+    /// \return             whether the output could be opened
+    ///
+    bool start(const char* folderPath,
+               frameCaptureFormat format,
+               int fps = 60);
+
+    /// Stop recording, flushes the frames in flight and waits for the
+    /// writer thread
+    ///
+    void stop();
+
+    /// Queue a readback of the currently bound read framebuffer,
+    /// call after drawing, before unbinding
+    ///
+    /// \param width    width of the region at (0, 0) in pixels
+    ///
+    /// \param height   height of the region at (0, 0) in pixels
+    ///
+    void captureFrame(int width, int height);
+
+    bool getIsRecording();
+    frameCaptureFormat getFormat();
+
+    /// \return     number of frames written since start()
+    ///
+    long long getFramesWritten();
+
+    /// \return     number of frames dropped since start()
+    ///
+    long long getFramesDropped();
+
+    /// \return     path of the Y4M file or the PNG prefix being written
+    ///
+    std::string getOutputPath();
+
+private:
+    struct PackBuffer {
+        GLuint pbo;
+        GLsync fence;       // nullptr if the buffer is free
+        int width;
+        int height;
+        GLsizeiptr capacity;
+    };
+
+    struct Frame {
+        std::vector<unsigned char> rgba;
+        int width;
+        int height;
+    };
+
+    // readback ring, render thread only
+    std::vector<PackBuffer> ring;
+    int nextBuffer;
+
+    // settings
+    int maxQueuedFrames;
+    frameCaptureFormat format;
+    int fps;
+    std::string outputPath;
+    bool recording;
+
+    // writer thread
+    std::thread writer;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Frame> queue;
+    std::vector<std::vector<unsigned char>> freeBuffers; // recycled
+    bool stopping;
+
+    std::atomic<long long> framesWritten;
+    std::atomic<long long> framesDropped;
+
+    // Y4M stream, writer thread only
+    FILE* y4mFile;
+    int y4mWidth;
+    int y4mHeight;
+
+    /// Map the buffers whose fence has signaled and queue their frames
+    ///
+    /// \param wait     block until every buffer in flight is done
+    ///
+    void collectFrames(bool wait);
+
+    /// Push a frame to the writer, dropped if the queue is full
+    ///
+    void enqueue(const unsigned char* rgba, int width, int height, bool force);
+
+    void writerLoop();
+    void writeFrame(Frame& frame, long long index,
+                    std::vector<unsigned char>& work,
+                    std::vector<unsigned char>& scaled);
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "frame_scheduler.hpp"
+
+#include <algorithm>
+
+FrameScheduler::FrameScheduler(SDL_Window* window,
+                               int lingerFrames,
+                               int idleTimeoutMs,
+                               int throttledFps)
+    :   window(window),
+        lingerFrames(lingerFrames),
+        idleTimeoutMs(idleTimeoutMs),
+        throttledFramePeriodMs(1000 / std::max(throttledFps, 1)),
+        enabled(true),
+        animating(false),
+        pendingFrames(lingerFrames), // draw the first frames
+        nextThrottledFrameMs(0)
+{
+
+}
+
+
+void FrameScheduler::waitForFrame()
+{
+    if (!enabled)
+    {
+        // V-Sync does the pacing
+        return;
+    }
+
+    bool minimized = getIsMinimized();
+
+    if (!minimized && pendingFrames > 0)
+    {
+        // something changed, draw right away
+        return;
+    }
+
+    if (!minimized && animating)
+    {
+        if (getIsFocused())
+        {
+            // V-Sync does the pacing
+            return;
+        }
+        else
+        {
+            // throttled, sleep until the next frame unless an event arrives
+            Uint32 now = SDL_GetTicks();
+            if (now < nextThrottledFrameMs)
+            {
+                SDL_WaitEventTimeout(nullptr,
+                                     static_cast<int>(nextThrottledFrameMs - now));
+            }
+            return;
+        }
+    }
+
+    // idle or minimized, block until an event arrives
+    // (passing nullptr leaves the event in the queue for processInput)
+    SDL_WaitEventTimeout(nullptr, idleTimeoutMs);
+}
+
+
+void FrameScheduler::processEvent(const SDL_Event& event)
+{
+    // any input, window or user event can change what is on screen
+    (void)event;
+    this->requestRedraw(lingerFrames);
+}
+
+
+void FrameScheduler::requestRedraw(int frames)
+{
+    this->pendingFrames = std::max(pendingFrames, frames);
+}
+
+
+void FrameScheduler::setAnimating(bool animating)
+{
+    if (this->animating && !animating)
+    {
+        // draw the paused state
+        this->requestRedraw(lingerFrames);
+    }
+
+    this->animating = animating;
+}
+
+
+void FrameScheduler::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+}
+
+
+bool FrameScheduler::shouldRender()
+{
+    if (!enabled)
+    {
+        return true;
+    }
+
+    if (getIsMinimized())
+    {
+        return false;
+    }
+
+    bool render = false;
+
+    if (pendingFrames > 0)
+    {
+        --pendingFrames;
+        render = true;
+    }
+
+    if (animating)
+    {
+        if (getIsFocused())
+        {
+            render = true;
+        }
+        else
+        {
+            Uint32 now = SDL_GetTicks();
+            if (now >= nextThrottledFrameMs)
+            {
+                this->nextThrottledFrameMs = now + throttledFramePeriodMs;
+                render = true;
+            }
+        }
+    }
+
+    return render;
+}
+
+
+bool FrameScheduler::getIsMinimized()
+{
+    Uint32 flags = SDL_GetWindowFlags(window);
+    return (flags & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN)) != 0;
+}
+
+
+bool FrameScheduler::getIsFocused()
+{
+    return (SDL_GetWindowFlags(window) & SDL_WINDOW_INPUT_FOCUS) != 0;
+}
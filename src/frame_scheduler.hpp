@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// FrameScheduler class for event driven frame pacing
+//
+// Frames are only drawn when something can change on screen: SDL events
+// (UI input, camera, window), redraws requested by the application, or
+// while audio is streaming. Otherwise the main loop blocks in
+// SDL_WaitEventTimeout() and uses (almost) no CPU or GPU.
+//
+// While the window is unfocused the animation is throttled, and nothing is
+// drawn while it is minimized or hidden.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FRAME_SCHEDULER_HPP
+#define FRAME_SCHEDULER_HPP
+
+#include <SDL2/SDL.h>
+
+class FrameScheduler
+{
+public:
+    /// \param window           SDL2 window
+    ///
+    /// \param lingerFrames     number of frames drawn after the last event,
+    ///                         lets ImGui settle (hover state, popups, etc.)
+    ///                         defaulted to 3
+    ///
+    /// \param idleTimeoutMs    maximum time blocked while idle, in ms,
+    ///                         defaulted to 500
+    ///
+    /// \param throttledFps     frame rate cap while animating unfocused,
+    ///                         defaulted to 15
+    ///
+    FrameScheduler(SDL_Window* window,
+                   int lingerFrames = 3,
+                   int idleTimeoutMs = 500,
+                   int throttledFps = 15);
+
+    /// Block until there is something to draw, returns right away when
+    /// there are pending events or redraws
+    ///
+    /// Note:   does not remove events from the SDL event queue
+    ///
+    void waitForFrame();
+
+    /// Notify the scheduler of an SDL event, call on every polled event
+    ///
+    void processEvent(const SDL_Event& event);
+
+    /// Draw the next n frames, for state changes outside of SDL events
+    ///
+    void requestRedraw(int frames = 1);
+
+    /// Redraw continuously while true, e.g. while audio is streaming
+    ///
+    void setAnimating(bool animating);
+
+    /// Idling can be turned off to draw every frame at V-Sync rate
+    ///
+    void setEnabled(bool enabled);
+
+    /// \return     whether this loop iteration should render a frame,
+    ///             consumes one requested redraw
+    ///
+    bool shouldRender();
+
+private:
+    SDL_Window* window;
+
+    // settings
+    int lingerFrames;
+    int idleTimeoutMs;
+    Uint32 throttledFramePeriodMs;
+
+    // state
+    bool enabled;
+    bool animating;
+    int pendingFrames;
+    Uint32 nextThrottledFrameMs;
+
+    bool getIsMinimized();
+    bool getIsFocused();
+};
+
+#endif
@@ -1,6 +1,9 @@
 #include "grid.hpp"
 
 #include <vector>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
 
 #include "array2d.hpp"
 
@@ -14,10 +17,14 @@ Grid::Grid(const float* z,
            const GLenum xyUsage,
            const GLenum zUsage)
     :   nRowsV(nRowsV), nColsV(nColsV),
+        baseAttribIdx(baseAttribIdx),
+        zUsage(zUsage),
         uv(uv),
         xR(xR), xL(xL),
         yT(yT), yB(yB),
-        logScale(true) // defaulted to log scale, hardcoded
+        drawOrder(ARRAY2D_ROW_FORWARD),
+        logScale(true), // defaulted to log scale, hardcoded
+        zFormat(GRID_Z_FLOAT32)
 {
     // generate xy grid and element indices
     // ------------------------------------
@@ -44,11 +51,18 @@ Grid::Grid(const float* z,
     // ---------------
     this->elementIndicesLen = (nRowsV - 1) * (nColsV - 1) * 6;
 
-    std::vector<int> elementIndicesArray(elementIndicesLen);
+    // row-major and column-major orderings back to back, the reverse
+    // orderings reuse them (4 copies would be ~80 MB at 200 x 4094)
+    std::vector<int> elementIndicesArray(2 * elementIndicesLen);
 
-    array2dElementIndices(elementIndicesArray.data(), nRowsV - 1, nColsV - 1);
+    array2dElementIndicesOrdered(&elementIndicesArray[0], 
+                                 nRowsV - 1, nColsV - 1,
+                                 ARRAY2D_ROW_FORWARD);
+    array2dElementIndicesOrdered(&elementIndicesArray[elementIndicesLen], 
+                                 nRowsV - 1, nColsV - 1,
+                                 ARRAY2D_COL_FORWARD);
     
-    size_t elementIndicesSize = elementIndicesLen * sizeof(int);
+    size_t elementIndicesSize = elementIndicesArray.size() * sizeof(int);
 
     // create and bind the OpenGL buffer objects
     // -----------------------------------------
@@ -79,8 +93,7 @@ Grid::Grid(const float* z,
     // z-coordinates buffer
     glBindBuffer(GL_ARRAY_BUFFER, zVBO);
     glBufferData(GL_ARRAY_BUFFER, zSize, &z[0], zUsage);
-    glVertexAttribPointer(baseAttribIdx + 1, 1, GL_FLOAT, GL_FALSE, sizeof(float), 
-                          (void*)0);
+    this->zAttribPointer();
     glEnableVertexAttribArray(baseAttribIdx + 1);
     glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind z buffer
 
@@ -105,7 +118,79 @@ Grid::~Grid()
 void Grid::draw()
 {
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, elementIndicesLen, GL_UNSIGNED_INT, 0);
+
+    switch (drawOrder)
+    {
+        case ARRAY2D_ROW_FORWARD:
+            glDrawElements(GL_TRIANGLES, elementIndicesLen, GL_UNSIGNED_INT, 0);
+            break;
+
+        case ARRAY2D_COL_FORWARD:
+            glDrawElements(GL_TRIANGLES, elementIndicesLen, GL_UNSIGNED_INT, 
+                           (void*)(elementIndicesLen * sizeof(int)));
+            break;
+
+        case ARRAY2D_ROW_REVERSE:
+            this->drawReverse(0, nRowsV - 1, nColsV - 1);
+            break;
+
+        case ARRAY2D_COL_REVERSE:
+            this->drawReverse(elementIndicesLen, nColsV - 1, nRowsV - 1);
+            break;
+    }
+}
+
+
+void Grid::sortFrontToBack(float depthX, float depthY)
+{
+    // depth change across the whole grid along each axis,
+    // columns go from xL to xR, rows go from yT to yB
+    float depthAcrossCols = depthX * (xR - xL);
+    float depthAcrossRows = depthY * (yB - yT);
+
+    // the axis along which the depth changes the most is the outer loop,
+    // starting from the nearest line
+    if (std::abs(depthAcrossRows) >= std::abs(depthAcrossCols))
+    {
+        this->drawOrder = (depthAcrossRows >= 0.0f) ? ARRAY2D_ROW_FORWARD 
+                                                    : ARRAY2D_ROW_REVERSE;
+    }
+    else
+    {
+        this->drawOrder = (depthAcrossCols >= 0.0f) ? ARRAY2D_COL_FORWARD
+                                                    : ARRAY2D_COL_REVERSE;
+    }
+}
+
+
+void Grid::setDrawOrder(array2dDrawOrder order)
+{
+    this->drawOrder = order;
+}
+
+
+array2dDrawOrder Grid::getDrawOrder()
+{
+    return this->drawOrder;
+}
+
+
+void Grid::drawReverse(int firstIdx, int nLines, int nQuadsPerLine)
+{
+    // lines in a band are drawn forward, bands from the last to the first
+    int linesPerBand = (nLines + s_MAX_REVERSE_BANDS - 1) / s_MAX_REVERSE_BANDS;
+    int idxPerLine = nQuadsPerLine * 6;
+
+    for (int firstLine = ((nLines - 1) / linesPerBand) * linesPerBand; 
+         firstLine >= 0; 
+         firstLine -= linesPerBand)
+    {
+        int nBandLines = std::min(linesPerBand, nLines - firstLine);
+        size_t offset = (firstIdx + firstLine * idxPerLine) * sizeof(int);
+
+        glDrawElements(GL_TRIANGLES, nBandLines * idxPerLine, GL_UNSIGNED_INT,
+                       (void*)offset);
+    }
 }
 
 
@@ -118,6 +203,76 @@ void Grid::zSubAllData(const float* newZ)
 }
 
 
+void Grid::zSubAllData(const uint16_t* newZ)
+{
+    assert(zFormat != GRID_Z_FLOAT32);
+
+    glBindBuffer(GL_ARRAY_BUFFER, zVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, zSize, &newZ[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind buffer
+}
+
+
+void Grid::setZFormat(gridZFormat format)
+{
+    if (format == zFormat)
+    {
+        return;
+    }
+
+    this->zFormat = format;
+
+    size_t elementSize = (format == GRID_Z_FLOAT32) ? sizeof(float) 
+                                                    : sizeof(uint16_t);
+    this->zSize = nRowsV * nColsV * elementSize;
+
+    // zeros are 0.0 in all three formats
+    std::vector<unsigned char> zeros(zSize, 0);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, zVBO);
+    glBufferData(GL_ARRAY_BUFFER, zSize, zeros.data(), zUsage);
+    this->zAttribPointer();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+
+gridZFormat Grid::getZFormat()
+{
+    return this->zFormat;
+}
+
+
+unsigned int Grid::getZBuffer()
+{
+    return this->zVBO;
+}
+
+
+void Grid::zAttribPointer()
+{
+    // all three formats reach the vertex shader as float aPosZ
+    switch (zFormat)
+    {
+        case GRID_Z_FLOAT32:
+            glVertexAttribPointer(baseAttribIdx + 1, 1, GL_FLOAT, GL_FALSE, 
+                                  sizeof(float), (void*)0);
+            break;
+
+        case GRID_Z_UNORM16:
+            glVertexAttribPointer(baseAttribIdx + 1, 1, GL_UNSIGNED_SHORT, GL_TRUE, 
+                                  sizeof(uint16_t), (void*)0);
+            break;
+
+        case GRID_Z_HALF16:
+            glVertexAttribPointer(baseAttribIdx + 1, 1, GL_HALF_FLOAT, GL_FALSE, 
+                                  sizeof(uint16_t), (void*)0);
+            break;
+    }
+}
+
+
 void Grid::gridSwitchLogScale()
 {
     std::vector<float> gridArray(gridArrayLen);
@@ -13,6 +13,16 @@
 
 #include <glad/glad.h>
 
+#include "array2d.hpp"
+
+/// Storage format of the z buffer
+///
+typedef enum {
+    GRID_Z_FLOAT32,     /// GL_FLOAT
+    GRID_Z_UNORM16,     /// GL_UNSIGNED_SHORT normalized to [0, 1]
+    GRID_Z_HALF16       /// GL_HALF_FLOAT
+} gridZFormat;
+
 class Grid
 {
 public:
@@ -71,11 +81,29 @@ public:
     ~Grid();
 
 
-    /// OpenGL draw
+    /// OpenGL draw, in the current draw order
     ///
     void draw();
 
 
+    /// Pick the draw order that draws the quads front to back,
+    /// so the depth test can reject the hidden fragments early
+    ///
+    /// \param depthX   change of depth per unit x in model space
+    ///
+    /// \param depthY   change of depth per unit y in model space
+    ///
+    void sortFrontToBack(float depthX, float depthY);
+
+
+    /// Set the order in which the quads are drawn,
+    /// defaulted to ARRAY2D_ROW_FORWARD
+    ///
+    void setDrawOrder(array2dDrawOrder order);
+
+    array2dDrawOrder getDrawOrder();
+
+
     /// Substitude ALL the z data without reallocating the buffer
     ///
     /// \param newZ     pointer to an array stroing the z-coordinates 
@@ -85,6 +113,30 @@ public:
     ///
     void zSubAllData(const float* newZ);
 
+    /// zSubAllData for the 16-bit z formats, 
+    /// values from quantizeFloatToUnorm16() or quantizeFloatToHalf()
+    ///
+    /// \param newZ     pointer to an array stroing the quantized z-coordinates 
+    ///                 2-dimensional, stored in row-major format
+    ///                 (array must have a length of nRowsV * nColsV)
+    ///
+    void zSubAllData(const uint16_t* newZ);
+
+
+    /// Reallocate the z buffer in another format, zeroed,
+    /// defaulted to GRID_Z_FLOAT32
+    ///
+    /// The 16-bit formats halve the z buffer and its uploads
+    ///
+    void setZFormat(gridZFormat format);
+
+    gridZFormat getZFormat();
+
+    /// \return     the z buffer object, for writing z on the GPU 
+    ///             (see spectrum_feedback.hpp)
+    ///
+    unsigned int getZBuffer();
+
 
     /// Switch between log scaled grid and evenly spaced grid
     ///
@@ -99,17 +151,32 @@ private:
 
     // storing inputs
     int nRowsV, nColsV;
+    int baseAttribIdx;
+    GLenum zUsage;
     bool uv;
     float xR; float xL;
     float yT; float yB;
 
     int elementIndicesLen;
 
+    // the EBO holds the row-major then the column-major indices,
+    // the reverse orders are drawn as bands of rows (columns) in reverse
+    static constexpr int s_MAX_REVERSE_BANDS = 64;
+    array2dDrawOrder drawOrder;
+
+    /// Draw nLines lines of nQuadsPerLine quads from firstIdx, 
+    /// in bands from the last line to the first
+    void drawReverse(int firstIdx, int nLines, int nQuadsPerLine);
+
     bool logScale;
     int gridArrayLen;
     size_t gridArraySize;
 
+    gridZFormat zFormat;
     size_t zSize;
+
+    /// Point the z attribute at zVBO in the current format, zVBO must be bound
+    void zAttribPointer();
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "gui.hpp"
 
+#include <algorithm>
+
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_opengl3.h"
@@ -8,6 +10,10 @@
 
 #include "gui_components.hpp"
 #include "gui_theme.hpp"
+#include "gui_color.hpp"
+#include "file_dialog.hpp"
+
+extern guiColorPalette g_color;
 
 // This code is for ImGui docking branch
 // for ImGui master branch - ImGui::Image(ImTextureID, ...)
@@ -25,13 +31,32 @@ static void s_guiDockingOptMenu(ImGuiDockNodeFlags& dockspace_flags);
 static void s_guiViewMenu();
 static bool s_showFreqPlot = true;
 static bool s_showSpectrogram = true;
+static bool s_showProfiler = false;
 
-static void s_guiGraphicsMenu();
+static void s_guiGraphicsMenu(DynamicResolution& dynamicResolution);
 static bool s_enableDepthTesting = true;   // default, otherwise change main
 static bool s_enableFaceCulling = true;     // default, otherwise change main
 static bool s_showFrameRate = false;
-
-static void s_guiPlotMenu(Grid& grid);
+static bool s_idleWhenInactive = true;
+static bool s_frontToBackOrdering = true;
+
+static void s_guiPlotMenu(Grid& grid, ColormapTexture& colormap, int nChannels);
+static bool s_powerInput = false;
+static float s_floorDB = -120.0f;
+static float s_rangeDB = 120.0f;
+static gridZFormat s_zFormat = GRID_Z_FLOAT32;
+static bool s_gpuSpectrum = false;
+static float s_gpuSpectrumSmoothing = 0.0f;
+static void s_guiChannelsMenu(int nChannels);
+static channelMixMode s_channelMode = CHANNEL_MIX_DOWNMIX;
+static int s_channelIndex = 0;
+static channelMixLayout s_channelLayout = CHANNEL_MIX_SIDE_BY_SIDE;
+static void s_guiAnalysisRateMenu();
+static int s_analysisRate = 48000;
+static void s_guiColormapMenu(ColormapTexture& colormap);
+
+static void s_guiCaptureMenu(FrameCapture& capture);
+static frameCaptureFormat s_captureFormat = FRAME_CAPTURE_Y4M;
 
 void guiInit(SDL_Window *window, SDL_GLContext gl_context, const char* version)
 {
@@ -77,6 +102,81 @@ void guiCleanUp()
 
 
 
+bool guiGetIdleWhenInactive()
+{
+    return s_idleWhenInactive;
+}
+
+
+bool guiGetPowerInput()
+{
+    return s_powerInput;
+}
+
+
+float guiGetFloorDB()
+{
+    // the CPU dB path is fixed to [-120, 0] dB
+    return s_powerInput ? s_floorDB : -120.0f;
+}
+
+
+float guiGetRangeDB()
+{
+    return s_powerInput ? s_rangeDB : 120.0f;
+}
+
+
+gridZFormat guiGetZFormat()
+{
+    // linear power spans far more than [0, 1], keep it in floats
+    return s_powerInput ? GRID_Z_FLOAT32 : s_zFormat;
+}
+
+
+bool guiGetGPUSpectrum()
+{
+    // writes dB in [0, 1] as floats
+    return s_gpuSpectrum && guiGetZFormat() == GRID_Z_FLOAT32 && !s_powerInput;
+}
+
+
+float guiGetGPUSpectrumSmoothing()
+{
+    return s_gpuSpectrumSmoothing;
+}
+
+
+channelMixMode guiGetChannelMode()
+{
+    return s_channelMode;
+}
+
+
+int guiGetChannelIndex()
+{
+    return s_channelIndex;
+}
+
+
+channelMixLayout guiGetChannelLayout()
+{
+    return s_channelLayout;
+}
+
+
+int guiGetAnalysisRate()
+{
+    return s_analysisRate;
+}
+
+
+bool guiGetFrontToBackOrdering()
+{
+    return s_frontToBackOrdering;
+}
+
+
 void guiNewFrame()
 {
         // start the Dear ImGui frame
@@ -192,18 +292,26 @@ void guiApp(guiInputs& inputs)
     // components
     // ----------
     // using * we want to get to the objects stored by the ptr
-    guiAudioInterface(*inputs.audioPlayerPtr, *inputs.micPtr);
+    guiAudioInterface(*inputs.audioPlayerPtr, *inputs.micsPtr,
+                      *inputs.captureLatencyPtr);
 
     if (s_showSpectrogram)
     { 
-        guiViewport(*inputs.cameraPtr, inputs.viewportTextureID);
+        guiViewport(*inputs.cameraPtr, inputs.viewportTextureID,
+                    inputs.viewportUMax, inputs.viewportVMax);
     }
     
     if (s_showFreqPlot)
     {
         bool logScale = inputs.gridPtr->getLogScale();
         guiFrequencyPlot(inputs.freqPlotX, inputs.freqPlotY,
-                         inputs.freqPlotLen, logScale);
+                         inputs.freqPlotLen, logScale,
+                         s_powerInput, guiGetFloorDB(), guiGetRangeDB());
+    }
+
+    if (s_showProfiler)
+    {
+        guiProfiler(*inputs.profilerPtr, &s_showProfiler);
     }
 
 }
@@ -220,7 +328,7 @@ void s_guiMainMenu(ImGuiDockNodeFlags& dockspace_flags, guiInputs& inputs)
 
             ImGui::Separator();
 
-            s_guiGraphicsMenu();
+            s_guiGraphicsMenu(*inputs.dynamicResolutionPtr);
 
             ImGui::Separator();
 
@@ -231,7 +339,22 @@ void s_guiMainMenu(ImGuiDockNodeFlags& dockspace_flags, guiInputs& inputs)
 
         s_guiViewMenu();
 
-        s_guiPlotMenu(*inputs.gridPtr);
+        // every channel of every microphone
+        int nChannels = guiAudioInterfaceGetPlayerMode() 
+                        ? inputs.audioPlayerPtr->getChannels() 
+                        : inputs.micsPtr->getTotalChannels();
+        s_guiPlotMenu(*inputs.gridPtr, *inputs.colormapPtr, nChannels);
+
+        s_guiCaptureMenu(*inputs.frameCapturePtr);
+
+        // recording indicator
+        // -------------------
+        if (inputs.frameCapturePtr->getIsRecording())
+        {
+            ImGui::PushStyleColor(ImGuiCol_Text, g_color.red);
+            ImGui::Text("REC %lld", inputs.frameCapturePtr->getFramesWritten());
+            ImGui::PopStyleColor();
+        }
 
         // framerate counter
         // ----------------
@@ -272,12 +395,21 @@ void s_guiViewMenu()
             s_showSpectrogram = !s_showSpectrogram;
         }
 
+        if (ImGui::MenuItem(
+            "Profiler",
+            "",
+            s_showProfiler
+        ))
+        {
+            s_showProfiler = !s_showProfiler;
+        }
+
         ImGui::EndMenu();
     }
 }
 
 
-void s_guiGraphicsMenu()
+void s_guiGraphicsMenu(DynamicResolution& dynamicResolution)
 {
     if (ImGui::BeginMenu("Graphics"))
     {
@@ -324,6 +456,16 @@ void s_guiGraphicsMenu()
             }
         }
 
+        if (ImGui::MenuItem(
+            "Front-to-Back Ordering",
+            "",
+            s_frontToBackOrdering
+        ))
+        {
+            // early depth rejection, compare in View > Profiler
+            s_frontToBackOrdering = !s_frontToBackOrdering;
+        }
+
         if (ImGui::MenuItem(
             "Show Framerate",
             "",
@@ -333,13 +475,49 @@ void s_guiGraphicsMenu()
             s_showFrameRate = !s_showFrameRate;
         }
 
+        if (ImGui::MenuItem(
+            "Idle When Inactive",
+            "",
+            s_idleWhenInactive
+        ))
+        {
+            // redraw only on input or while audio is streaming
+            s_idleWhenInactive = !s_idleWhenInactive;
+        }
+
+        ImGui::Separator();
+
+        // lowers the spectrogram render scale when the GPU is over budget
+        bool dynamicResolutionEnabled = dynamicResolution.getEnabled();
+        if (ImGui::MenuItem(
+            "Dynamic Resolution",
+            "",
+            dynamicResolutionEnabled
+        ))
+        {
+            dynamicResolution.setEnabled(!dynamicResolutionEnabled);
+        }
+
+        if (dynamicResolution.getEnabled())
+        {
+            float budgetMs = dynamicResolution.getBudgetMs();
+            if (ImGui::SliderFloat("GPU Budget", &budgetMs, 
+                                   1.0f, 33.3f, "%.1f ms"))
+            {
+                dynamicResolution.setBudgetMs(budgetMs);
+            }
+
+            ImGui::Text("Render Scale: %.0f%%", 
+                        100.0f * dynamicResolution.getScale());
+        }
+
         ImGui::EndMenu();
     }
 }
 
 
 /// TODO: frequency plot log scale
-void s_guiPlotMenu(Grid& grid)
+void s_guiPlotMenu(Grid& grid, ColormapTexture& colormap, int nChannels)
 {
     if (ImGui::BeginMenu("Plot"))
     {
@@ -354,6 +532,265 @@ void s_guiPlotMenu(Grid& grid)
             grid.gridSwitchLogScale();
         }
 
+        ImGui::Separator();
+
+        // dB mapping on the GPU, floor and range apply to the whole history
+        if (ImGui::MenuItem(
+            "dB in Vertex Shader",
+            "",
+            s_powerInput
+        ))
+        {
+            s_powerInput = !s_powerInput;
+        }
+
+        if (s_powerInput)
+        {
+            ImGui::SliderFloat("Floor", &s_floorDB, -200.0f, -20.0f, "%.0f dB");
+            ImGui::SliderFloat("Range", &s_rangeDB, 20.0f, 200.0f, "%.0f dB");
+        }
+
+        // 16-bit history, the dB values in [0, 1] don't need a float
+        if (ImGui::BeginMenu("History Format", !s_powerInput))
+        {
+            const gridZFormat formats[] = {
+                GRID_Z_FLOAT32,
+                GRID_Z_UNORM16,
+                GRID_Z_HALF16
+            };
+            const char* names[] = {
+                "32-bit Float",
+                "16-bit Unorm",
+                "16-bit Half Float"
+            };
+
+            for (int i = 0; i < 3; ++i)
+            {
+                if (ImGui::MenuItem(names[i], "", s_zFormat == formats[i]))
+                {
+                    s_zFormat = formats[i];
+                }
+            }
+
+            ImGui::EndMenu();
+        }
+
+        // transform feedback, needs the float history and the dB path
+        if (ImGui::MenuItem(
+            "GPU Spectrum (Experimental)",
+            "",
+            guiGetGPUSpectrum(),
+            guiGetZFormat() == GRID_Z_FLOAT32 && !s_powerInput
+        ))
+        {
+            s_gpuSpectrum = !s_gpuSpectrum;
+        }
+
+        if (guiGetGPUSpectrum())
+        {
+            ImGui::SliderFloat("Smoothing", &s_gpuSpectrumSmoothing, 0.0f, 0.95f, "%.2f");
+        }
+
+        ImGui::Separator();
+
+        s_guiChannelsMenu(nChannels);
+
+        s_guiAnalysisRateMenu();
+
+        s_guiColormapMenu(colormap);
+
+        ImGui::EndMenu();
+    }
+}
+
+
+void s_guiChannelsMenu(int nChannels)
+{
+    // a mono input has nothing to choose from
+    if (ImGui::BeginMenu("Channels", nChannels > 1))
+    {
+        const channelMixMode modes[] = {
+            CHANNEL_MIX_DOWNMIX,
+            CHANNEL_MIX_SELECT,
+            CHANNEL_MIX_SPLIT,
+            CHANNEL_MIX_MID_SIDE,
+            CHANNEL_MIX_EACH
+        };
+        const char* names[] = {
+            "Downmix",
+            "Single Channel",
+            "Left and Right",
+            "Mid and Side",
+            "Every Channel"
+        };
+
+        for (int i = 0; i < 5; ++i)
+        {
+            if (ImGui::MenuItem(names[i], "", s_channelMode == modes[i]))
+            {
+                s_channelMode = modes[i];
+            }
+        }
+
+        if (s_channelMode == CHANNEL_MIX_SELECT)
+        {
+            s_channelIndex = std::min(s_channelIndex, nChannels - 1);
+            ImGui::SliderInt("Channel", &s_channelIndex, 0, nChannels - 1);
+        }
+
+        // a spectrogram per output, up to one per channel
+        if (channelMixGetNumOutputs(s_channelMode, nChannels) > 1)
+        {
+            ImGui::Separator();
+
+            if (ImGui::MenuItem("Stacked", "", 
+                                s_channelLayout == CHANNEL_MIX_STACKED))
+            {
+                s_channelLayout = CHANNEL_MIX_STACKED;
+            }
+            if (ImGui::MenuItem("Side by Side", "", 
+                                s_channelLayout == CHANNEL_MIX_SIDE_BY_SIDE))
+            {
+                s_channelLayout = CHANNEL_MIX_SIDE_BY_SIDE;
+            }
+            if (ImGui::MenuItem("Tiled", "", 
+                                s_channelLayout == CHANNEL_MIX_TILED))
+            {
+                s_channelLayout = CHANNEL_MIX_TILED;
+            }
+        }
+
+        ImGui::EndMenu();
+    }
+}
+
+
+void s_guiAnalysisRateMenu()
+{
+    // a fixed rate gives every file the same frequency axis and bin width
+    if (ImGui::BeginMenu("Analysis Rate"))
+    {
+        const int rates[] = {0, 44100, 48000, 96000};
+        const char* names[] = {
+            "Source Rate",
+            "44100 Hz",
+            "48000 Hz",
+            "96000 Hz"
+        };
+
+        for (int i = 0; i < 4; ++i)
+        {
+            if (ImGui::MenuItem(names[i], "", s_analysisRate == rates[i]))
+            {
+                s_analysisRate = rates[i];
+            }
+        }
+
+        ImGui::EndMenu();
+    }
+}
+
+
+void s_guiColormapMenu(ColormapTexture& colormap)
+{
+    if (ImGui::BeginMenu("Colormap"))
+    {
+        colormapType type = colormap.getType();
+        glm::vec3 rgb0 = colormap.getColor0();
+        glm::vec3 rgb1 = colormap.getColor1();
+
+        const colormapType types[] = {
+            COLORMAP_OKLAB,
+            COLORMAP_VIRIDIS,
+            COLORMAP_MAGMA,
+            COLORMAP_INFERNO
+        };
+
+        for (colormapType t : types)
+        {
+            if (ImGui::MenuItem(colormapGetName(t), "", type == t))
+            {
+                type = t;
+            }
+        }
+
+        // endpoints of the OKLAB ramp
+        if (type == COLORMAP_OKLAB)
+        {
+            ImGui::Separator();
+            ImGui::ColorEdit3("High", &rgb0[0], ImGuiColorEditFlags_NoInputs);
+            ImGui::ColorEdit3("Low", &rgb1[0], ImGuiColorEditFlags_NoInputs);
+        }
+
+        // LUT is only rebuilt when something actually changed
+        colormap.setColormap(type, rgb0, rgb1);
+
+        // colorbar preview, straight from the LUT texture
+        ImGui::Separator();
+        ImGui::Image(
+            colormap.getTextureID(),
+            ImVec2(ImGui::CalcTextSize("Colormap Preview").x, 
+                   ImGui::GetTextLineHeight())
+        );
+
+        ImGui::EndMenu();
+    }
+}
+
+
+void s_guiCaptureMenu(FrameCapture& capture)
+{
+    if (ImGui::BeginMenu("Capture"))
+    {
+        bool recording = capture.getIsRecording();
+
+        // the format can't change while recording
+        if (ImGui::MenuItem(
+            "Y4M Video",
+            "",
+            s_captureFormat == FRAME_CAPTURE_Y4M,
+            !recording
+        ))
+        {
+            s_captureFormat = FRAME_CAPTURE_Y4M;
+        }
+
+        if (ImGui::MenuItem(
+            "PNG Sequence",
+            "",
+            s_captureFormat == FRAME_CAPTURE_PNG,
+            !recording
+        ))
+        {
+            s_captureFormat = FRAME_CAPTURE_PNG;
+        }
+
+        ImGui::Separator();
+
+        if (!recording)
+        {
+            if (ImGui::MenuItem("Start Recording..."))
+            {
+                const char* folderPath = fileDialogGetFolderPath();
+
+                if (folderPath != nullptr)
+                {
+                    capture.start(folderPath, s_captureFormat);
+                }
+            }
+        }
+        else
+        {
+            if (ImGui::MenuItem("Stop Recording"))
+            {
+                capture.stop();
+            }
+
+            ImGui::Text("%lld frames written, %lld dropped",
+                        capture.getFramesWritten(),
+                        capture.getFramesDropped());
+        }
+
         ImGui::EndMenu();
     }
 }
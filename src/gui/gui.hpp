@@ -12,18 +12,31 @@
 
 #include "camera.hpp"
 #include "audio_player.hpp"
-#include "microphone.hpp"
+#include "microphone_group.hpp"
 #include "grid.hpp"
+#include "colormap_texture.hpp"
+#include "profiler.hpp"
+#include "dynamic_resolution.hpp"
+#include "frame_capture.hpp"
+#include "latency_meter.hpp"
+#include "channel_mix.hpp"
 
 typedef struct {
     int freqPlotLen;
     float* freqPlotX;
     float* freqPlotY;
     GLuint viewportTextureID;
+    float viewportUMax;         // fraction of the texture rendered to
+    float viewportVMax;
     Camera* cameraPtr;         // Use pointers
     AudioPlayer* audioPlayerPtr;
-    Microphone* micPtr;
+    MicrophoneGroup* micsPtr;
     Grid* gridPtr;
+    ColormapTexture* colormapPtr;
+    Profiler* profilerPtr;
+    DynamicResolution* dynamicResolutionPtr;
+    FrameCapture* frameCapturePtr;
+    LatencyMeter* captureLatencyPtr;
 } guiInputs;
 
 /// \param version GLSL version
@@ -39,15 +52,72 @@ void guiRender();
 
 void guiCleanUp();
 
+/// Whether the main loop should idle when nothing changes on screen,
+/// set in the Graphics menu
+bool guiGetIdleWhenInactive();
+
+/// Whether the spectrogram takes linear power and maps it to dB in the
+/// vertex shader, set in the Plot menu
+bool guiGetPowerInput();
+
+/// Bottom of the dB mapping in the power input mode, in dB
+float guiGetFloorDB();
+
+/// Dynamic range of the dB mapping in the power input mode, in dB
+float guiGetRangeDB();
+
+/// Storage format of the spectrogram history, set in the Plot menu,
+/// always GRID_Z_FLOAT32 in the power input mode
+gridZFormat guiGetZFormat();
+
+/// Whether the spectrogram rows are computed on the GPU with transform
+/// feedback (see spectrum_feedback.hpp), set in the Plot menu
+bool guiGetGPUSpectrum();
+
+/// Weight of the previous row in the GPU spectrum, in [0, 0.95]
+float guiGetGPUSpectrumSmoothing();
+
+/// Signals analysed from a multichannel file, set in the Plot menu
+channelMixMode guiGetChannelMode();
+
+/// Channel analysed in CHANNEL_MIX_SELECT, 
+/// may exceed the channels of the file loaded since
+int guiGetChannelIndex();
+
+/// Placement of the two spectrograms of CHANNEL_MIX_SPLIT and
+/// CHANNEL_MIX_MID_SIDE, set in the Plot menu
+channelMixLayout guiGetChannelLayout();
+
+/// Sample rate the audio is resampled to before the FFT, in Hz,
+/// 0 to analyse at the rate of the source, set in the Plot menu
+int guiGetAnalysisRate();
+
+/// Whether the grid is drawn front to back from the camera direction,
+/// set in the Graphics menu
+bool guiGetFrontToBackOrdering();
+
 
 // forward declaration from gui_components.hpp
 // -------------------------------------------
 /// Whether the cursor is on top of the viewport
 bool guiViewportGetHovered();
 
+/// Size of the viewport image in device pixels, 0 before the first frame
+int guiViewportGetWidth();
+int guiViewportGetHeight();
+
 /// Switching between microphone and audioplayer
 bool guiAudioInterfaceGetPlayerMode();
 
+/// Decoded audio cache settings, from the audio interface menu
+bool guiAudioInterfaceGetCacheEnabled();
+uint64_t guiAudioInterfaceGetCacheLimitBytes();
+
+/// Low latency capture and the microphone block size, from the audio
+/// interface menu
+bool guiAudioInterfaceGetLowLatency();
+int guiAudioInterfaceGetMicBlockFrames();
+
 
 
 
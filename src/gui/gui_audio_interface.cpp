@@ -4,6 +4,7 @@
 #include <cstring>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
 #include "imgui.h"
 
@@ -24,11 +25,15 @@ static const char* s_getFileNameFromPath(const char* filePath);
 
 // audio playback slider
 void s_formatTimestamp(char *buffer, size_t size, 
-                     float currentTime, float totalTime);
+                     double currentTime, double totalTime);
 static bool s_audioPlayerSliderRecentlyClicked = false;
 static std::chrono::time_point<std::chrono::high_resolution_clock> s_audioPlayerLastSlideTime;
 static int s_timeout = 100;
 
+// loop region, A to B in seconds
+static double s_audioPlayerLoopStart = 0.0;
+static double s_audioPlayerLoopEnd = 0.0;
+
 
 
 // microphone
@@ -36,17 +41,34 @@ static int s_timeout = 100;
 // for dropdown device menu
 static const char* s_micSelectedDevice = nullptr; 
 static std::vector<std::string> s_micDevices;
+static std::vector<std::string> s_micAddDevices; // listed apart, the
+                                                 // selected one points in
+                                                 // s_micDevices
+
+// saving to disk, 0 for no limit
+static int s_micSaveSplitMin = 60;
+static int s_micSaveSplitMB = 0;
+
+// callback block, 2^s_micLowLatencyExp frames in low latency capture
+static constexpr int s_MIC_BLOCK_FRAMES = 2048;
+static bool s_micLowLatency = false;
+static int s_micLowLatencyExp = 7;
 
 
 // audio interface
 // ---------------
 static void s_guiAudioPlayer(AudioPlayer& audioPlayer);
-static void s_guiMicrophone(Microphone& mic);
+static void s_guiMicrophone(MicrophoneGroup& mics, LatencyMeter& captureLatency);
 static bool s_audioInterfacePlayerMode = false; /// default mic
 static bool s_audioInterfacePauseWhenSwitch = true;
 
+// decoded audio cache
+static bool s_audioCacheEnabled = true;
+static int s_audioCacheLimitMB = 4096;
+
 
-void guiAudioInterface(AudioPlayer& audioPlayer, Microphone& mic)
+void guiAudioInterface(AudioPlayer& audioPlayer, MicrophoneGroup& mics,
+                       LatencyMeter& captureLatency)
 {
     ImGui::PushStyleColor(ImGuiCol_WindowBg, g_color.base);
 
@@ -65,7 +87,7 @@ void guiAudioInterface(AudioPlayer& audioPlayer, Microphone& mic)
                 else
                 {
                     // switching from mic to player, pause mic
-                    mic.pause();
+                    mics.pause();
                 }
             }
 
@@ -83,7 +105,7 @@ void guiAudioInterface(AudioPlayer& audioPlayer, Microphone& mic)
         }
         else
         {
-            s_guiMicrophone(mic);
+            s_guiMicrophone(mics, captureLatency);
         }
     }
     ImGui::End();
@@ -109,6 +131,30 @@ bool guiAudioInterfaceGetPlayerMode()
 }
 
 
+bool guiAudioInterfaceGetCacheEnabled()
+{
+    return s_audioCacheEnabled;
+}
+
+
+uint64_t guiAudioInterfaceGetCacheLimitBytes()
+{
+    return static_cast<uint64_t>(s_audioCacheLimitMB) << 20;
+}
+
+
+bool guiAudioInterfaceGetLowLatency()
+{
+    return s_micLowLatency;
+}
+
+
+int guiAudioInterfaceGetMicBlockFrames()
+{
+    return s_micLowLatency ? (1 << s_micLowLatencyExp) : s_MIC_BLOCK_FRAMES;
+}
+
+
 void guiAudioInterfaceMenu()
 {
     if (ImGui::BeginMenu("Audio Interface"))
@@ -122,6 +168,36 @@ void guiAudioInterfaceMenu()
             s_audioInterfacePauseWhenSwitch = !s_audioInterfacePauseWhenSwitch;
         }
 
+        ImGui::Separator();
+
+        // MP3 and FLAC decoded once, mapped on later loads
+        if (ImGui::MenuItem("Cache Decoded Audio", "", s_audioCacheEnabled))
+        {
+            s_audioCacheEnabled = !s_audioCacheEnabled;
+        }
+        ImGui::SliderInt("Cache Limit (MB)", &s_audioCacheLimitMB, 256, 65536, 
+                         "%d", ImGuiSliderFlags_Logarithmic);
+
+        ImGui::Separator();
+
+        // microphone files, applied on the next save
+        ImGui::SliderInt("Split Saved Files (min)", &s_micSaveSplitMin, 0, 240,
+                         s_micSaveSplitMin == 0 ? "never" : "%d");
+        ImGui::SliderInt("Split Saved Files (MB)", &s_micSaveSplitMB, 0, 4096,
+                         s_micSaveSplitMB == 0 ? "never" : "%d");
+
+        ImGui::Separator();
+
+        // smaller blocks arrive sooner, at more callbacks per second
+        if (ImGui::MenuItem("Low Latency Capture", "", s_micLowLatency))
+        {
+            s_micLowLatency = !s_micLowLatency;
+        }
+
+        char blockLabel[16];
+        snprintf(blockLabel, sizeof(blockLabel), "%d", 1 << s_micLowLatencyExp);
+        ImGui::SliderInt("Block (frames)", &s_micLowLatencyExp, 6, 8, blockLabel);
+
         ImGui::EndMenu();
     }
 }
@@ -193,7 +269,7 @@ void s_guiAudioPlayer(AudioPlayer& audioPlayer)
     ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
     if (ImGui::Button(filePickerLabel))
     {
-        audioPlayer.pause();
+        // keeps playing the current file while the new one loads
         const char* newAudioFilePath = fileDialogGetAudioPath();
 
         // make sure opening the file dialog and cancelling it won't
@@ -213,7 +289,6 @@ void s_guiAudioPlayer(AudioPlayer& audioPlayer)
             s_audioFilePath = strdup(newAudioFilePath);
             // free(newAudioFilePath); free by tinyfiledialog
 
-            audioPlayer.skipBackward();
             audioPlayer.loadFile(s_audioFilePath);
         }
         else
@@ -225,19 +300,74 @@ void s_guiAudioPlayer(AudioPlayer& audioPlayer)
     }
     ImGui::PopStyleColor();
 
+    // loading progress
+    // ----------------
+    if (audioPlayer.getIsLoading())
+    {
+        ImGui::ProgressBar(audioPlayer.getLoadProgress(), 
+                           ImVec2(deviceMenuWidth, 0.0f), "Loading...");
+
+        ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
+        if (ImGui::Button("Cancel"))
+        {
+            audioPlayer.cancelLoad();
+        }
+        ImGui::PopStyleColor();
+    }
+    else if (audioPlayer.getLoadThroughputMBs() > 0.0)
+    {
+        // to compare codecs and storage
+        if (audioPlayer.getIsCached())
+        {
+            ImGui::Text("Load %.1f MB/s, from cache", 
+                        audioPlayer.getLoadThroughputMBs());
+        }
+        else
+        {
+            ImGui::Text("Load %.1f MB/s, decode %.1f MB/s", 
+                        audioPlayer.getLoadThroughputMBs(),
+                        audioPlayer.getDecodeThroughputMBs());
+        }
+    }
+
+    // negotiated device format
+    // ------------------------
+    if (audioPlayer.getDeviceFreq() > 0)
+    {
+        ImGui::Text("Device %d Hz, %d ch, %d frames%s",
+                    audioPlayer.getDeviceFreq(),
+                    audioPlayer.getDeviceChannels(),
+                    audioPlayer.getDeviceBufferFrames(),
+                    audioPlayer.getIsDeviceNative() ? "" : " (SDL may convert)");
+
+        if (audioPlayer.getIsConverting())
+        {
+            ImGui::Text("Converted from %d Hz, %d ch",
+                        audioPlayer.getFreq(),
+                        audioPlayer.getChannels());
+        }
+        else
+        {
+            ImGui::Text("Played as is");
+        }
+    }
+
     // playback slider
     // ---------------
     ImGui::Spacing(); 
     ImGui::Spacing();
 
-    float currentTime = audioPlayer.getCurrentTimeSec();
-    float totalTime = audioPlayer.getTotalTimeSec();
+    // double, float seconds lose sub-frame precision within hours
+    double currentTime = audioPlayer.getCurrentTimeSec();
+    double totalTime = audioPlayer.getTotalTimeSec();
+    const double minTime = 0.0;
 
     char timestamp[30];
     s_formatTimestamp(timestamp, sizeof(timestamp), currentTime, totalTime);
     
 
-    if (ImGui::SliderFloat(timestamp, &currentTime, 0.0f, totalTime, ""))
+    if (ImGui::SliderScalar(timestamp, ImGuiDataType_Double, 
+                            &currentTime, &minTime, &totalTime, ""))
     {
         if (!s_audioPlayerSliderRecentlyClicked)
         {
@@ -275,12 +405,49 @@ void s_guiAudioPlayer(AudioPlayer& audioPlayer)
     {
         audioPlayer.skipBackward();
     }
+
+    // loop region
+    // -----------
+    bool isLoopChanged = false;
+
+    if (ImGui::Button("Set A"))
+    {
+        s_audioPlayerLoopStart = audioPlayer.getCurrentTimeSec();
+        isLoopChanged = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Set B"))
+    {
+        s_audioPlayerLoopEnd = audioPlayer.getCurrentTimeSec();
+        isLoopChanged = true;
+    }
     ImGui::PopStyleColor();
+
+    ImGui::SameLine();
+    bool isLooping = audioPlayer.getIsLooping();
+    if (ImGui::Checkbox("Loop", &isLooping) || (isLoopChanged && isLooping))
+    {
+        if (isLooping)
+        {
+            // either order, nothing to loop if they are the same
+            audioPlayer.setLoopRegion(std::min(s_audioPlayerLoopStart, s_audioPlayerLoopEnd),
+                                      std::max(s_audioPlayerLoopStart, s_audioPlayerLoopEnd));
+        }
+        else
+        {
+            audioPlayer.clearLoopRegion();
+        }
+    }
+
+    ImGui::Text("A %.3f s, B %.3f s", s_audioPlayerLoopStart, s_audioPlayerLoopEnd);
 }
 
 
-void s_guiMicrophone(Microphone& mic)
+void s_guiMicrophone(MicrophoneGroup& mics, LatencyMeter& captureLatency)
 {
+    // the device saved to disk and the history are the first one's
+    Microphone& mic = mics.getMicrophone(0);
+
     // drop down menu
     if (ImGui::BeginCombo(" ", s_micSelectedDevice ? s_micSelectedDevice : "System Default"))
     {
@@ -311,19 +478,123 @@ void s_guiMicrophone(Microphone& mic)
 
         ImGui::EndCombo();
     }
+    ImGui::SameLine();
+    ImGui::Text("%d ch", mic.getChannels());
+
+    // devices recorded along with the first, their channels come after
+    // ----------------------------------------------------------------
+    for (int i = 1; i < mics.getNumDevices(); ++i)
+    {
+        Microphone& other = mics.getMicrophone(i);
+        std::string name = other.getDeviceName();
+
+        ImGui::PushID(i);
+        ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
+        bool isRemoved = ImGui::Button("Remove");
+        ImGui::PopStyleColor();
+        ImGui::SameLine();
+        ImGui::Text("%s, %d ch", name.empty() ? "System Default" : name.c_str(),
+                    other.getChannels());
+        ImGui::PopID();
+
+        if (isRemoved)
+        {
+            mics.removeDevice(i);
+            break;
+        }
+    }
+
+    if (ImGui::BeginCombo("##addDevice", "Add Device"))
+    {
+        if (ImGui::Selectable("System Default"))
+        {
+            mics.addDevice(nullptr);
+        }
+
+        s_micAddDevices = mic.getAvailableDevices();
+        for (size_t i = 0; i < s_micAddDevices.size(); ++i)
+        {
+            if (ImGui::Selectable(s_micAddDevices[i].c_str()))
+            {
+                mics.addDevice(s_micAddDevices[i].c_str());
+            }
+        }
+
+        ImGui::EndCombo();
+    }
 
     ImGui::Spacing(); 
     ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
     if (ImGui::Button("Record"))
     {
-        mic.record();
+        mics.record();
     }
     ImGui::SameLine();
     if (ImGui::Button("Stop"))
     {
-        mic.pause();
+        mics.pause();
+    }
+    ImGui::SameLine();
+    if (!mic.getIsSaving())
+    {
+        if (ImGui::Button("Save to Disk..."))
+        {
+            const char* folderPath = fileDialogGetFolderPath();
+
+            if (folderPath != nullptr)
+            {
+                mic.startSaving(folderPath, s_micSaveSplitMin * 60, s_micSaveSplitMB);
+            }
+        }
+    }
+    else
+    {
+        if (ImGui::Button("Stop Saving"))
+        {
+            mic.stopSaving();
+        }
     }
     ImGui::PopStyleColor();
+
+    // what was recorded before saving to disk was started
+    ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
+    if (ImGui::Button("Save History..."))
+    {
+        const char* filePath = fileDialogGetWavSavePath();
+
+        if (filePath != nullptr)
+        {
+            mic.saveHistory(filePath);
+        }
+    }
+    ImGui::PopStyleColor();
+    ImGui::SameLine();
+    ImGui::Text("%.0f s kept, %.1f MB", mic.getHistorySec(),
+                static_cast<double>(mic.getBufferedBytes()) / (1 << 20));
+
+    if (mic.getIsSaving())
+    {
+        std::string savingPath = mic.getSavingPath();
+        double savedSec = static_cast<double>(mic.getSavedFrames()) / mic.getFreq();
+
+        ImGui::Text("Saving: %s", s_getFileNameFromPath(savingPath.c_str()));
+        ImGui::Text("%.1f s saved, %llu frames dropped", savedSec,
+                    static_cast<unsigned long long>(mic.getDroppedFrames()));
+    }
+
+    // from a block arriving to the frame showing it, the block itself was
+    // being recorded for up to its length before
+    if (!mics.getIsPaused() && mic.getFreq() > 0)
+    {
+        double blockMs = 1000.0 * mics.getCallbackFrames() / mic.getFreq();
+
+        ImGui::Text("Latency %.1f / %.1f / %.1f ms (p50 / p95 / p99)",
+                    captureLatency.getPercentile(50.0),
+                    captureLatency.getPercentile(95.0),
+                    captureLatency.getPercentile(99.0));
+        ImGui::Text("+ up to %.1f ms block of %d frames", blockMs,
+                    mics.getCallbackFrames());
+    }
 }
 
 
@@ -340,7 +611,7 @@ const char* s_getFileNameFromPath(const char* filePath)
 
 
 void s_formatTimestamp(char *buffer, size_t size, 
-                     float currentTime, float totalTime) 
+                     double currentTime, double totalTime) 
 {
     // Calculate hours, minutes, and seconds for current time
     int currentHours = (int)(currentTime) / 3600;
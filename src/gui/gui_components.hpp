@@ -5,16 +5,32 @@
 
 #include "camera.hpp"
 #include "audio_player.hpp"
-#include "microphone.hpp"
+#include "microphone_group.hpp"
+#include "profiler.hpp"
+#include "latency_meter.hpp"
 
 /// Creating a widget or displaying an OpenGL viewport framebuffer texture
-void guiViewport(Camera& camera, GLuint textureID);
+///
+/// \param uMax     fraction of the texture width rendered to
+/// \param vMax     fraction of the texture height rendered to
+///
+void guiViewport(Camera& camera, GLuint textureID, 
+                 float uMax = 1.0f, float vMax = 1.0f);
 
 /// Whether the cursor is on top of the viewport
 bool guiViewportGetHovered();
 
+/// Size of the viewport image in device pixels, 0 before the first frame
+int guiViewportGetWidth();
+int guiViewportGetHeight();
+
 /// Creating a widget for moth Microphone and Audioplayer
-void guiAudioInterface(AudioPlayer& audioPlayer, Microphone& mic);
+///
+/// \param captureLatency   microphone block arrival to display, shown
+///                         in the microphone panel
+///
+void guiAudioInterface(AudioPlayer& audioPlayer, MicrophoneGroup& mics,
+                       LatencyMeter& captureLatency);
 void guiAudioInterfaceCleanUp();
 
 /// Switching between microphone and audioplayer
@@ -23,8 +39,35 @@ bool guiAudioInterfaceGetPlayerMode();
 /// Menu for audio interface settings
 void guiAudioInterfaceMenu();
 
+/// Decoded audio cache settings, from the audio interface menu
+bool guiAudioInterfaceGetCacheEnabled();
+uint64_t guiAudioInterfaceGetCacheLimitBytes();
+
+/// Low latency capture, from the audio interface menu: small microphone
+/// blocks, and analysis waiting for the next one
+bool guiAudioInterfaceGetLowLatency();
+
+/// \return     microphone frames per callback for the current mode
+int guiAudioInterfaceGetMicBlockFrames();
+
 /// Creat a amplitude v. frequency plot
-void guiFrequencyPlot(float* x, float* y, int len, bool logScale = true);
+///
+/// \param powerInput   y is linear power, plotted on a log axis,
+///                     otherwise dB scaled to [0, 1]
+///
+/// \param floorDB      bottom of the y axis in dB
+///
+/// \param rangeDB      dynamic range of the y axis in dB
+///
+void guiFrequencyPlot(float* x, float* y, int len, bool logScale = true,
+                      bool powerInput = false,
+                      float floorDB = -120.0f, float rangeDB = 120.0f);
+
+/// Per stage frame timing table, history plot and CSV export
+///
+/// \param open     closes the window when the close button is clicked
+///
+void guiProfiler(Profiler& profiler, bool* open = nullptr);
 
 
 #endif
\ No newline at end of file
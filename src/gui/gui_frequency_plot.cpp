@@ -1,5 +1,8 @@
 #include "gui_components.hpp"
 
+#include <cmath>
+#include <cstdio>
+
 #include "imgui.h"
 #include "implot.h"
 #include "gui_color.hpp"
@@ -7,35 +10,54 @@
 extern guiColorPalette g_color;
 
 
-/// TODO:   change tick label based on floor dB
-void guiFrequencyPlot(float* x, float* y, int len, bool logScale)
+void guiFrequencyPlot(float* x, float* y, int len, bool logScale,
+                      bool powerInput, float floorDB, float rangeDB)
 {
     ImGui::Begin("Frequency");
     {
         if (ImPlot::BeginPlot("Frequency Plot"))
         {
             ImPlot::SetupAxes("Frequency (Hz)", "");
-            
+
             if (logScale)
             {
                 ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
             }
 
             ImPlot::SetupAxisLimits(ImAxis_X1, 5.0, 22000.0);
-            ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0);
-
             ImPlot::SetupAxisZoomConstraints(ImAxis_X1, 5.0, 22000.0);
-            ImPlot::SetupAxisZoomConstraints(ImAxis_Y1, 0.0, 1.0);
-
-            const char* const xTickLabels[] = {
-                "-120dB",
-                "-90dB",
-                "-60dB",
-                "-30dB",
-                "0dB"
-            };
-            
-            ImPlot::SetupAxisTicks(ImAxis_Y1, 0.0, 1.0, 5, xTickLabels);
+
+            // y ticks every quarter of the dynamic range
+            // ------------------------------------------
+            constexpr int nTicks = 5;
+            char tickLabelBuffer[nTicks][16];
+            const char* tickLabels[nTicks];
+            double tickValues[nTicks];
+
+            for (int i = 0; i < nTicks; ++i)
+            {
+                float dB = floorDB + rangeDB * i / (nTicks - 1);
+                snprintf(tickLabelBuffer[i], sizeof(tickLabelBuffer[i]),
+                         "%.0fdB", dB);
+                tickLabels[i] = tickLabelBuffer[i];
+
+                // power on a log axis, or dB already scaled to [0, 1]
+                tickValues[i] = powerInput ? std::pow(10.0, dB / 10.0)
+                                           : static_cast<double>(i) / (nTicks - 1);
+            }
+
+            double yMin = tickValues[0];
+            double yMax = tickValues[nTicks - 1];
+
+            if (powerInput)
+            {
+                ImPlot::SetupAxisScale(ImAxis_Y1, ImPlotScale_Log10);
+            }
+
+            // floor and range can change at any time
+            ImPlot::SetupAxisLimits(ImAxis_Y1, yMin, yMax, ImPlotCond_Always);
+            ImPlot::SetupAxisZoomConstraints(ImAxis_Y1, yMin, yMax);
+            ImPlot::SetupAxisTicks(ImAxis_Y1, tickValues, nTicks, tickLabels);
 
             ImPlot::SetNextLineStyle(g_color.teal);
 
@@ -44,4 +66,4 @@ void guiFrequencyPlot(float* x, float* y, int len, bool logScale)
         }
     }
     ImGui::End();
-}
\ No newline at end of file
+}
@@ -0,0 +1,134 @@
+#include "gui_components.hpp"
+
+#include <cmath>
+
+#include "imgui.h"
+#include "implot.h"
+
+#include "file_dialog.hpp"
+#include "gui_color.hpp"
+
+extern guiColorPalette g_color;
+
+static void s_guiProfilerStatsCell(float ms);
+
+
+void guiProfiler(Profiler& profiler, bool* open)
+{
+    ImGui::Begin("Profiler", open);
+    {
+        bool gpuAvailable = profiler.getGpuTimerAvailable();
+
+        if (!gpuAvailable)
+        {
+            ImGui::TextDisabled("GPU timer queries unavailable, CPU time only");
+        }
+
+        // per stage statistics
+        // --------------------
+        ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders |
+                                     ImGuiTableFlags_RowBg;
+
+        if (ImGui::BeginTable("Stages", 7, tableFlags))
+        {
+            ImGui::TableSetupColumn("Stage (ms)");
+            ImGui::TableSetupColumn("CPU min");
+            ImGui::TableSetupColumn("CPU mean");
+            ImGui::TableSetupColumn("CPU p99");
+            ImGui::TableSetupColumn("GPU min");
+            ImGui::TableSetupColumn("GPU mean");
+            ImGui::TableSetupColumn("GPU p99");
+            ImGui::TableHeadersRow();
+
+            for (int i = 0; i < PROFILER_NUM_STAGES; ++i)
+            {
+                profilerStage stage = static_cast<profilerStage>(i);
+                profilerStats cpu = profiler.getStats(stage, false);
+                profilerStats gpu = profiler.getStats(stage, true);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(Profiler::getStageName(stage));
+
+                s_guiProfilerStatsCell(cpu.minMs);
+                s_guiProfilerStatsCell(cpu.meanMs);
+                s_guiProfilerStatsCell(cpu.p99Ms);
+                s_guiProfilerStatsCell(gpu.minMs);
+                s_guiProfilerStatsCell(gpu.meanMs);
+                s_guiProfilerStatsCell(gpu.p99Ms);
+            }
+
+            ImGui::EndTable();
+        }
+
+        // history plot
+        // ------------
+        // GPU time when available, the CPU time of a GPU stage is only
+        // the time taken to submit the commands
+        static bool s_plotGpu = true;
+        if (gpuAvailable)
+        {
+            ImGui::Checkbox("Plot GPU Time", &s_plotGpu);
+        }
+        bool plotGpu = gpuAvailable && s_plotGpu;
+
+        if (ImPlot::BeginPlot("Frame Time", ImVec2(-1, 250)))
+        {
+            ImPlot::SetupAxes("Frame", "ms",
+                              ImPlotAxisFlags_None,
+                              ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, profiler.getHistoryLen(),
+                                    ImPlotCond_Always);
+            ImPlot::SetupLegend(ImPlotLocation_NorthWest);
+
+            for (int i = 0; i < PROFILER_NUM_STAGES; ++i)
+            {
+                profilerStage stage = static_cast<profilerStage>(i);
+                if (plotGpu && !Profiler::getStageHasGpuWork(stage))
+                {
+                    continue;
+                }
+
+                // the history is a ring buffer, offset starts at the oldest
+                ImPlot::PlotLine(Profiler::getStageName(stage),
+                                 profiler.getHistory(stage, plotGpu),
+                                 profiler.getHistoryLen(),
+                                 1.0, 0.0,
+                                 ImPlotLineFlags_SkipNaN,
+                                 profiler.getHistoryOffset());
+            }
+
+            ImPlot::EndPlot();
+        }
+
+        // export
+        // ------
+        ImGui::PushStyleColor(ImGuiCol_Text, g_color.base);
+        if (ImGui::Button("Export CSV"))
+        {
+            const char* filepath = fileDialogGetCSVSavePath();
+
+            if (filepath != nullptr)
+            {
+                profiler.exportCSV(filepath);
+            }
+        }
+        ImGui::PopStyleColor();
+    }
+    ImGui::End();
+}
+
+
+void s_guiProfilerStatsCell(float ms)
+{
+    ImGui::TableNextColumn();
+
+    if (std::isnan(ms))
+    {
+        ImGui::TextDisabled("-");
+    }
+    else
+    {
+        ImGui::Text("%.3f", ms);
+    }
+}
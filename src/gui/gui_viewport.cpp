@@ -9,8 +9,12 @@ extern guiColorPalette g_color;
 // --------
 static bool s_viewportHovered = false;
 
+// size of the image in device pixels, 0 until the first frame
+static int s_viewportWidth = 0;
+static int s_viewportHeight = 0;
 
-void guiViewport(Camera& camera, GLuint textureID)
+
+void guiViewport(Camera& camera, GLuint textureID, float uMax, float vMax)
 {
     // std::cout << "viewport initiated" << std::endl;
     ImGui::Begin("Spectrogram");
@@ -36,6 +40,14 @@ void guiViewport(Camera& camera, GLuint textureID)
 
         ImGui::BeginChild("Viewport");
 
+        // the framebuffer follows this size in device pixels (HiDPI)
+        ImVec2 size = ImGui::GetContentRegionAvail();
+        ImVec2 framebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+        s_viewportWidth = static_cast<int>(size.x * framebufferScale.x + 0.5f);
+        s_viewportHeight = static_cast<int>(size.y * framebufferScale.y + 0.5f);
+
+        // only the lower left (uMax, vMax) of the texture is rendered to
+        // when the render scale is below 1, flipped vertically
         ImGui::Image(
             textureID, // for ImGui master branch, type casting is required
 
@@ -43,9 +55,9 @@ void guiViewport(Camera& camera, GLuint textureID)
             // // for the ImGui master branch
             // reinterpret_cast<void*>(static_cast<intptr_t>(textureID)),
 
-            ImGui::GetContentRegionAvail(), 
-            ImVec2(0, 1), 
-            ImVec2(1, 0)
+            size, 
+            ImVec2(0, vMax), 
+            ImVec2(uMax, 0)
         );
 
         s_viewportHovered = ImGui::IsWindowHovered();
@@ -62,3 +74,15 @@ bool guiViewportGetHovered()
 {
     return s_viewportHovered;
 }
+
+
+int guiViewportGetWidth()
+{
+    return s_viewportWidth;
+}
+
+
+int guiViewportGetHeight()
+{
+    return s_viewportHeight;
+}
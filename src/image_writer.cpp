@@ -0,0 +1,280 @@
+#include "image_writer.hpp"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iostream>
+
+// max payload of a stored deflate block
+static constexpr size_t s_STORED_BLOCK_LEN = 65535;
+
+static void s_writeU32BE(unsigned char* dst, uint32_t value);
+
+static std::array<uint32_t, 256> s_makeCRC32Table();
+
+/// Write a PNG chunk, the CRC covers the type and the data
+static bool s_writeChunk(FILE* file, const char* type,
+                         const unsigned char* data, uint32_t len);
+
+
+bool imageWriterPNG(const char* filepath,
+                    const unsigned char* rgba,
+                    int width, int height,
+                    bool flipVertical)
+{
+    FILE* file = fopen(filepath, "wb");
+    if (file == nullptr)
+    {
+        std::cout << "Image Writer: failed to open " << filepath << std::endl;
+        return false;
+    }
+
+    // signature and header
+    // --------------------
+    static const unsigned char signature[8] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'
+    };
+
+    unsigned char ihdr[13];
+    s_writeU32BE(&ihdr[0], static_cast<uint32_t>(width));
+    s_writeU32BE(&ihdr[4], static_cast<uint32_t>(height));
+    ihdr[8] = 8;    // bit depth
+    ihdr[9] = 2;    // color type RGB
+    ihdr[10] = 0;   // deflate
+    ihdr[11] = 0;   // adaptive filtering
+    ihdr[12] = 0;   // no interlace
+
+    bool ok = fwrite(signature, 1, 8, file) == 8 &&
+              s_writeChunk(file, "IHDR", ihdr, 13);
+
+    // raw scanlines, filter type 0 (none) in front of every row
+    // ---------------------------------------------------------
+    size_t rowLen = 1 + 3 * static_cast<size_t>(width);
+    size_t rawLen = rowLen * height;
+    std::vector<unsigned char> raw(rawLen);
+
+    for (int row = 0; row < height; ++row)
+    {
+        int srcRow = flipVertical ? (height - 1 - row) : row;
+        const unsigned char* src = &rgba[static_cast<size_t>(srcRow) * width * 4];
+        unsigned char* dst = &raw[row * rowLen];
+
+        dst[0] = 0;
+        for (int col = 0; col < width; ++col)
+        {
+            dst[1 + 3 * col]     = src[4 * col];
+            dst[1 + 3 * col + 1] = src[4 * col + 1];
+            dst[1 + 3 * col + 2] = src[4 * col + 2];
+        }
+    }
+
+    // zlib stream of stored blocks
+    // ----------------------------
+    size_t nBlocks = std::max<size_t>(1, (rawLen + s_STORED_BLOCK_LEN - 1)
+                                         / s_STORED_BLOCK_LEN);
+    size_t zlibLen = 2 + rawLen + 5 * nBlocks + 4;
+    std::vector<unsigned char> zlib(zlibLen);
+
+    size_t pos = 0;
+    zlib[pos++] = 0x78; // deflate, 32K window
+    zlib[pos++] = 0x01; // no compression, (0x7801 % 31 == 0)
+
+    for (size_t block = 0; block < nBlocks; ++block)
+    {
+        size_t offset = block * s_STORED_BLOCK_LEN;
+        size_t len = std::min(s_STORED_BLOCK_LEN, rawLen - offset);
+        bool final = (block == nBlocks - 1);
+
+        zlib[pos++] = final ? 0x01 : 0x00;  // BFINAL, BTYPE = 00
+        zlib[pos++] = static_cast<unsigned char>(len & 0xFF);
+        zlib[pos++] = static_cast<unsigned char>(len >> 8);
+        zlib[pos++] = static_cast<unsigned char>(~len & 0xFF);
+        zlib[pos++] = static_cast<unsigned char>((~len >> 8) & 0xFF);
+
+        std::copy(raw.begin() + offset, raw.begin() + offset + len,
+                  zlib.begin() + pos);
+        pos += len;
+    }
+
+    s_writeU32BE(&zlib[pos], imageWriterAdler32(1, raw.data(), rawLen));
+
+    ok = ok &&
+         s_writeChunk(file, "IDAT", zlib.data(), static_cast<uint32_t>(zlibLen)) &&
+         s_writeChunk(file, "IEND", nullptr, 0);
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        std::cout << "Image Writer: failed to write " << filepath << std::endl;
+    }
+
+    return ok;
+}
+
+
+bool imageWriterY4MHeader(FILE* file, int width, int height, int fps)
+{
+    return fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+                   width, height, fps) > 0;
+}
+
+
+bool imageWriterY4MFrame(FILE* file,
+                         const unsigned char* rgba,
+                         unsigned char* work,
+                         int width, int height,
+                         bool flipVertical)
+{
+    size_t len = static_cast<size_t>(width) * height * 3 / 2;
+
+    imageWriterRGBAToYUV420(work, rgba, width, height, flipVertical);
+
+    return fputs("FRAME\n", file) >= 0 &&
+           fwrite(work, 1, len, file) == len;
+}
+
+
+void imageWriterRGBAToYUV420(unsigned char* yuv,
+                             const unsigned char* rgba,
+                             int width, int height,
+                             bool flipVertical)
+{
+    unsigned char* yPlane = yuv;
+    unsigned char* uPlane = yuv + static_cast<size_t>(width) * height;
+    unsigned char* vPlane = uPlane + static_cast<size_t>(width / 2) * (height / 2);
+
+    // full range BT.601 (JFIF) in 16.16 fixed point
+    for (int row = 0; row < height; row += 2)
+    {
+        int srcRow0 = flipVertical ? (height - 1 - row) : row;
+        int srcRow1 = flipVertical ? (height - 2 - row) : (row + 1);
+        const unsigned char* src0 = &rgba[static_cast<size_t>(srcRow0) * width * 4];
+        const unsigned char* src1 = &rgba[static_cast<size_t>(srcRow1) * width * 4];
+        unsigned char* y0 = &yPlane[static_cast<size_t>(row) * width];
+        unsigned char* y1 = y0 + width;
+
+        for (int col = 0; col < width; col += 2)
+        {
+            // luma of the 2x2 block, average color for chroma
+            int rSum = 0, gSum = 0, bSum = 0;
+            const unsigned char* px[4] = {
+                &src0[4 * col], &src0[4 * (col + 1)],
+                &src1[4 * col], &src1[4 * (col + 1)]
+            };
+            unsigned char* dst[4] = {
+                &y0[col], &y0[col + 1], &y1[col], &y1[col + 1]
+            };
+
+            for (int i = 0; i < 4; ++i)
+            {
+                int r = px[i][0], g = px[i][1], b = px[i][2];
+                *dst[i] = static_cast<unsigned char>(
+                    (19595 * r + 38470 * g + 7471 * b + 32768) >> 16
+                );
+                rSum += r;
+                gSum += g;
+                bSum += b;
+            }
+
+            // average of 4 is folded into the shift (>> 18)
+            int u = (-11059 * rSum - 21709 * gSum + 32768 * bSum
+                     + (128 << 18) + (1 << 17)) >> 18;
+            int v = (32768 * rSum - 27439 * gSum - 5329 * bSum
+                     + (128 << 18) + (1 << 17)) >> 18;
+
+            size_t chromaIdx = static_cast<size_t>(row / 2) * (width / 2) + col / 2;
+            uPlane[chromaIdx] = static_cast<unsigned char>(std::max(0, std::min(u, 255)));
+            vPlane[chromaIdx] = static_cast<unsigned char>(std::max(0, std::min(v, 255)));
+        }
+    }
+}
+
+
+uint32_t imageWriterCRC32(uint32_t crc, const unsigned char* data, size_t len)
+{
+    // generated on first use (thread-safe static initialization)
+    static const std::array<uint32_t, 256> table = s_makeCRC32Table();
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+
+uint32_t imageWriterAdler32(uint32_t adler, const unsigned char* data, size_t len)
+{
+    // largest n such that 255n(n+1)/2 + (n+1)(65520) fits in 32 bits
+    constexpr size_t nMax = 5552;
+    constexpr uint32_t base = 65521;
+
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+
+    while (len > 0)
+    {
+        size_t n = std::min(len, nMax);
+        len -= n;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+        data += n;
+
+        a %= base;
+        b %= base;
+    }
+
+    return (b << 16) | a;
+}
+
+
+std::array<uint32_t, 256> s_makeCRC32Table()
+{
+    std::array<uint32_t, 256> table;
+    for (uint32_t n = 0; n < 256; ++n)
+    {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+
+void s_writeU32BE(unsigned char* dst, uint32_t value)
+{
+    dst[0] = static_cast<unsigned char>(value >> 24);
+    dst[1] = static_cast<unsigned char>(value >> 16);
+    dst[2] = static_cast<unsigned char>(value >> 8);
+    dst[3] = static_cast<unsigned char>(value);
+}
+
+
+bool s_writeChunk(FILE* file, const char* type,
+                  const unsigned char* data, uint32_t len)
+{
+    unsigned char lenBE[4];
+    s_writeU32BE(lenBE, len);
+
+    uint32_t crc = imageWriterCRC32(0, reinterpret_cast<const unsigned char*>(type), 4);
+    if (len > 0)
+    {
+        crc = imageWriterCRC32(crc, data, len);
+    }
+
+    unsigned char crcBE[4];
+    s_writeU32BE(crcBE, crc);
+
+    return fwrite(lenBE, 1, 4, file) == 4 &&
+           fwrite(type, 1, 4, file) == 4 &&
+           (len == 0 || fwrite(data, 1, len, file) == len) &&
+           fwrite(crcBE, 1, 4, file) == 4;
+}
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+// Image writer library for frame capture
+//
+// PNG files are written with stored (uncompressed) deflate blocks, so no
+// compression library is needed and encoding costs about as much as a
+// memcpy and a CRC. Y4M frames are converted to 4:2:0 full range BT.601
+// (C420jpeg).
+//
+// Input images are 8-bit RGBA as read back from OpenGL, rows bottom to top
+// when flipVertical is set.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef IMAGE_WRITER_HPP
+#define IMAGE_WRITER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+/// Write an 8-bit RGB PNG file, the alpha channel is dropped
+///
+/// \param filepath     output file
+///
+/// \param rgba         input pixels, len = width * height * 4
+///
+/// \param flipVertical write the rows in reverse order (OpenGL origin)
+///
+/// \return             whether the file was written
+///
+bool imageWriterPNG(const char* filepath,
+                    const unsigned char* rgba,
+                    int width, int height,
+                    bool flipVertical = true);
+
+/// Write the YUV4MPEG2 stream header
+///
+/// \param file     output file opened in binary mode
+///
+/// \param width    must be even
+///
+/// \param height   must be even
+///
+/// \param fps      nominal frame rate of the stream
+///
+/// \return         whether the header was written
+///
+bool imageWriterY4MHeader(FILE* file, int width, int height, int fps);
+
+/// Write one YUV4MPEG2 frame (4:2:0, full range BT.601)
+///
+/// \param file     output file, after imageWriterY4MHeader()
+///
+/// \param rgba     input pixels, len = width * height * 4
+///
+/// \param work     work buffer, len = width * height * 3 / 2
+///
+/// \return         whether the frame was written
+///
+bool imageWriterY4MFrame(FILE* file,
+                         const unsigned char* rgba,
+                         unsigned char* work,
+                         int width, int height,
+                         bool flipVertical = true);
+
+/// Convert RGBA to planar 4:2:0 full range BT.601, width and height even
+///
+/// \param yuv      output planes Y, U then V, len = width * height * 3 / 2
+///
+void imageWriterRGBAToYUV420(unsigned char* yuv,
+                             const unsigned char* rgba,
+                             int width, int height,
+                             bool flipVertical = true);
+
+/// CRC-32 as used by PNG (and zlib), init with 0
+///
+uint32_t imageWriterCRC32(uint32_t crc, const unsigned char* data, size_t len);
+
+/// Adler-32 as used by zlib, init with 1
+///
+uint32_t imageWriterAdler32(uint32_t adler, const unsigned char* data, size_t len);
+
+#endif
@@ -0,0 +1,58 @@
+#include "latency_meter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double s_NAN = std::numeric_limits<double>::quiet_NaN();
+
+
+LatencyMeter::LatencyMeter(int historyLen)
+    :   history(std::max(historyLen, 1), 0.0),
+        next(0),
+        numSamples(0)
+{
+
+}
+
+
+void LatencyMeter::add(double ms)
+{
+    this->history[next] = ms;
+    this->next = (next + 1) % static_cast<int>(history.size());
+    this->numSamples = std::min(numSamples + 1, static_cast<int>(history.size()));
+}
+
+
+void LatencyMeter::clear()
+{
+    this->next = 0;
+    this->numSamples = 0;
+}
+
+
+int LatencyMeter::getNumSamples()
+{
+    return numSamples;
+}
+
+
+double LatencyMeter::getPercentile(double percentile)
+{
+    if (numSamples == 0)
+    {
+        return s_NAN;
+    }
+
+    // the first numSamples slots are the kept ones, in any order
+    sorted.assign(history.begin(), history.begin() + numSamples);
+
+    // nearest-rank percentile
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    int rank = static_cast<int>(std::ceil(percentile / 100.0 * numSamples)) - 1;
+    rank = std::max(rank, 0);
+
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+
+    return sorted[rank];
+}
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+// LatencyMeter class for rolling latency percentiles
+//
+// Keeps the latest measurements in milliseconds, e.g. from a microphone
+// block arriving to the frame showing it being presented, and reports
+// nearest-rank percentiles over them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LATENCY_METER_HPP
+#define LATENCY_METER_HPP
+
+#include <vector>
+
+class LatencyMeter
+{
+public:
+    /// \param historyLen   number of measurements kept, defaulted to 512
+    ///
+    LatencyMeter(int historyLen = 512);
+
+    /// Add a measurement, the oldest is dropped once the history is full
+    ///
+    void add(double ms);
+
+    /// Drop every measurement, e.g. when the capture settings change
+    ///
+    void clear();
+
+    /// \return     number of measurements kept
+    ///
+    int getNumSamples();
+
+    /// \param percentile   in [0, 100]
+    ///
+    /// \return             nearest-rank percentile in milliseconds,
+    ///                     NaN if there is no measurement
+    ///
+    double getPercentile(double percentile);
+
+private:
+    std::vector<double> history;    // circular
+    int next;
+    int numSamples;
+
+    std::vector<double> sorted;
+};
+
+#endif
@@ -1,7 +1,10 @@
 #include <iostream>
 #include <cstring>
 #include <array>
+#include <string>
 #include <vector>
+#include <memory>
+#include <algorithm>
 
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
@@ -11,21 +14,33 @@
 #include "shader.hpp"
 #include "array2d.hpp"
 #include "grid.hpp"
+#include "colormap_texture.hpp"
 #include "camera.hpp"
 #include "frame_buffer.hpp"
+#include "frame_scheduler.hpp"
+#include "profiler.hpp"
+#include "dynamic_resolution.hpp"
+#include "frame_capture.hpp"
+#include "latency_meter.hpp"
 #include "gui/gui.hpp"
 #include "gui/gui_color.hpp" // global, used in gui_theme.hpp
 #include "audio_player.hpp"
-#include "microphone.hpp"
+#include "microphone_group.hpp"
 #include "fft.hpp"
-#include "smoothing.hpp"
+#include "channel_mix.hpp"
+#include "spectrogram_lane.hpp"
+#include "resampler.hpp"
 
 
-/// \param window   SDL2 window
+/// \param window       SDL2 window
 ///
-/// \return         done using the window
+/// \param scheduler    notified of every event, for frame pacing
 ///
-bool processInput(SDL_Window* window, Camera& camera);
+/// \return             done using the window
+///
+bool processInput(SDL_Window* window, 
+                  Camera& camera, 
+                  FrameScheduler& scheduler);
 
 
 /// For debuging OpenGL error, will display OpenGL error message on concole
@@ -37,6 +52,54 @@ bool processInput(SDL_Window* window, Camera& camera);
 void checkRenderErrors(const char* errorLocation = "");
 
 
+/// Create lanes until there are nLanes, needs the OpenGL context
+///
+/// \param nRowsV       see SpectrogramLane
+///
+/// \param cacheDir     program binary cache directory, empty for none
+///
+void reserveLanes(std::vector<std::unique_ptr<SpectrogramLane>>& lanes,
+                  std::vector<SpectrogramLane*>& lanePtrs,
+                  const int nLanes,
+                  const int nRowsV,
+                  const int nColsV,
+                  const std::string& cacheDir);
+
+
+/// \return     number of lanes the channel mode of the Plot menu draws
+///             for an input, at most g_MAX_LANES
+///
+int getNumLanes(const int channels);
+
+
+/// Fill the signal buffers of the lanes from interleaved frames, 
+/// in the channel mode of the Plot menu (see channel_mix.hpp)
+///
+/// \param lanes        lanes to fill, at least getNumLanes(channels)
+///
+/// \param frames       interleaved input
+///                     (array must have a length of nFrames * channels)
+///
+/// \param nFrames      number of frames, at most the FFT length
+///
+/// \param channels     number of channels in frames
+///
+/// \return             number of lanes filled
+///
+int splitChannels(SpectrogramLane* const* lanes,
+                  const float* frames,
+                  const int nFrames,
+                  const int channels);
+
+
+/// \return     xy scale and offset of the surface of a lane (see rect.vs),
+///             the lanes split the area of a single grid
+///
+glm::vec4 surfaceTransform(const int lane, 
+                           const int nLanes, 
+                           const channelMixLayout layout);
+
+
 // settings
 const int g_SCR_WIDTH = 1920;
 const int g_SCR_HEIGHT = 1080;
@@ -47,6 +110,10 @@ guiColorPalette g_color; // used in gui_theme.cpp
 constexpr int g_FFT_LEN = 8192; //std::pow(2, 13); // must be multiple of 2 and >32
 constexpr int g_AUDIO_BUFFER_LEN = 2048; //std::pow(2,11);
 
+// spectrograms analysed at once, one per channel up to this many,
+// created as the channels show up
+constexpr int g_MAX_LANES = 8;
+
 
 
 
@@ -116,62 +183,86 @@ int main()
 
     // build and compile our shader program
     // ------------------------------------
-    Shader rectShader("../src/shader_programs/rect.vs",
-                      "../src/shader_programs/rect.fs");
+    // program binaries are cached in the user's pref directory,
+    // (e.g. ~/.local/share/Spectrolysis/Spectrolysis/ on Linux)
+    char* prefPath = SDL_GetPrefPath("Spectrolysis", "Spectrolysis");
 
-    // z-coordinates vector
-    // --------------------
+    Shader rectShader("../src/shader_programs/rect.vs",
+                      "../src/shader_programs/rect.fs",
+                      prefPath);
+
+    // uniforms updated every frame
+    const GLint rotationMatLoc = rectShader.getUniformLocation("rotationMat");
+    const GLint powerInputLoc = rectShader.getUniformLocation("powerInput");
+    const GLint floorDBLoc = rectShader.getUniformLocation("floorDB");
+    const GLint rangeDBLoc = rectShader.getUniformLocation("rangeDB");
+    const GLint surfaceTransformLoc = rectShader.getUniformLocation("surfaceTransform");
+
+    // colormap lookup table, sampled by rect.fs
+    // -----------------------------------------
+    ColormapTexture colormap;
+    rectShader.use();
+    rectShader.setInt("colormapLUT", 0);
+    rectShader.setFloat("colormapLUTLen", 
+                        static_cast<float>(colormap.getLutLen()));
+
+    // spectrograms
+    // ------------
     int nRowsV = 200;
     // omit DC and the freq before Nyquist, for convolution smoothing
     // TODO: chnage this on runtime to filter out high frequency
     int nColsV = (g_FFT_LEN / 2) - 2;
-    std::vector<float> z(nRowsV * nColsV, 0);
-
-    // generate grid object
-    // --------------------
-    Grid xy(z.data(), 
-            nRowsV, nColsV, 
-            0, 
-            false, 
-            0.8f, -0.8f, 
-            0.8f, -0.8f);
+
+    // one lane per analysed signal, each with its own history and grid,
+    // more are created when an input has more channels
+    std::string shaderCacheDir = (prefPath != nullptr) ? prefPath : "";
+
+    std::vector<std::unique_ptr<SpectrogramLane>> lanes;
+    std::vector<SpectrogramLane*> lanePtrs;
+    reserveLanes(lanes, lanePtrs, 2, nRowsV, nColsV, shaderCacheDir);
+
+    // decoded MP3 and FLAC next to the shader binaries
+    std::string audioCacheDir = (prefPath != nullptr) 
+                                ? std::string(prefPath) + "audio_cache/" : "";
+
+    SDL_free(prefPath);
     
     // creating viewport
     // -----------------
     Camera camera;
+    // resized to the Spectrogram dock once the GUI has been drawn
     FrameBuffer sceneBuffer(g_SCR_WIDTH, g_SCR_HEIGHT);
 
     // Audio Interface
     // ----------------
     AudioPlayer audioPlayer;
-    Microphone mic;
+    audioPlayer.setCacheDirectory(audioCacheDir.c_str());
+    MicrophoneGroup mics;
+
+    // microphone block arrival to the frame showing it being presented,
+    // shown in the microphone panel
+    LatencyMeter captureLatency;
+    uint64_t analyzedBlockTicks = 0;
 
     // if it is paused in its repective audio interface mode
     bool audioInterfaceIsPaused; 
     bool audioInterfacePlayerMode;
 
-    // FFT and smoothing
-    // -----------------
+    // FFT
+    // ---
     fftInit(g_FFT_LEN);
-    // buffers has to be aligned memory
-    alignas(64) float complexBuffer[g_FFT_LEN];
-    alignas(64) float signalBuffer[g_FFT_LEN];
-    alignas(64) float workBuffer[g_FFT_LEN];
-    std::array<float, g_FFT_LEN / 2> magnitudeBuffer{};
     std::array<float, g_FFT_LEN / 2> freqArray{};
 
-    // blurring
-    constexpr int nConvRows = 10; // 10 seems good for freqPlot
-    float colKernel[nConvRows];
-    smoothingHalfGaussian(&colKernel[0], nConvRows);
+    // interleaved frames of the audio interface, resampled to the 
+    // analysis rate and split into the lanes
+    std::vector<float> frameBuffer;
+    std::vector<float> resampledBuffer;
+    Resampler analysisResampler;
 
-    // work buffer for blurring rows
-    alignas(64) float previousRows[(nConvRows - 1) * g_FFT_LEN/2];
-    alignas(64) float workRow[g_FFT_LEN/2];
-    alignas(64) float workFFTRow[g_FFT_LEN/2];
-    alignas(64) float workConvRow[g_FFT_LEN/2];
-
-    memset(&previousRows[0], 0, ((nConvRows - 1) * g_FFT_LEN/2) * sizeof(float));
+    // lanes drawn, and the channel mode and rate they were filled in
+    int nActiveLanes = 1;
+    channelMixMode channelMode = guiGetChannelMode();
+    int analysisRate = 0;
 
     // Open GL settings
     //-----------------
@@ -187,43 +278,132 @@ int main()
     glCullFace(GL_BACK);
     glFrontFace(GL_CCW);
 
+    // frame pacing, idles when nothing changes
+    // ----------------------------------------
+    FrameScheduler scheduler(window);
+
+    // per stage CPU and GPU timing, shown in View > Profiler
+    // ------------------------------------------------------
+    Profiler profiler((void* (*)(const char*))SDL_GL_GetProcAddress);
+
+    // lowers the viewport render scale when the GPU is over budget,
+    // toggled in Option > Graphics
+    DynamicResolution dynamicResolution;
+
+    // viewport recording, started in the Capture menu
+    // -----------------------------------------------
+    FrameCapture frameCapture;
+
     // render loop
     // -----------
     bool done = false;
     while (!done)
     {
+        // frame pacing
+        // ------------
+        // redraw continuously only while audio is streaming,
+        // otherwise block until there is an event
+        bool audioStreaming = guiAudioInterfaceGetPlayerMode() 
+                              ? !audioPlayer.getIsPaused() 
+                              : !mics.getIsPaused();
+
+        scheduler.setEnabled(guiGetIdleWhenInactive());
+        // keep drawing while recording, so the video has a steady rate,
+        // and while loading for the progress bar
+        scheduler.setAnimating(audioStreaming 
+                               || frameCapture.getIsRecording()
+                               || audioPlayer.getIsLoading());
+        scheduler.waitForFrame();
+
         // input
         // -----
         // done = processInput(window);
-        done = processInput(window, camera);
-
-        // render viewport to frame buffer texture
-        // ---------------------------------------
-        sceneBuffer.bind();
+        done = processInput(window, camera, scheduler);
 
-        // background for viewport only
-        glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // draw 
-        rectShader.use();
-        rectShader.setMat4("rotationMat", camera.getPVMMat());
+        if (!scheduler.shouldRender())
+        {
+            // nothing changed, skip drawing
+            continue;
+        }
 
+        profiler.beginFrame();
 
         // audioInterface
         // --------------
+        // the DSP and the upload are done before binding the scene
+        // framebuffer, so each stage can be timed on its own
+        profiler.beginStage(PROFILER_DSP);
+
         audioInterfacePlayerMode = guiAudioInterfaceGetPlayerMode();
 
-        if (audioInterfacePlayerMode)
+        // a lane for each signal the input is split into
+        reserveLanes(lanes, lanePtrs, 
+                     getNumLanes(audioInterfacePlayerMode 
+                                 ? audioPlayer.getChannels()
+                                 : mics.getTotalChannels()),
+                     nRowsV, nColsV, shaderCacheDir);
+
+        // the same settings in every lane, each clears its history
+        // when the meaning of it changes
+        for (SpectrogramLane* lane : lanePtrs)
         {
-            if (!audioPlayer.getIsPaused())
+            lane->setZFormat(guiGetZFormat());
+            lane->setPowerInput(guiGetPowerInput());
+            lane->setGPUSpectrum(guiGetGPUSpectrum());
+            lane->setGPUSpectrumSmoothing(guiGetGPUSpectrumSmoothing());
+
+            // the Plot menu only switches the first grid
+            Grid& grid = lane->getGrid();
+            if (grid.getLogScale() != lanes[0]->getGrid().getLogScale())
             {
-                audioPlayer.getAudioData(&signalBuffer[0], 
-                                         g_AUDIO_BUFFER_LEN);
+                grid.gridSwitchLogScale();
+            }
+        }
+
+        // a file finished loading in the background
+        audioPlayer.setCacheEnabled(guiAudioInterfaceGetCacheEnabled());
+        audioPlayer.setCacheMaxBytes(guiAudioInterfaceGetCacheLimitBytes());
+        audioPlayer.pollLoad();
+
+        // smaller callback blocks in low latency capture, the device is
+        // reopened and the latency measured so far is of the old blocks
+        if (mics.getBlockFrames() != guiAudioInterfaceGetMicBlockFrames())
+        {
+            mics.setBlockFrames(guiAudioInterfaceGetMicBlockFrames());
+            captureLatency.clear();
+        }
 
-                fftFrequency(&freqArray[0], 
-                             audioPlayer.getFreq(), 
-                             g_FFT_LEN / 2);
+        int nLanes = 1;
+        analyzedBlockTicks = 0;
+        int rate = 0;
+
+        if (audioInterfacePlayerMode)
+        {
+            int channels = audioPlayer.getChannels();
+            rate = (guiGetAnalysisRate() > 0) ? guiGetAnalysisRate() 
+                                              : audioPlayer.getFreq();
+
+            if (!audioPlayer.getIsPaused()
+                && analysisResampler.init(channels, audioPlayer.getFreq(), rate))
+            {
+                // the window at the analysis rate, and the filter around it
+                int nInFrames = analysisResampler.getBlockInputFrames(
+                    g_AUDIO_BUFFER_LEN
+                );
+
+                frameBuffer.resize(nInFrames * channels);
+                audioPlayer.getAudioData(frameBuffer.data(), nInFrames);
+
+                resampledBuffer.resize(g_AUDIO_BUFFER_LEN * channels);
+                analysisResampler.resampleBlock(frameBuffer.data(), 
+                                                nInFrames,
+                                                resampledBuffer.data(), 
+                                                g_AUDIO_BUFFER_LEN);
+
+                nLanes = splitChannels(lanePtrs.data(), 
+                                       resampledBuffer.data(), 
+                                       g_AUDIO_BUFFER_LEN, 
+                                       channels);
                              
                 audioInterfaceIsPaused = false;
             }
@@ -234,14 +414,36 @@ int main()
         }
         else
         {
-            if (!mic.getIsPaused())
+            int channels = mics.getTotalChannels();
+            rate = (guiGetAnalysisRate() > 0) ? guiGetAnalysisRate() 
+                                              : mics.getFreq();
+
+            // every device resampled to the rate on its own, in parallel
+            resampledBuffer.resize(g_AUDIO_BUFFER_LEN * channels);
+
+            // analysed as soon as a block arrives after this point, rather
+            // than with one which may have waited up to a block already,
+            // the frame is held by at most a block period
+            if (guiAudioInterfaceGetLowLatency() && !mics.getIsPaused())
+            {
+                mics.waitForBlock();
+            }
+
+            // stamped before the read, the samples read are at least as new
+            uint64_t blockTicks = mics.getLastBlockTicks();
+
+            if (!mics.getIsPaused() 
+                && channels > 0
+                && mics.getAudioData(resampledBuffer.data(), 
+                                     g_AUDIO_BUFFER_LEN, 
+                                     rate))
             {
-                mic.getAudioData(&signalBuffer[0], 
-                                 g_AUDIO_BUFFER_LEN);
+                analyzedBlockTicks = blockTicks;
 
-                fftFrequency(&freqArray[0], 
-                             mic.getFreq(), 
-                             g_FFT_LEN / 2);
+                nLanes = splitChannels(lanePtrs.data(), 
+                                       resampledBuffer.data(), 
+                                       g_AUDIO_BUFFER_LEN, 
+                                       channels);
 
                 audioInterfaceIsPaused = false;
             }
@@ -253,52 +455,119 @@ int main()
 
         if (!audioInterfaceIsPaused)
         {
-            // update the spectrogram
-            // ----------------------
-            // perfrom FFT
-            memset(&signalBuffer[g_AUDIO_BUFFER_LEN], 
-                   0, 
-                   (g_FFT_LEN - g_AUDIO_BUFFER_LEN) * sizeof(float));
-
-            fftForwardFFT(&signalBuffer[0], 
-                          &complexBuffer[0], 
-                          &workBuffer[0]);
-
-            fftComplexToRealDB(&magnitudeBuffer[0], 
-                               &complexBuffer[0], 
-                               g_FFT_LEN / 2, 
-                               true);
-
-            // spectrogram stuff
-            array2dMoveRowsUp(&z[0], nRowsV, nColsV, 1);
-
-            smoothingBlurRow(&magnitudeBuffer[1],
-                             &magnitudeBuffer[1],
-                             &previousRows[0],
-                             &workRow[0],
-                             &workFFTRow[0],
-                             &workConvRow[0],
-                             &colKernel[0],
-                             g_FFT_LEN,
-                             nConvRows);
-
-            //  omit DC and the freq before Nyquist
-            memcpy(&z[array2dIdx(nRowsV - 1, 0, nColsV)], 
-                   &magnitudeBuffer[1], 
-                   (g_FFT_LEN / 2 - 2) * sizeof(float));
-
-            // modify z array on GPU
-            xy.zSubAllData(z.data());  
+            // the lanes show other signals now, start over
+            if (nLanes != nActiveLanes 
+                || guiGetChannelMode() != channelMode
+                || rate != analysisRate)
+            {
+                for (SpectrogramLane* lane : lanePtrs)
+                {
+                    lane->clear();
+                }
+
+                nActiveLanes = nLanes;
+                channelMode = guiGetChannelMode();
+                analysisRate = rate;
+
+                fftFrequency(&freqArray[0], analysisRate, g_FFT_LEN / 2);
+            }
+
+            // update the spectrograms, in parallel
+            // ------------------------------------
+            spectrogramLaneAnalyzeAll(lanePtrs.data(), 
+                                      nActiveLanes, 
+                                      g_AUDIO_BUFFER_LEN);
         }
         else
         {
             // nothing, the buffer will stay the same hence achieving pause
         }
 
-        // draw and unbind viewport
-        // ------------------------
-        xy.draw();
+        profiler.endStage(PROFILER_DSP);
+
+        // modify z array on GPU
+        // ---------------------
+        profiler.beginStage(PROFILER_Z_UPLOAD);
+        for (int i = 0; i < nActiveLanes; ++i)
+        {
+            lanes[i]->upload(!audioInterfaceIsPaused);
+        }
+        profiler.endStage(PROFILER_Z_UPLOAD);
+
+        // viewport size and render scale
+        // ------------------------------
+        // follows the viewport size of the last GUI frame in device pixels
+        if (guiViewportGetWidth() > 0 && guiViewportGetHeight() > 0)
+        {
+            sceneBuffer.rescale(guiViewportGetWidth(), guiViewportGetHeight());
+        }
+
+        float renderScale = dynamicResolution.update(
+            profiler.getLatestGpuFrameMs()
+        );
+        int renderWidth = std::max(1, static_cast<int>(
+            sceneBuffer.getWidth() * renderScale + 0.5f
+        ));
+        int renderHeight = std::max(1, static_cast<int>(
+            sceneBuffer.getHeight() * renderScale + 0.5f
+        ));
+
+        // render viewport to frame buffer texture
+        // ---------------------------------------
+        profiler.beginStage(PROFILER_GRID_DRAW);
+
+        sceneBuffer.bind();
+        glViewport(0, 0, renderWidth, renderHeight);
+
+        // background for viewport only
+        glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // draw 
+        rectShader.use();
+        rectShader.setMat4(rotationMatLoc, camera.getPVMMat());
+        rectShader.setBool(powerInputLoc, guiGetPowerInput());
+        rectShader.setFloat(floorDBLoc, guiGetFloorDB());
+        rectShader.setFloat(rangeDBLoc, guiGetRangeDB());
+        colormap.bind(0);
+
+        glm::vec3 viewDirection = camera.getViewDirection();
+
+        for (int i = 0; i < nActiveLanes; ++i)
+        {
+            Grid& grid = lanes[i]->getGrid();
+
+            rectShader.setVec4(surfaceTransformLoc, 
+                               surfaceTransform(i, nActiveLanes, 
+                                                guiGetChannelLayout()));
+
+            // nearest quads first, so the hidden fragments fail the depth test
+            if (guiGetFrontToBackOrdering())
+            {
+                grid.sortFrontToBack(viewDirection.x, viewDirection.y);
+            }
+            else
+            {
+                grid.setDrawOrder(ARRAY2D_ROW_FORWARD);
+            }
+
+            grid.draw();
+        }
+
+        profiler.endStage(PROFILER_GRID_DRAW);
+
+        // unbind viewport
+        // ---------------
+        profiler.beginStage(PROFILER_FRAMEBUFFER);
+
+        // asynchronous readback of the rendered region, before unbinding
+        frameCapture.captureFrame(renderWidth, renderHeight);
+
         sceneBuffer.unbind();
+
+        int drawableWidth, drawableHeight;
+        SDL_GL_GetDrawableSize(window, &drawableWidth, &drawableHeight);
+        glViewport(0, 0, drawableWidth, drawableHeight);
         
         //--------------
         // window render
@@ -307,30 +576,59 @@ int main()
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        profiler.endStage(PROFILER_FRAMEBUFFER);
+
         // gui render
         // ----------
+        profiler.beginStage(PROFILER_IMGUI);
+
         guiNewFrame();
 
         guiInputs inputs;
 
         inputs.freqPlotLen = g_FFT_LEN / 2 - 2;
         inputs.freqPlotX = &freqArray[1];
-        inputs.freqPlotY = &magnitudeBuffer[1];
+        inputs.freqPlotY = &lanes[0]->getMagnitude()[1];
         inputs.viewportTextureID = sceneBuffer.getFrameTexture();
+        inputs.viewportUMax = static_cast<float>(renderWidth) 
+                              / sceneBuffer.getWidth();
+        inputs.viewportVMax = static_cast<float>(renderHeight) 
+                              / sceneBuffer.getHeight();
         inputs.cameraPtr = &camera;
         inputs.audioPlayerPtr = &audioPlayer;
-        inputs.micPtr = &mic;
-        inputs.gridPtr = &xy;
+        inputs.micsPtr = &mics;
+        inputs.gridPtr = &lanes[0]->getGrid();
+        inputs.colormapPtr = &colormap;
+        inputs.profilerPtr = &profiler;
+        inputs.dynamicResolutionPtr = &dynamicResolution;
+        inputs.frameCapturePtr = &frameCapture;
+        inputs.captureLatencyPtr = &captureLatency;
 
         guiApp(inputs);
 
         guiRender();
 
+        profiler.endStage(PROFILER_IMGUI);
+
+        profiler.beginStage(PROFILER_SWAP);
         SDL_GL_SwapWindow(window);
+        profiler.endStage(PROFILER_SWAP);
+
+        // the swap returns about when the frame is presented, earlier if
+        // the driver queues it, so this is an estimate of the display
+        if (analyzedBlockTicks != 0)
+        {
+            uint64_t displayTicks = SDL_GetPerformanceCounter();
+            captureLatency.add(1000.0 * (displayTicks - analyzedBlockTicks)
+                               / SDL_GetPerformanceFrequency());
+        }
+
+        profiler.endFrame();
     }
 
     // clean up
     // --------
+    frameCapture.stop();
     guiCleanUp();
     fftCleanUp();
     SDL_GL_DeleteContext(gl_context);
@@ -341,7 +639,9 @@ int main()
 }
 
 
-bool processInput(SDL_Window* window, Camera& camera)
+bool processInput(SDL_Window* window, 
+                  Camera& camera, 
+                  FrameScheduler& scheduler)
 {
     bool done = false;
 
@@ -354,6 +654,9 @@ bool processInput(SDL_Window* window, Camera& camera)
         // --------------------
         ImGui_ImplSDL2_ProcessEvent(&event);
 
+        // something might change on screen, redraw
+        scheduler.processEvent(event);
+
         // handle quit
         // -----------
         if (event.type == SDL_QUIT)
@@ -412,6 +715,121 @@ bool processInput(SDL_Window* window, Camera& camera)
     return done;
 }
 
+void reserveLanes(std::vector<std::unique_ptr<SpectrogramLane>>& lanes,
+                  std::vector<SpectrogramLane*>& lanePtrs,
+                  const int nLanes,
+                  const int nRowsV,
+                  const int nColsV,
+                  const std::string& cacheDir)
+{
+    while (static_cast<int>(lanes.size()) < nLanes)
+    {
+        lanes.push_back(std::make_unique<SpectrogramLane>(
+            nRowsV, nColsV,
+            g_FFT_LEN,
+            "../src/shader_programs/spectrum.vs",
+            "../src/shader_programs/spectrum.fs",
+            cacheDir.empty() ? nullptr : cacheDir.c_str()
+        ));
+        lanePtrs.push_back(lanes.back().get());
+    }
+}
+
+
+int getNumLanes(const int channels)
+{
+    return std::min(channelMixGetNumOutputs(guiGetChannelMode(), channels), 
+                    g_MAX_LANES);
+}
+
+
+int splitChannels(SpectrogramLane* const* lanes,
+                  const float* frames,
+                  const int nFrames,
+                  const int channels)
+{
+    channelMixMode mode = guiGetChannelMode();
+    int nLanes = getNumLanes(channels);
+
+    if (mode == CHANNEL_MIX_SELECT)
+    {
+        // the mode is kept across files, the channel might not exist
+        int channel = std::min(guiGetChannelIndex(), channels - 1);
+
+        channelMixExtract(lanes[0]->getSignalBuffer(), 
+                          frames, nFrames, channels, channel);
+    }
+    else if (mode == CHANNEL_MIX_SPLIT && nLanes > 1)
+    {
+        channelMixExtract(lanes[0]->getSignalBuffer(), 
+                          frames, nFrames, channels, 0);
+        channelMixExtract(lanes[1]->getSignalBuffer(), 
+                          frames, nFrames, channels, 1);
+    }
+    else if (mode == CHANNEL_MIX_EACH && nLanes > 1)
+    {
+        // linear in the channels, a lane each
+        for (int i = 0; i < nLanes; ++i)
+        {
+            channelMixExtract(lanes[i]->getSignalBuffer(), 
+                              frames, nFrames, channels, i);
+        }
+    }
+    else if (mode == CHANNEL_MIX_MID_SIDE && nLanes > 1)
+    {
+        channelMixMidSide(lanes[0]->getSignalBuffer(), 
+                          lanes[1]->getSignalBuffer(), 
+                          frames, nFrames, channels);
+    }
+    else
+    {
+        channelMixDownmix(lanes[0]->getSignalBuffer(), 
+                          frames, nFrames, channels);
+    }
+
+    return nLanes;
+}
+
+
+glm::vec4 surfaceTransform(const int lane, 
+                           const int nLanes, 
+                           const channelMixLayout layout)
+{
+    if (nLanes <= 1)
+    {
+        return glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+    }
+
+    // the grids span [-0.8, 0.8], shrunk a little for a gap between lanes
+    const float extent = 0.8f;
+
+    if (layout == CHANNEL_MIX_TILED)
+    {
+        int nCols, nRows;
+        channelMixGetTiles(nLanes, &nCols, &nRows);
+
+        int col = lane % nCols;
+        int row = lane / nCols;
+        float centerX = -extent + (2.0f * col + 1.0f) * extent / nCols;
+        float centerY = -extent + (2.0f * row + 1.0f) * extent / nRows;
+
+        // first row at the top
+        return glm::vec4(0.95f / nCols, 0.95f / nRows, centerX, -centerY);
+    }
+
+    const float scale = 0.95f / nLanes;
+    float center = -extent + (2.0f * lane + 1.0f) * extent / nLanes;
+
+    if (layout == CHANNEL_MIX_STACKED)
+    {
+        // first lane at the top
+        return glm::vec4(1.0f, scale, 0.0f, -center);
+    }
+
+    return glm::vec4(scale, 1.0f, center, 0.0f);
+}
+
+
 void checkRenderErrors(const char* errorLocation)
 {
     GLenum err;
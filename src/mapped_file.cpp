@@ -0,0 +1,172 @@
+#include "mapped_file.hpp"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    :   data(nullptr),
+        size(0),
+#ifdef _WIN32
+        fileHandle(INVALID_HANDLE_VALUE),
+        mappingHandle(nullptr)
+#else
+        fileDescriptor(-1)
+#endif
+{
+
+}
+
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* filepath)
+{
+    this->close();
+
+    this->fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ,
+                                   nullptr, OPEN_EXISTING,
+                                   FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "Failed to open file: " << filepath << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        std::cout << "Failed to map empty file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY,
+                                             0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        std::cout << "Failed to map file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->data = static_cast<const uint8_t*>(
+        MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        std::cout << "Failed to map file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    this->size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+    }
+
+    this->data = nullptr;
+    this->size = 0;
+    this->mappingHandle = nullptr;
+    this->fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const char* filepath)
+{
+    this->close();
+
+    this->fileDescriptor = ::open(filepath, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        std::cout << "Failed to open file: " << filepath << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        std::cout << "Failed to map empty file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE,
+                         fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cout << "Failed to map file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    // playback reads forward, let the kernel read ahead generously
+    madvise(mapping, fileStat.st_size, MADV_SEQUENTIAL);
+
+    this->data = static_cast<const uint8_t*>(mapping);
+    this->size = static_cast<uint64_t>(fileStat.st_size);
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    if (fileDescriptor >= 0)
+    {
+        ::close(fileDescriptor);
+    }
+
+    this->data = nullptr;
+    this->size = 0;
+    this->fileDescriptor = -1;
+}
+
+#endif
+
+
+const uint8_t* MappedFile::getData()
+{
+    return this->data;
+}
+
+
+uint64_t MappedFile::getSize()
+{
+    return this->size;
+}
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+// Read-only memory-mapped file
+//
+// The file is mapped into the address space instead of being read, pages
+// are loaded by the OS when first touched and can be dropped again under
+// memory pressure. POSIX mmap, or CreateFileMapping on Windows.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstdint>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Map the whole file read-only, closing the previous one
+    ///
+    /// \return     false if the file can't be opened or mapped,
+    ///             an empty file can't be mapped
+    ///
+    bool open(const char* filepath);
+
+    /// Unmap and close the file
+    ///
+    void close();
+
+    /// \return     first byte of the mapping, nullptr if nothing is mapped
+    ///
+    const uint8_t* getData();
+
+    /// \return     size of the mapping in bytes
+    ///
+    uint64_t getSize();
+
+private:
+    const uint8_t* data;
+    uint64_t size;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+#endif
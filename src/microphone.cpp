@@ -1,44 +1,73 @@
 #include "microphone.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+
+// frames per callback unless setBlockFrames() says otherwise
+static constexpr int s_DEFAULT_BLOCK_FRAMES = 2048;
+
+// the callback's block and the next one, before analysis asks for more
+static constexpr int s_RING_BLOCKS = 2;
+
+// how far the history and the disk writer may fall behind, through a
+// slow disk
+static constexpr int s_FOLLOWER_HEADROOM_SEC = 4;
 
 void microphoneAudioCallback(void* userdata, Uint8* stream, int len);
 
-Microphone::Microphone(int maxRecordingSec)
+/// Format of a recording device as it runs natively
+///
+/// \param deviceName   nullptr for the default device
+///
+/// \return             false if SDL can't tell
+///
+static bool s_getDeviceSpec(const char* deviceName, SDL_AudioSpec* spec);
+
+Microphone::Microphone(int maxHistorySec, const char* deviceName)
     :   device(0),
-        maxRecordingSec(maxRecordingSec),
-        ringBufferPtr(nullptr),
-        ringBufferSize(maxRecordingSec * 44100 * sizeof(float)),
-        audioBytePos(0),
-        remainingRingBufferSize(0),
+        blockFrames(s_DEFAULT_BLOCK_FRAMES),
+        blockTicks(0),
+        blockSemaphore(SDL_CreateSemaphore(0)),
+        analysisFrames(0),
+        followers(maxHistorySec),
         numDevices(0),
         isPaused(true)
 {
-    // reserve buffer size, will force recording to single channel
-    this->ringBuffer.resize(ringBufferSize);
-    // set initial ring buffer to zero's, so I don't need to
-    // implement states in getAudioData
-    memset(this->ringBuffer.data(), 0, ringBufferSize);
-
-    this->ringBufferPtr = reinterpret_cast<Uint8*>(ringBuffer.data());
+    SDL_zero(audioSpec);
 
-    this->setupDevice();
+    // the ring is allocated on the first record()
+    this->setupDevice(deviceName);
 }
 
 Microphone::~Microphone()
 {
-    // ringBuffer is a vector, will deallocate automatically
-    this->ringBufferPtr = nullptr;
-
+    // stop the callback before the ring goes
     if (device != 0)
     {
         SDL_CloseAudioDevice(device);
     }
+
+    // the followers take what the callback published before it stopped
+    followers.stop();
+
+    if (blockSemaphore != nullptr)
+    {
+        SDL_DestroySemaphore(blockSemaphore);
+    }
 }
 
 
 void Microphone::record()
 {
+    // the callback hasn't run yet, or was paused
+    this->reserveRing(followers.getMaxHistorySec() > 0 || followers.getIsFollowing());
+
+    if (device != 0)
+    {
+        followers.startHistory(&ring, audioSpec.channels, audioSpec.freq);
+    }
+
     this->isPaused = false;
     SDL_PauseAudioDevice(device, 0);  
 }
@@ -63,69 +92,180 @@ int Microphone::getFreq()
 }
 
 
-/// TODO:   if (bufferSize > ringBufferSize), should throw an error
-///
-void Microphone::getAudioData(float* buffer, int numSamples)
+int Microphone::getChannels()
+{
+    return (device != 0) ? this->audioSpec.channels : 0;
+}
+
+
+std::string Microphone::getDeviceName()
 {
-    // buffer:      external buffer which data is copied to
-    // ringBuffer:  internal ring buffer which data is originally held
+    return this->deviceName;
+}
 
-    // determining the buffer size 
-    Uint32 bufferSize = (numSamples * sizeof(float));
+
+void Microphone::getAudioData(float* buffer, int numFrames)
+{
+    uint64_t numSamples = static_cast<uint64_t>(numFrames) * getChannels();
 
     if (!isPaused)
     {
-        std::lock_guard<std::mutex> lock(audioMutex);
-        
-        if ((audioBytePos <= bufferSize) && (bufferSize <= ringBufferSize))
+        // grown once, the first time analysis asks for more
+        if (static_cast<uint64_t>(numFrames) > analysisFrames)
         {
-            // need to copy end and front data due to ring buffer wrapping
-            // first section (older data):
-            Uint32 dataBytePos = ringBufferSize - (bufferSize - audioBytePos);
-            Uint8* dataPtr = ringBufferPtr + dataBytePos;
-            Uint32 copySize = bufferSize - audioBytePos;
-
-            memcpy(buffer, dataPtr, copySize);
-
-            // second section (newer data):
-            Uint8* buffer2ndPtr =   reinterpret_cast<Uint8*>(buffer) 
-                                  + (bufferSize - audioBytePos);
-            dataPtr = ringBufferPtr;
-            copySize = audioBytePos;
-
-            memcpy(buffer2ndPtr,
-                   dataPtr,
-                   copySize);
-        }
-        else if ((audioBytePos > bufferSize) && (bufferSize <= ringBufferSize))
-        { 
-            //   simply copy and paste
-            Uint32 dataBytePos = audioBytePos - bufferSize;
-            Uint8* dataPtr = ringBufferPtr + dataBytePos;
-            
-            memcpy(buffer, dataPtr, bufferSize);
-        }
-        else
-        {
-            // bufferSize > ringBufferSize
-
-            // Not sure how to handle the start of recording
-            // since it is a ring buffer, like there is no
-            // way to know if it is the start or buffer wrapping
-            // unless implementing states (I dun wanna :p).
-            //
-            // Easiest way is to start with a buffer initialized
-            // with zeros, which it is now.
-
-            memset(buffer , 0, bufferSize);
-            std::cout << "buffer exceeded recording size" << std::endl;
+            this->analysisFrames = numFrames;
+            this->reserveRing(followers.getIsFollowing());
         }
+
+        // never waits for the callback, zeros before the first sample
+        ring.readLatest(buffer, numSamples);
     }
     else
     {
         // fill in with zero if recording is paused
-        memset(buffer, 0, bufferSize);           
+        memset(buffer, 0, numSamples * sizeof(float));           
+    }
+}
+
+
+void Microphone::setBlockFrames(int blockFrames)
+{
+    if (blockFrames <= 0 || blockFrames == this->blockFrames)
+    {
+        return;
+    }
+
+    this->blockFrames = blockFrames;
+
+    // the same device again, openDevice() overwrites the name
+    bool wasRecording = !isPaused;
+    std::string name = deviceName;
+
+    // saving and the history go on across the reopen, the history is
+    // only dropped if the device comes back at another rate or channel
+    // count
+    followers.suspend();
+    this->openDevice(name.empty() ? nullptr : name.c_str());
+
+    if (device == 0)
+    {
+        followers.stop();
+        return;
+    }
+
+    this->reserveRing(followers.getIsFollowing());
+    followers.resume(&ring, audioSpec.channels, audioSpec.freq);
+
+    if (wasRecording)
+    {
+        this->record();
+    }
+}
+
+
+int Microphone::getBlockFrames()
+{
+    return this->blockFrames;
+}
+
+
+int Microphone::getCallbackFrames()
+{
+    return (device != 0) ? this->audioSpec.samples : 0;
+}
+
+
+bool Microphone::waitForBlock(int timeoutMs)
+{
+    if (isPaused || device == 0 || blockSemaphore == nullptr)
+    {
+        return false;
+    }
+
+    // a block arriving after the call, the ones posted since the last
+    // frame are already in the ring
+    while (SDL_SemTryWait(blockSemaphore) == 0)
+    {
+
+    }
+
+    return SDL_SemWaitTimeout(blockSemaphore, static_cast<Uint32>(timeoutMs)) == 0;
+}
+
+
+uint64_t Microphone::getLastBlockTicks()
+{
+    return blockTicks.load(std::memory_order_acquire);
+}
+
+
+bool Microphone::startSaving(const char* folderPath, int maxFileSec, int maxFileMB)
+{
+    if (device == 0)
+    {
+        std::cout << "Microphone: no device to save from" << std::endl;
+        return false;
+    }
+
+    this->reserveRing(true);
+
+    return followers.startSaving(&ring, audioSpec.channels, audioSpec.freq,
+                                 folderPath, maxFileSec, maxFileMB);
+}
+
+
+void Microphone::stopSaving()
+{
+    followers.stopSaving();
+}
+
+
+bool Microphone::getIsSaving()
+{
+    return followers.getRecorder().getIsRecording();
+}
+
+
+std::string Microphone::getSavingPath()
+{
+    return followers.getRecorder().getOutputPath();
+}
+
+
+uint64_t Microphone::getSavedFrames()
+{
+    return followers.getRecorder().getFramesWritten();
+}
+
+
+uint64_t Microphone::getDroppedFrames()
+{
+    return followers.getRecorder().getFramesDropped();
+}
+
+
+bool Microphone::saveHistory(const char* filepath)
+{
+    return followers.getHistory().save(filepath, audioSpec.freq);
+}
+
+
+double Microphone::getHistorySec()
+{
+    if (device == 0)
+    {
+        return 0.0;
     }
+
+    return static_cast<double>(followers.getHistory().getSampleCount())
+           / (static_cast<double>(audioSpec.freq) * audioSpec.channels);
+}
+
+
+uint64_t Microphone::getBufferedBytes()
+{
+    return (ring.getCapacity() + followers.getHistory().getAllocatedSamples())
+           * sizeof(float);
 }
 
 
@@ -161,7 +301,22 @@ void Microphone::closeDevice()
 
 void Microphone::setupDevice(const char* deviceName, 
                              int desiredFreq,
-                             int desiredSamples)
+                             int desiredSamples,
+                             int desiredChannels)
+{
+    // another device, the files saved so far are completed and the
+    // history of the previous device is dropped
+    followers.stop();
+    followers.clearHistory();
+
+    this->openDevice(deviceName, desiredFreq, desiredSamples, desiredChannels);
+}
+
+
+void Microphone::openDevice(const char* deviceName, 
+                            int desiredFreq,
+                            int desiredSamples,
+                            int desiredChannels)
 {
     // close the previously opened audio device if it exists
     if (device != 0)
@@ -169,99 +324,141 @@ void Microphone::setupDevice(const char* deviceName,
         SDL_CloseAudioDevice(device);
     }
 
+    // no block of the new device has arrived
+    this->blockTicks = 0;
+
+    // every channel the device has, e.g. all inputs of an interface
+    if (desiredChannels <= 0)
+    {
+        SDL_AudioSpec nativeSpec;
+        desiredChannels = (s_getDeviceSpec(deviceName, &nativeSpec) 
+                           && nativeSpec.channels > 0) ? nativeSpec.channels : 1;
+    }
+
     SDL_AudioSpec desiredSpec;
     desiredSpec.freq = desiredFreq;
     desiredSpec.format = AUDIO_F32SYS;
-    desiredSpec.channels = 1;
-    desiredSpec.samples = desiredSamples;
+    desiredSpec.channels = static_cast<Uint8>(desiredChannels);
+    desiredSpec.samples = static_cast<Uint16>(
+        (desiredSamples > 0) ? desiredSamples : blockFrames);
     desiredSpec.callback = microphoneAudioCallback;  
     desiredSpec.userdata = this;
 
     // set the device for playback for 0, or '1' for recording.
     device = SDL_OpenAudioDevice(
         deviceName, 1, &desiredSpec, &audioSpec, 
-        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE // don't allow format change
+        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE 
+        | SDL_AUDIO_ALLOW_CHANNELS_CHANGE // don't allow format change
     );
     
+    this->deviceName = (deviceName != nullptr) ? deviceName : "";
 
     if (device == 0)
     {
         std::cout << "Microphone device error: " << SDL_GetError() << std::endl; 
     }  
-    else
+    else if (ring.getCapacity() > 0)
     {
-        Uint32 obtainedRingBufferSize =   audioSpec.freq
-                                        * maxRecordingSec 
-                                        * SDL_AUDIO_BITSIZE(audioSpec.format) 
-                                        / 8
-                                        * audioSpec.channels;
-        
-        if (obtainedRingBufferSize != this->ringBufferSize)
-        {
-            this->ringBufferSize = obtainedRingBufferSize;
-            this->ringBuffer.resize(ringBufferSize);
-
-            // set initial ring buffer to zero's, so I don't need to
-            // implement states in getAudioData
-            memset(this->ringBuffer.data(), 0, ringBufferSize);
-        }
-        else
-        {
-            // no need to resize ring buffer
-        }
-
+        // frames of another channel count would be read across frames,
+        // the callback of the new device hasn't run yet
+        ring.allocate(ring.getCapacity());
     }
 }
 
 
-void microphoneAudioCallback(void* userdata, Uint8* stream, 
-                             int callbackBufferSize)
+void Microphone::reserveRing(bool isFollowed)
 {
-    Microphone* mic = static_cast<Microphone*>(userdata);
+    if (device == 0)
+    {
+        return;
+    }
 
-    std::lock_guard<std::mutex> lock(mic->audioMutex);
+    // in samples, frames of interleaved float
+    uint64_t blockSamples =   static_cast<uint64_t>(audioSpec.samples)
+                            * audioSpec.channels;
+    uint64_t neededSamples =   analysisFrames * audioSpec.channels 
+                             + s_RING_BLOCKS * blockSamples;
 
-    // finding the remaining buffer size
-    // ---------------------------------
-    if (mic->ringBufferSize > mic->audioBytePos)
+    if (isFollowed)
     {
-        mic->remainingRingBufferSize = mic->ringBufferSize - mic->audioBytePos;
+        neededSamples +=   static_cast<uint64_t>(audioSpec.freq)
+                         * s_FOLLOWER_HEADROOM_SEC
+                         * audioSpec.channels;
     }
-    else
+
+    if (neededSamples <= ring.getCapacity())
     {
-        // buffer has reached the end, time to loop back
-        // no modulo operation needed, in theory
-        mic->remainingRingBufferSize = 0;
+        // no need to resize ring buffer
+        return;
     }
 
-    // see what to do with the ring buffer
-    // -----------------------------------
-    if (static_cast<Uint32>(callbackBufferSize) > mic->remainingRingBufferSize)
+    // their positions in the ring start over
+    followers.suspend();
+
+    SDL_LockAudioDevice(device);
+    ring.allocate(neededSamples);
+    SDL_UnlockAudioDevice(device);
+
+    followers.resume(&ring, audioSpec.channels, audioSpec.freq);
+}
+
+
+bool s_getDeviceSpec(const char* deviceName, SDL_AudioSpec* spec)
+{
+    SDL_zero(*spec);
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+    if (deviceName == nullptr)
     {
-        // need to loop back to the begining
-        // split the callback buffer into two, store at seperate ends
-        // whatever can fit at the end 
-        SDL_memcpy(mic->ringBufferPtr + mic->audioBytePos,
-                   stream,
-                   mic->remainingRingBufferSize);
-        
-        // the remaining can go to the front
-        SDL_memcpy(mic->ringBufferPtr,
-                   stream + mic->remainingRingBufferSize,
-                   callbackBufferSize - mic->remainingRingBufferSize);
-        
-        mic->audioBytePos = (callbackBufferSize - mic->remainingRingBufferSize);
+        char* defaultName = nullptr;
+
+        if (SDL_GetDefaultAudioInfo(&defaultName, spec, 1) == 0)
+        {
+            SDL_free(defaultName);
+            return true;
+        }
+        return false;
     }
-    else
+#endif
+
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+    if (deviceName != nullptr)
     {
-        // no need to loop back, proceed as normal
-        SDL_memcpy(mic->ringBufferPtr + mic->audioBytePos,
-                   stream,
-                   callbackBufferSize);
-                   
-        mic->audioBytePos += callbackBufferSize;
+        int numDevices = SDL_GetNumAudioDevices(1);
+
+        for (int i = 0; i < numDevices; ++i)
+        {
+            const char* name = SDL_GetAudioDeviceName(i, 1);
+
+            if (name && strcmp(name, deviceName) == 0)
+            {
+                return SDL_GetAudioDeviceSpec(i, 1, spec) == 0;
+            }
+        }
     }
+#endif
 
-    // be pedantic and make doubly sure it will wrap around
-    mic->audioBytePos %= mic->ringBufferSize;
+    (void)deviceName;
+    return false;
 }
+
+
+void microphoneAudioCallback(void* userdata, Uint8* stream, 
+                             int callbackBufferSize)
+{
+    Microphone* mic = static_cast<Microphone*>(userdata);
+
+    // no lock, the render thread reads behind the write counter
+    mic->ring.write(reinterpret_cast<const float*>(stream), 
+                    callbackBufferSize / sizeof(float));
+
+    // the arrival of the block, stamped once it can be read
+    mic->blockTicks.store(SDL_GetPerformanceCounter(), std::memory_order_release);
+
+    // wakes a waiting reader, see the header for when the post may wait,
+    // not posted again while nobody took it so the count stays bounded
+    if (mic->blockSemaphore != nullptr && SDL_SemValue(mic->blockSemaphore) == 0)
+    {
+        SDL_SemPost(mic->blockSemaphore);
+    }
+}
\ No newline at end of file
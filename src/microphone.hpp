@@ -3,6 +3,26 @@
 // Library for real-time sound recording into float-32
 //
 // Made with SDL2
+//
+// The device is opened with its own channel count, frames are interleaved.
+//
+// The callback appends to a SampleRing (see sample_ring.hpp) and never
+// waits on the render thread, which copies the latest samples out of it
+// without a lock. A CaptureRecorder (see capture_recorder.hpp) may drain
+// the same ring to disk from its own thread.
+//
+// The ring is only as long as the latest samples analysis asks for, plus
+// headroom for the threads following it, and is allocated on the first
+// record() rather than at startup. The longer history, for saving what was
+// just recorded, is kept by a SampleHistory (see sample_history.hpp) that
+// grows in segments as recording goes on.
+//
+// For low latency the device can be opened with small callback blocks,
+// the callback then stamps each block's arrival and posts a semaphore that
+// waitForBlock() waits on. Where SDL's semaphore is the system's own
+// (sem_post on Linux, ReleaseSemaphore on Windows) posting never waits on
+// the waiting thread; SDL's fallback semaphore, e.g. on macOS, takes a
+// mutex the waiter only holds briefly.
 // 
 //===----------------------------------------------------------------------===//
 #ifndef MICROPHONE_HPP
@@ -10,18 +30,23 @@
 
 #include <vector>
 #include <string>
-#include <mutex>
+#include <atomic>
 
 #include <SDL2/SDL.h>
 
+#include "sample_ring.hpp"
+#include "ring_followers.hpp"
+
 class Microphone
 {
 public:
-    /// \param maxRecordingSec  buffer size, won't limit the recording time;
-    ///                         however it only holds maxRecordingSec of data
-    ///                         in the buffer should the user wants to save it
+    /// \param maxHistorySec    longest history kept for saveHistory(), won't
+    ///                         limit the recording time, 0 to keep none
+    ///
+    /// \param deviceName       device opened, defaulted to the system
+    ///                         default recording device
     ///
-    Microphone(int maxRecordingSec = 300);
+    Microphone(int maxHistorySec = 300, const char* deviceName = nullptr);
     ~Microphone();
 
     /// Start recording and start filling in the ring buffer
@@ -43,20 +68,114 @@ public:
     ///
     int getFreq();
 
-    /// Fill in a buffer array with floating point audio samples from the 
-    /// current recording point to user specified number of samples before the 
-    /// current recording point.
+    /// \return     number of interleaved channels the device was opened with,
+    ///             0 if it couldn't be opened
+    ///
+    int getChannels();
+
+    /// \return     name of the device, empty for the system default
     ///
-    /// If the buffer size exceeds the sample avaliable, this function will
+    std::string getDeviceName();
+
+    /// Fill in a buffer array with interleaved floating point frames from
+    /// the current recording point to user specified number of frames before
+    /// the current recording point.
+    ///
+    /// If the buffer size exceeds the frames avaliable, this function will
     /// fill the buffer with zeros. 
     ///
     /// \param buffer       pointer to the buffer array, the buffer must have
-    ///                     enough space to hold all the samples
+    ///                     enough space to hold numFrames * getChannels()
+    ///                     samples
+    ///
+    /// \param numFrames    number of frames to extract from the audio stream
+    ///
+    void getAudioData(float* buffer, int numFrames);
+
+
+    /// Reopen the device with another callback block size, recording and
+    /// saving again if it was, the history is kept unless the device
+    /// comes back at another rate or channel count
+    ///
+    /// \param blockFrames  frames per callback, small for low latency,
+    ///                     the device may round it
+    ///
+    void setBlockFrames(int blockFrames);
+
+    /// \return     frames per callback asked for
+    ///
+    int getBlockFrames();
+
+    /// \return     frames per callback the device was opened with, may
+    ///             differ from getBlockFrames(), 0 if it couldn't be opened
+    ///
+    int getCallbackFrames();
+
+    /// Wait for the callback to publish a block after this call, at most
+    /// a block period when the callback keeps up
+    ///
+    /// \param timeoutMs    longest wait
+    ///
+    /// \return             false on timeout, or if paused
+    ///
+    bool waitForBlock(int timeoutMs);
+
+    /// \return     SDL_GetPerformanceCounter() when the latest block was
+    ///             published to the ring, 0 before the first one
+    ///
+    uint64_t getLastBlockTicks();
+
+
+    /// Save everything recorded from now on to WAV files, written by a
+    /// background thread, nothing is written while paused
+    ///
+    /// \param folderPath   existing output folder
     ///
-    /// \param numSamples   number of sample points to extra from the audio 
-    ///                     stream, regardless of the number of channels
+    /// \param maxFileSec   start a new file after this many seconds,
+    ///                     0 for no limit
     ///
-    void getAudioData(float* buffer, int numSamples);
+    /// \param maxFileMB    start a new file before it outgrows this,
+    ///                     0 for no limit
+    ///
+    /// \return             whether the first file could be created
+    ///
+    bool startSaving(const char* folderPath, int maxFileSec = 0, int maxFileMB = 0);
+
+    /// Stop saving, the last file is completed and closed
+    ///
+    void stopSaving();
+
+    /// \return     whether recorded audio is being saved to disk
+    ///
+    bool getIsSaving();
+
+    /// \return     path of the file being saved
+    ///
+    std::string getSavingPath();
+
+    /// \return     number of frames saved since startSaving()
+    ///
+    uint64_t getSavedFrames();
+
+    /// \return     number of frames lost since startSaving() because the
+    ///             disk fell behind by more than the ring holds
+    ///
+    uint64_t getDroppedFrames();
+
+
+    /// Save the history kept, up to maxHistorySec, to a WAV file
+    ///
+    /// \return     false if nothing was recorded or on a write error
+    ///
+    bool saveHistory(const char* filepath);
+
+    /// \return     length of the history kept in seconds
+    ///
+    double getHistorySec();
+
+    /// \return     bytes held by the ring and the history
+    ///
+    uint64_t getBufferedBytes();
 
 
     /// Note:   Uses std::string because char* pointer might change
@@ -72,7 +191,8 @@ public:
     ///
     void closeDevice();
 
-    /// Select and setup an audio recording device
+    /// Select and setup an audio recording device, saving to disk is
+    /// stopped and the history dropped
     ///
     /// \param deviceName       defaulted to system default recording device
     ///
@@ -81,32 +201,59 @@ public:
     ///
     /// \param desiredSamples   number of samples per callback invocation
     ///                         NOT total buffer size
-    ///                         defaulted to 2048
+    ///                         defaulted to 0 for getBlockFrames(),
+    ///                         2048 unless set
+    ///
+    /// \param desiredChannels  number of channels, defaulted to 0 for the
+    ///                         device's own count (mono if it isn't known)
     ///
     void setupDevice(const char* deviceName = nullptr, 
                      int desiredFreq = 44100,
-                     int desiredSamples = 2048);
+                     int desiredSamples = 0,
+                     int desiredChannels = 0);
 
 private:
     SDL_AudioDeviceID device;
     
     // recording properties
     SDL_AudioSpec audioSpec;
+    std::string deviceName;
+    int blockFrames;
+
+    // published by the callback after each block is in the ring, the
+    // semaphore is posted at most once until a waiter takes it
+    std::atomic<uint64_t> blockTicks;
+    SDL_sem* blockSemaphore;
 
-    // ring buffer storing audio data
-    int maxRecordingSec;
-    std::vector<float> ringBuffer;
-    Uint8* ringBufferPtr;
-    Uint32 ringBufferSize; // ringBuffer size in bytes
-    Uint32 audioBytePos;   // current position in the ring buffer, in bytes
-    Uint32 remainingRingBufferSize;
+    // ring buffer storing the latest audio data, written by the callback
+    // only, long enough for the largest getAudioData() so far
+    SampleRing ring;
+    uint64_t analysisFrames;
+
+    // the history and the disk writer following the ring, suspended while
+    // it is reallocated (see ring_followers.hpp)
+    RingFollowers followers;
     
     int numDevices;    
 
-    std::mutex audioMutex;  // for thread safety during audio callback
-
     bool isPaused;
 
+    /// Grow the ring to what analysis needs, the followers of the ring are
+    /// restarted on the new one
+    ///
+    /// \param isFollowed   leave room for the history and the disk writer
+    ///                     to fall behind
+    ///
+    void reserveRing(bool isFollowed);
+
+    /// Open the device, the followers of the ring must not be running,
+    /// see setupDevice() for the parameters
+    ///
+    void openDevice(const char* deviceName, 
+                    int desiredFreq = 44100,
+                    int desiredSamples = 0,
+                    int desiredChannels = 0);
+
     friend void microphoneAudioCallback(void* userdata, Uint8* stream, 
                                         int callbackBufferSize); 
 };
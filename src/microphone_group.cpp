@@ -0,0 +1,213 @@
+#include "microphone_group.hpp"
+
+#include <iostream>
+
+
+MicrophoneGroup::MicrophoneGroup(int maxHistorySec)
+{
+    this->devices.push_back(std::make_unique<Device>());
+    this->devices[0]->mic = std::make_unique<Microphone>(maxHistorySec);
+}
+
+
+Microphone& MicrophoneGroup::getMicrophone(int index)
+{
+    return *this->devices[index]->mic;
+}
+
+
+int MicrophoneGroup::getNumDevices()
+{
+    return static_cast<int>(this->devices.size());
+}
+
+
+bool MicrophoneGroup::addDevice(const char* deviceName)
+{
+    if (getNumDevices() >= s_MAX_DEVICES)
+    {
+        std::cout << "Microphone Group: at most " << s_MAX_DEVICES
+                  << " devices" << std::endl;
+        return false;
+    }
+
+    // no history, it is only kept for the first device
+    std::unique_ptr<Device> device = std::make_unique<Device>();
+    device->mic = std::make_unique<Microphone>(0, deviceName);
+
+    if (device->mic->getChannels() == 0)
+    {
+        return false;
+    }
+
+    // the block size the others were set to
+    device->mic->setBlockFrames(getBlockFrames());
+
+    if (!getIsPaused())
+    {
+        device->mic->record();
+    }
+
+    this->devices.push_back(std::move(device));
+
+    return true;
+}
+
+
+void MicrophoneGroup::removeDevice(int index)
+{
+    if (index <= 0 || index >= getNumDevices())
+    {
+        return;
+    }
+
+    // closes the device before its ring goes
+    this->devices.erase(devices.begin() + index);
+}
+
+
+void MicrophoneGroup::record()
+{
+    for (std::unique_ptr<Device>& device : devices)
+    {
+        device->mic->record();
+    }
+}
+
+
+void MicrophoneGroup::pause()
+{
+    for (std::unique_ptr<Device>& device : devices)
+    {
+        device->mic->pause();
+    }
+}
+
+
+bool MicrophoneGroup::getIsPaused()
+{
+    return this->devices[0]->mic->getIsPaused();
+}
+
+
+int MicrophoneGroup::getFreq()
+{
+    return this->devices[0]->mic->getFreq();
+}
+
+
+int MicrophoneGroup::getTotalChannels()
+{
+    int channels = 0;
+    for (std::unique_ptr<Device>& device : devices)
+    {
+        channels += device->mic->getChannels();
+    }
+    return channels;
+}
+
+
+void MicrophoneGroup::setBlockFrames(int blockFrames)
+{
+    for (std::unique_ptr<Device>& device : devices)
+    {
+        device->mic->setBlockFrames(blockFrames);
+    }
+}
+
+
+int MicrophoneGroup::getBlockFrames()
+{
+    return this->devices[0]->mic->getBlockFrames();
+}
+
+
+int MicrophoneGroup::getCallbackFrames()
+{
+    return this->devices[0]->mic->getCallbackFrames();
+}
+
+
+bool MicrophoneGroup::waitForBlock()
+{
+    Microphone& mic = *this->devices[0]->mic;
+
+    if (mic.getFreq() <= 0 || mic.getCallbackFrames() == 0)
+    {
+        return false;
+    }
+
+    // two blocks, in case the wakeup of one was missed
+    int timeoutMs = 2 * 1000 * mic.getCallbackFrames() / mic.getFreq() + 1;
+
+    return mic.waitForBlock(timeoutMs);
+}
+
+
+uint64_t MicrophoneGroup::getLastBlockTicks()
+{
+    return this->devices[0]->mic->getLastBlockTicks();
+}
+
+
+bool MicrophoneGroup::getAudioData(float* frames, int nFrames, int rate)
+{
+    int nDevices = getNumDevices();
+    int totalChannels = getTotalChannels();
+
+    // first channel of each device in the output frames
+    std::vector<int> firstChannels(nDevices);
+    for (int d = 0, channel = 0; d < nDevices; ++d)
+    {
+        firstChannels[d] = channel;
+        channel += devices[d]->mic->getChannels();
+    }
+
+    bool isRead = true;
+
+    // each device only touches its own chain and its own channels
+    #pragma omp parallel for if(nDevices > 1) reduction(&&:isRead)
+    for (int d = 0; d < nDevices; ++d)
+    {
+        Device& device = *devices[d];
+        int channels = device.mic->getChannels();
+
+        if (channels == 0)
+        {
+            // not opened, no channels in the output
+            continue;
+        }
+
+        if (!device.resampler.init(channels, device.mic->getFreq(), rate))
+        {
+            isRead = false;
+            continue;
+        }
+
+        // the window at the analysis rate, and the filter around it
+        int nInFrames = device.resampler.getBlockInputFrames(nFrames);
+
+        device.inBuffer.resize(static_cast<size_t>(nInFrames) * channels);
+        device.mic->getAudioData(device.inBuffer.data(), nInFrames);
+
+        device.outBuffer.resize(static_cast<size_t>(nFrames) * channels);
+        device.resampler.resampleBlock(device.inBuffer.data(), nInFrames,
+                                       device.outBuffer.data(), nFrames);
+
+        // into the device's channels of the interleaved output
+        const float* src = device.outBuffer.data();
+        float* dst = frames + firstChannels[d];
+
+        for (int i = 0; i < nFrames; ++i)
+        {
+            for (int c = 0; c < channels; ++c)
+            {
+                dst[c] = src[c];
+            }
+            src += channels;
+            dst += totalChannels;
+        }
+    }
+
+    return isRead;
+}
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+// MicrophoneGroup class for recording several devices as one input
+//
+// Each device is a Microphone with its own callback and its own SampleRing,
+// so the devices never wait on each other. For analysis, the latest frames
+// of every device are resampled to a common rate, in parallel with OpenMP,
+// and interleaved into a single multichannel input: the channels of the
+// first device, then those of the second, and so on. The devices don't
+// share a clock, channels of different devices line up to about a callback.
+//
+// The first device is always there, it is the one the microphone panel
+// selects, saves to disk and keeps the history of.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MICROPHONE_GROUP_HPP
+#define MICROPHONE_GROUP_HPP
+
+#include <memory>
+#include <vector>
+
+#include "microphone.hpp"
+#include "resampler.hpp"
+
+class MicrophoneGroup
+{
+public:
+    /// \param maxHistorySec    history of the first device (see Microphone),
+    ///                         the others keep none
+    ///
+    MicrophoneGroup(int maxHistorySec = 300);
+
+    MicrophoneGroup(const MicrophoneGroup&) = delete;
+    MicrophoneGroup& operator=(const MicrophoneGroup&) = delete;
+
+    /// \param index    smaller than getNumDevices(), 0 is the first device
+    ///
+    Microphone& getMicrophone(int index);
+
+    int getNumDevices();
+
+    /// Open another device, recording if the others are
+    ///
+    /// \return     false if there are already s_MAX_DEVICES, or the device
+    ///             can't be opened
+    ///
+    bool addDevice(const char* deviceName);
+
+    /// Close a device other than the first
+    ///
+    void removeDevice(int index);
+
+
+    /// Start recording every device
+    ///
+    void record();
+
+    /// Pause every device
+    ///
+    void pause();
+
+    /// \return     whether the first device is paused
+    ///
+    bool getIsPaused();
+
+    /// \return     sample rate of the first device in Hz
+    ///
+    int getFreq();
+
+    /// \return     number of channels of all the devices opened
+    ///
+    int getTotalChannels();
+
+
+    /// Reopen every device with another callback block size
+    ///
+    /// \param blockFrames  frames per callback (see Microphone)
+    ///
+    void setBlockFrames(int blockFrames);
+
+    /// \return     frames per callback asked for
+    ///
+    int getBlockFrames();
+
+    /// \return     frames per callback the first device was opened with
+    ///
+    int getCallbackFrames();
+
+    /// Wait for the next block of the first device, the others follow
+    /// their own clocks
+    ///
+    /// \return     false on timeout, about two blocks, or if paused
+    ///
+    bool waitForBlock();
+
+    /// \return     arrival of the latest block of the first device in
+    ///             SDL performance counter ticks, 0 before the first one
+    ///
+    uint64_t getLastBlockTicks();
+
+
+    /// Fill a buffer with the latest frames of every device at one rate,
+    /// interleaved, the first device's channels first
+    ///
+    /// \param frames       output (array must have a length of
+    ///                     nFrames * getTotalChannels())
+    ///
+    /// \param nFrames      number of frames at the analysis rate
+    ///
+    /// \param rate         analysis rate in Hz
+    ///
+    /// \return             false if a device has no rate
+    ///
+    bool getAudioData(float* frames, int nFrames, int rate);
+
+private:
+    static constexpr int s_MAX_DEVICES = 4;
+
+    // the analysis chain of a device, resampled on its own
+    struct Device
+    {
+        std::unique_ptr<Microphone> mic;
+        Resampler resampler;
+        std::vector<float> inBuffer;
+        std::vector<float> outBuffer;
+    };
+
+    std::vector<std::unique_ptr<Device>> devices;
+};
+
+#endif
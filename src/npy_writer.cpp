@@ -0,0 +1,128 @@
+#include "npy_writer.hpp"
+
+#include <cstring>
+#include <iostream>
+
+// magic, version 1.0, header length, then the dict padded with spaces
+// and ending with a newline
+static constexpr size_t s_PREAMBLE_SIZE = 10;
+static constexpr size_t s_HEADER_SIZE = 128;
+
+
+NpyWriter::NpyWriter()
+    :   file(nullptr),
+        nCols(0),
+        rowsWritten(0)
+{
+
+}
+
+
+NpyWriter::~NpyWriter()
+{
+    this->close();
+}
+
+
+bool NpyWriter::open(const char* filepath, int nCols)
+{
+    this->close();
+
+    this->file = fopen(filepath, "wb");
+    if (file == nullptr)
+    {
+        std::cout << "Failed to create NPY file: " << filepath << std::endl;
+        return false;
+    }
+
+    this->nCols = nCols;
+    this->rowsWritten = 0;
+
+    // the row count is patched on close
+    if (!writeHeader(0))
+    {
+        std::cout << "Failed to write NPY header: " << filepath << std::endl;
+        fclose(file);
+        this->file = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NpyWriter::write(const float* rows, uint64_t nRows)
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    size_t len = nRows * nCols;
+    size_t nWritten = fwrite(rows, sizeof(float), len, file);
+
+    this->rowsWritten += nWritten / nCols;
+
+    return nWritten == len;
+}
+
+
+bool NpyWriter::close()
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool isWritten = (fseek(file, 0, SEEK_SET) == 0) && writeHeader(rowsWritten);
+    isWritten = (fclose(file) == 0) && isWritten;
+
+    this->file = nullptr;
+
+    return isWritten;
+}
+
+
+bool NpyWriter::getIsOpen()
+{
+    return this->file != nullptr;
+}
+
+
+uint64_t NpyWriter::getRowsWritten()
+{
+    return this->rowsWritten;
+}
+
+
+bool NpyWriter::writeHeader(uint64_t nRows)
+{
+    char header[s_HEADER_SIZE];
+    memset(header, ' ', sizeof(header));
+
+    // little-endian float, as written by fwrite on the platforms we build for
+    int dictLen = snprintf(&header[s_PREAMBLE_SIZE],
+                           sizeof(header) - s_PREAMBLE_SIZE,
+                           "{'descr': '<f4', 'fortran_order': False, "
+                           "'shape': (%llu, %d), }",
+                           static_cast<unsigned long long>(nRows), nCols);
+
+    if (dictLen < 0 || s_PREAMBLE_SIZE + dictLen + 1 > sizeof(header))
+    {
+        return false;
+    }
+
+    // snprintf's terminator back to padding
+    header[s_PREAMBLE_SIZE + dictLen] = ' ';
+    header[sizeof(header) - 1] = '\n';
+
+    memcpy(header, "\x93NUMPY", 6);
+    header[6] = 1;
+    header[7] = 0;
+
+    uint16_t dictSize = static_cast<uint16_t>(sizeof(header) - s_PREAMBLE_SIZE);
+    header[8] = static_cast<char>(dictSize & 0xFF);
+    header[9] = static_cast<char>(dictSize >> 8);
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// Float-32 NumPy .npy matrix writer
+//
+// Rows are appended as they come and the row count in the header is patched
+// on close(). The header is padded to a fixed length so the patch never
+// moves the data, which starts at a 64-byte aligned offset and can be
+// mapped directly, e.g. numpy.load(path, mmap_mode="r").
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef NPY_WRITER_HPP
+#define NPY_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+
+class NpyWriter
+{
+public:
+    NpyWriter();
+    ~NpyWriter();
+
+    NpyWriter(const NpyWriter&) = delete;
+    NpyWriter& operator=(const NpyWriter&) = delete;
+
+    /// Create the file and write a header, closing the previous one
+    ///
+    /// \param nCols    length of every row
+    ///
+    /// \return         false if the file can't be created
+    ///
+    bool open(const char* filepath, int nCols);
+
+    /// Append rows of nCols floats
+    ///
+    /// \return     false on a write error
+    ///
+    bool write(const float* rows, uint64_t nRows);
+
+    /// Patch the header and close the file
+    ///
+    /// \return     false if nothing was open or the header can't be written
+    ///
+    bool close();
+
+    bool getIsOpen();
+
+    uint64_t getRowsWritten();
+
+private:
+    FILE* file;
+    int nCols;
+    uint64_t rowsWritten;
+
+    bool writeHeader(uint64_t nRows);
+};
+
+#endif
@@ -0,0 +1,396 @@
+#include "profiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// GL_EXT_disjoint_timer_query, not part of the generated glad loader
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+
+static const float s_NAN = std::numeric_limits<float>::quiet_NaN();
+
+Profiler::Profiler(void* (*loadProc)(const char*), int historyLen)
+    :   getQueryObjectui64v(nullptr),
+        gpuTimerAvailable(false),
+        activeQuery(nullptr),
+        historyLen(std::max(historyLen, 1)),
+        frame(-1),
+        frames(this->historyLen, -1)
+{
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+    {
+        cpuHistory[stage].assign(this->historyLen, s_NAN);
+        gpuHistory[stage].assign(this->historyLen, s_NAN);
+        nextQuery[stage] = 0;
+
+        for (int i = 0; i < s_QUERY_LATENCY; ++i)
+        {
+            queries[stage][i].query = 0;
+            queries[stage][i].frame = -1;
+        }
+    }
+
+    // look for the timer query extension
+    // -----------------------------------
+    if (loadProc != nullptr)
+    {
+        GLint numExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+
+        for (GLint i = 0; i < numExtensions; ++i)
+        {
+            const char* extension = reinterpret_cast<const char*>(
+                glGetStringi(GL_EXTENSIONS, i)
+            );
+
+            if (extension != nullptr &&
+                strcmp(extension, "GL_EXT_disjoint_timer_query") == 0)
+            {
+                // ES 3.0 has the core query functions, only the 64-bit
+                // result getter comes from the extension
+                this->getQueryObjectui64v = reinterpret_cast<getQueryObjectui64vProc>(
+                    loadProc("glGetQueryObjectui64vEXT")
+                );
+                break;
+            }
+        }
+    }
+
+    this->gpuTimerAvailable = (getQueryObjectui64v != nullptr);
+
+    if (gpuTimerAvailable)
+    {
+        for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+        {
+            for (int i = 0; i < s_QUERY_LATENCY; ++i)
+            {
+                glGenQueries(1, &queries[stage][i].query);
+            }
+        }
+
+        // clear the disjoint flag
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    }
+    else
+    {
+        std::cout << "Profiler: GL_EXT_disjoint_timer_query not available, "
+                  << "CPU timing only" << std::endl;
+    }
+}
+
+
+Profiler::~Profiler()
+{
+    if (gpuTimerAvailable)
+    {
+        for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+        {
+            for (int i = 0; i < s_QUERY_LATENCY; ++i)
+            {
+                glDeleteQueries(1, &queries[stage][i].query);
+            }
+        }
+    }
+}
+
+
+void Profiler::beginFrame()
+{
+    ++frame;
+
+    // recycle the oldest slot of the history
+    int slot = getSlot(frame);
+    frames[slot] = frame;
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+    {
+        cpuHistory[stage][slot] = s_NAN;
+        gpuHistory[stage][slot] = s_NAN;
+    }
+
+    collectQueries();
+}
+
+
+void Profiler::endFrame()
+{
+    // make sure no query is left open, e.g. a stage skipped with continue
+    if (activeQuery != nullptr)
+    {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        activeQuery->frame = -1; // discard, the time is meaningless
+        activeQuery = nullptr;
+    }
+}
+
+
+void Profiler::beginStage(profilerStage stage)
+{
+    if (gpuTimerAvailable && getStageHasGpuWork(stage))
+    {
+        PendingQuery& query = queries[stage][nextQuery[stage]];
+
+        if (query.frame < 0)
+        {
+            glBeginQuery(GL_TIME_ELAPSED_EXT, query.query);
+            query.frame = frame;
+            this->activeQuery = &query;
+            this->nextQuery[stage] = (nextQuery[stage] + 1) % s_QUERY_LATENCY;
+        }
+        else
+        {
+            // every query is still in flight, skip rather than stall
+        }
+    }
+
+    this->stageStart = std::chrono::steady_clock::now();
+}
+
+
+void Profiler::endStage(profilerStage stage)
+{
+    auto stageEnd = std::chrono::steady_clock::now();
+
+    if (activeQuery != nullptr)
+    {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        this->activeQuery = nullptr;
+    }
+
+    std::chrono::duration<float, std::milli> elapsed = stageEnd - stageStart;
+    cpuHistory[stage][getSlot(frame)] = elapsed.count();
+}
+
+
+bool Profiler::getGpuTimerAvailable()
+{
+    return gpuTimerAvailable;
+}
+
+
+profilerStats Profiler::getStats(profilerStage stage, bool gpu)
+{
+    const std::vector<float>& history = gpu ? gpuHistory[stage]
+                                            : cpuHistory[stage];
+
+    std::vector<float> samples;
+    samples.reserve(historyLen);
+    for (float ms : history)
+    {
+        if (!std::isnan(ms))
+        {
+            samples.push_back(ms);
+        }
+    }
+
+    profilerStats stats = {s_NAN, s_NAN, s_NAN, 0};
+    stats.numSamples = static_cast<int>(samples.size());
+
+    if (samples.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    float sum = 0.0f;
+    for (float ms : samples)
+    {
+        sum += ms;
+    }
+
+    // nearest-rank percentile
+    int p99Rank = static_cast<int>(std::ceil(0.99 * samples.size())) - 1;
+
+    stats.minMs = samples.front();
+    stats.meanMs = sum / samples.size();
+    stats.p99Ms = samples[std::max(p99Rank, 0)];
+
+    return stats;
+}
+
+
+float Profiler::getLatestGpuFrameMs()
+{
+    for (int k = 0; k < historyLen; ++k)
+    {
+        long long f = frame - k;
+        if (f < 0 || frames[getSlot(f)] != f)
+        {
+            break;
+        }
+
+        int slot = getSlot(f);
+        bool complete = true;
+        bool any = false;
+        float sum = 0.0f;
+
+        for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+        {
+            // only stages which ran on that frame
+            if (!getStageHasGpuWork(static_cast<profilerStage>(stage)) ||
+                std::isnan(cpuHistory[stage][slot]))
+            {
+                continue;
+            }
+
+            if (std::isnan(gpuHistory[stage][slot]))
+            {
+                complete = false;
+                break;
+            }
+
+            sum += gpuHistory[stage][slot];
+            any = true;
+        }
+
+        if (complete && any)
+        {
+            return sum;
+        }
+    }
+
+    return s_NAN;
+}
+
+
+const float* Profiler::getHistory(profilerStage stage, bool gpu)
+{
+    return gpu ? gpuHistory[stage].data() : cpuHistory[stage].data();
+}
+
+
+int Profiler::getHistoryLen()
+{
+    return historyLen;
+}
+
+
+int Profiler::getHistoryOffset()
+{
+    return getSlot(frame + 1);
+}
+
+
+bool Profiler::exportCSV(const char* filepath)
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        std::cout << "Profiler: failed to open " << filepath << std::endl;
+        return false;
+    }
+
+    // header
+    file << "frame";
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+    {
+        const char* name = getStageName(static_cast<profilerStage>(stage));
+        file << "," << name << " CPU (ms)," << name << " GPU (ms)";
+    }
+    file << "\n";
+
+    // oldest to newest, empty field where there is no sample
+    for (int k = 0; k < historyLen; ++k)
+    {
+        int slot = (getHistoryOffset() + k) % historyLen;
+        if (frames[slot] < 0)
+        {
+            continue;
+        }
+
+        file << frames[slot];
+        for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+        {
+            file << ",";
+            if (!std::isnan(cpuHistory[stage][slot]))
+            {
+                file << cpuHistory[stage][slot];
+            }
+
+            file << ",";
+            if (!std::isnan(gpuHistory[stage][slot]))
+            {
+                file << gpuHistory[stage][slot];
+            }
+        }
+        file << "\n";
+    }
+
+    return true;
+}
+
+
+const char* Profiler::getStageName(profilerStage stage)
+{
+    switch (stage)
+    {
+        case PROFILER_DSP:          return "DSP";
+        case PROFILER_Z_UPLOAD:     return "Z Upload";
+        case PROFILER_GRID_DRAW:    return "Grid Draw";
+        case PROFILER_FRAMEBUFFER:  return "Framebuffer";
+        case PROFILER_IMGUI:        return "ImGui";
+        case PROFILER_SWAP:         return "Swap";
+        default:                    return "Unknown";
+    }
+}
+
+
+bool Profiler::getStageHasGpuWork(profilerStage stage)
+{
+    return stage != PROFILER_DSP && stage != PROFILER_SWAP;
+}
+
+
+void Profiler::collectQueries()
+{
+    if (!gpuTimerAvailable)
+    {
+        return;
+    }
+
+    // results are garbage if the GPU was disjoint (e.g. power management)
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    for (int stage = 0; stage < PROFILER_NUM_STAGES; ++stage)
+    {
+        for (int i = 0; i < s_QUERY_LATENCY; ++i)
+        {
+            PendingQuery& query = queries[stage][i];
+            if (query.frame < 0)
+            {
+                continue;
+            }
+
+            GLuint available = 0;
+            glGetQueryObjectuiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                continue;
+            }
+
+            GLuint64 elapsedNs = 0;
+            getQueryObjectui64v(query.query, GL_QUERY_RESULT, &elapsedNs);
+
+            // store in the slot of the frame which issued the query,
+            // unless that frame already left the history
+            if (!disjoint && frame - query.frame < historyLen)
+            {
+                gpuHistory[stage][getSlot(query.frame)] = elapsedNs * 1e-6f;
+            }
+
+            query.frame = -1;
+        }
+    }
+}
+
+
+int Profiler::getSlot(long long frame)
+{
+    return static_cast<int>(frame % historyLen);
+}
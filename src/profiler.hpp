@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+// Profiler class for timing the stages of the render loop
+//
+// CPU time is measured with std::chrono::steady_clock, GPU time with
+// GL_EXT_disjoint_timer_query when the driver exposes it. GPU results are
+// read back a few frames late without stalling the pipeline, and are
+// stored in the history slot of the frame which issued them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <chrono>
+
+/// Render loop stages, the stages must not overlap
+/// (timer queries can't be nested)
+///
+typedef enum {
+    PROFILER_DSP,           /// audio copy, FFT, dB and smoothing (CPU only)
+    PROFILER_Z_UPLOAD,      /// z buffer upload, Grid::zSubAllData
+    PROFILER_GRID_DRAW,     /// scene framebuffer clear and Grid::draw
+    PROFILER_FRAMEBUFFER,   /// scene framebuffer resolve and window clear
+    PROFILER_IMGUI,         /// ImGui frame and render
+    PROFILER_SWAP,          /// SDL_GL_SwapWindow, includes V-Sync (CPU only)
+    PROFILER_NUM_STAGES
+} profilerStage;
+
+
+/// Rolling statistics of a stage in milliseconds, NaN if there is no sample
+///
+typedef struct {
+    float minMs;
+    float meanMs;
+    float p99Ms;
+    int numSamples;
+} profilerStats;
+
+
+class Profiler
+{
+public:
+    /// \param loadProc     OpenGL function loader for the timer query
+    ///                     extension, e.g. SDL_GL_GetProcAddress,
+    ///                     nullptr disables GPU timing
+    ///
+    /// \param historyLen   number of frames kept for the statistics,
+    ///                     defaulted to 240
+    ///
+    Profiler(void* (*loadProc)(const char*), int historyLen = 240);
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /// Start a new frame, collects GPU results which became available
+    ///
+    void beginFrame();
+
+    /// Finish the current frame
+    ///
+    void endFrame();
+
+    /// Start timing a stage, call endStage() before starting another one
+    ///
+    void beginStage(profilerStage stage);
+
+    void endStage(profilerStage stage);
+
+    /// \return     whether GPU timer queries are supported by the driver
+    ///
+    bool getGpuTimerAvailable();
+
+    /// \param gpu  GPU time if true, otherwise CPU time
+    ///
+    /// \return     rolling statistics over the history
+    ///
+    profilerStats getStats(profilerStage stage, bool gpu);
+
+    /// \return     GPU time of the most recent frame with results for every
+    ///             GPU stage, in milliseconds, NaN if unavailable
+    ///
+    float getLatestGpuFrameMs();
+
+    /// History ring buffer, NaN where a stage was skipped, for plotting
+    ///
+    /// \param gpu  GPU time if true, otherwise CPU time
+    ///
+    /// \return     pointer to the history, len = getHistoryLen()
+    ///
+    const float* getHistory(profilerStage stage, bool gpu);
+
+    int getHistoryLen();
+
+    /// \return     index of the oldest entry in the history ring buffer
+    ///
+    int getHistoryOffset();
+
+    /// Write the history to a CSV file, one row per frame
+    ///
+    /// \return     whether the file was written
+    ///
+    bool exportCSV(const char* filepath);
+
+    /// \return     display name of the stage
+    ///
+    static const char* getStageName(profilerStage stage);
+
+    /// \return     whether the stage has GPU work to measure
+    ///
+    static bool getStageHasGpuWork(profilerStage stage);
+
+private:
+    // queries in flight per stage, results are read this many frames late
+    static constexpr int s_QUERY_LATENCY = 4;
+
+    typedef void (APIENTRYP getQueryObjectui64vProc)(GLuint, GLenum, GLuint64*);
+    getQueryObjectui64vProc getQueryObjectui64v;
+
+    bool gpuTimerAvailable;
+
+    struct PendingQuery {
+        GLuint query;
+        long long frame;    // frame which issued the query, -1 if free
+    };
+    PendingQuery queries[PROFILER_NUM_STAGES][s_QUERY_LATENCY];
+    int nextQuery[PROFILER_NUM_STAGES];
+    PendingQuery* activeQuery;
+
+    // history, indexed by frame % historyLen
+    int historyLen;
+    long long frame;
+    std::vector<long long> frames;
+    std::vector<float> cpuHistory[PROFILER_NUM_STAGES];
+    std::vector<float> gpuHistory[PROFILER_NUM_STAGES];
+
+    std::chrono::steady_clock::time_point stageStart;
+
+    /// Read back finished queries without blocking
+    void collectQueries();
+
+    int getSlot(long long frame);
+};
+
+#endif
@@ -0,0 +1,234 @@
+#include "quantize.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUANTIZE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Half float conversions after Fabian Giesen's float_to_half_fast3_rtne
+// and half_to_float_fast5 (public domain)
+// https://gist.github.com/rygorous/2156668
+
+static uint32_t s_floatBits(float value);
+static float s_bitsFloat(uint32_t bits);
+
+static uint16_t s_floatToUnorm16(float value);
+
+#ifdef QUANTIZE_SSE2
+static __m128i s_floatToHalfSSE2(__m128 value);
+#endif
+
+
+void quantizeFloatToUnorm16(uint16_t* dst, const float* src, const int len)
+{
+    int i = 0;
+
+#ifdef QUANTIZE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    for (; i + 8 <= len; i += 8)
+    {
+        // max returns the 2nd operand on NaN, so NaN becomes 0
+        __m128 v0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), zero), one);
+        __m128 v1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i + 4]), zero), one);
+
+        // round to nearest even (default MXCSR)
+        __m128i q0 = _mm_cvtps_epi32(_mm_mul_ps(v0, scale));
+        __m128i q1 = _mm_cvtps_epi32(_mm_mul_ps(v1, scale));
+
+        // SSE2 only has a signed saturating pack, shift to signed and back
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(q0, bias32),
+                                         _mm_sub_epi32(q1, bias32));
+        packed = _mm_xor_si128(packed, bias16);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), packed);
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        dst[i] = s_floatToUnorm16(src[i]);
+    }
+}
+
+
+void quantizeUnorm16ToFloat(float* dst, const uint16_t* src, const int len)
+{
+    const float scale = 1.0f / 65535.0f;
+
+    for (int i = 0; i < len; ++i)
+    {
+        dst[i] = src[i] * scale;
+    }
+}
+
+
+void quantizeFloatToHalf(uint16_t* dst, const float* src, const int len)
+{
+    int i = 0;
+
+#ifdef QUANTIZE_SSE2
+    for (; i + 8 <= len; i += 8)
+    {
+        __m128i h0 = s_floatToHalfSSE2(_mm_loadu_ps(&src[i]));
+        __m128i h1 = s_floatToHalfSSE2(_mm_loadu_ps(&src[i + 4]));
+
+        // positive halfs fit in 15 bits, negative ones are sign extended,
+        // so the signed saturating pack keeps every value
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]),
+                         _mm_packs_epi32(h0, h1));
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        dst[i] = quantizeFloatToHalfValue(src[i]);
+    }
+}
+
+
+void quantizeHalfToFloat(float* dst, const uint16_t* src, const int len)
+{
+    for (int i = 0; i < len; ++i)
+    {
+        dst[i] = quantizeHalfToFloatValue(src[i]);
+    }
+}
+
+
+uint16_t quantizeFloatToHalfValue(const float value)
+{
+    const uint32_t f32Infinity = 255u << 23;
+    const uint32_t f16Max = (127u + 16u) << 23;
+    const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+    const uint32_t minNormal = (127u - 14u) << 23;
+
+    uint32_t bits = s_floatBits(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+
+    if (bits >= f16Max)
+    {
+        // overflow to infinity, NaN to quiet NaN
+        half = (bits > f32Infinity) ? 0x7E00u : 0x7C00u;
+    }
+    else if (bits < minNormal)
+    {
+        // subnormal or zero, let the FPU round the mantissa
+        float rounded = s_bitsFloat(bits) + s_bitsFloat(denormMagic);
+        half = s_floatBits(rounded) - denormMagic;
+    }
+    else
+    {
+        // normal, rebias the exponent and round to nearest even
+        uint32_t mantissaOdd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xFFFu;
+        bits += mantissaOdd;
+        half = bits >> 13;
+    }
+
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+
+float quantizeHalfToFloatValue(const uint16_t value)
+{
+    const uint32_t shiftedExponent = 0x7C00u << 13;
+    const float magic = s_bitsFloat(113u << 23);
+
+    uint32_t bits = (value & 0x7FFFu) << 13;
+    uint32_t exponent = bits & shiftedExponent;
+    bits += (127u - 15u) << 23;
+
+    if (exponent == shiftedExponent)
+    {
+        // infinity or NaN
+        bits += (128u - 16u) << 23;
+    }
+    else if (exponent == 0)
+    {
+        // zero or subnormal, renormalize
+        bits += 1u << 23;
+        bits = s_floatBits(s_bitsFloat(bits) - magic);
+    }
+
+    return s_bitsFloat(bits | (static_cast<uint32_t>(value & 0x8000u) << 16));
+}
+
+
+uint32_t s_floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+float s_bitsFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+uint16_t s_floatToUnorm16(float value)
+{
+    // written so NaN fails both comparisons and becomes 0
+    value = (value > 0.0f) ? value : 0.0f;
+    value = (value < 1.0f) ? value : 1.0f;
+
+    // round to nearest even, like _mm_cvtps_epi32
+    return static_cast<uint16_t>(std::nearbyint(value * 65535.0f));
+}
+
+
+#ifdef QUANTIZE_SSE2
+__m128i s_floatToHalfSSE2(__m128 value)
+{
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7C00);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000u));
+
+    __m128 sign = _mm_and_ps(signMask, value);
+    __m128 absValue = _mm_xor_ps(value, sign);
+    __m128i absBits = _mm_castps_si128(absValue);
+
+    // infinity or NaN
+    __m128 isNaN = _mm_cmpunord_ps(absValue, absValue);
+    __m128i isRegular = _mm_cmpgt_epi32(f16Max, absBits);
+    __m128i special = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNaN), nanBit),
+                                   infinity);
+
+    // subnormal, let the FPU round the mantissa
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absBits);
+    __m128 subnormalRounded = _mm_add_ps(absValue, _mm_castsi128_ps(denormMagic));
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalRounded), denormMagic);
+
+    // normal, rebias the exponent and round to nearest even
+    __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+    __m128i normal = _mm_add_epi32(absBits, normalBias);
+    normal = _mm_srli_epi32(_mm_sub_epi32(normal, mantissaOdd), 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal),
+                                  _mm_andnot_si128(isSubnormal, normal));
+    __m128i half = _mm_or_si128(_mm_and_si128(isRegular, finite),
+                                _mm_andnot_si128(isRegular, special));
+
+    // sign extended, keeps the 32-bit lanes in the signed 16-bit range
+    return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+#endif
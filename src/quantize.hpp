@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+// Library for quantizing float arrays to 16-bit storage
+//
+// Used to store the spectrogram history as 16-bit unsigned normalized
+// integers or half floats, on the CPU and in the GPU z buffer
+// (GL_UNSIGNED_SHORT normalized / GL_HALF_FLOAT vertex attributes).
+//
+// The array conversions use SSE2 when available (x86-64 always has it),
+// with a scalar fallback giving identical results.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef QUANTIZE_HPP
+#define QUANTIZE_HPP
+
+#include <cstdint>
+
+/// Float to 16-bit unsigned normalized integer, clamped to [0, 1],
+/// round to nearest even, NaN becomes 0
+///
+/// \param dst      output array (array must have a length of len)
+///
+/// \param src      input array (array must have a length of len)
+///
+/// \param len      number of elements
+///
+void quantizeFloatToUnorm16(uint16_t* dst, const float* src, const int len);
+
+
+/// 16-bit unsigned normalized integer to float in [0, 1]
+///
+void quantizeUnorm16ToFloat(float* dst, const uint16_t* src, const int len);
+
+
+/// Float to IEEE 754 half float, round to nearest even,
+/// overflow becomes infinity, NaN stays NaN
+///
+/// \param dst      output array (array must have a length of len)
+///
+/// \param src      input array (array must have a length of len)
+///
+/// \param len      number of elements
+///
+void quantizeFloatToHalf(uint16_t* dst, const float* src, const int len);
+
+
+/// IEEE 754 half float to float, exact
+///
+void quantizeHalfToFloat(float* dst, const uint16_t* src, const int len);
+
+
+/// Scalar float to half float, same result as quantizeFloatToHalf()
+///
+uint16_t quantizeFloatToHalfValue(const float value);
+
+
+/// Scalar half float to float
+///
+float quantizeHalfToFloatValue(const uint16_t value);
+
+#endif
@@ -0,0 +1,407 @@
+#include "resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+#include "channel_mix.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+// taps of the filter without downsampling, multiplied by the ratio otherwise
+static constexpr int s_BASE_TAPS = 64;
+
+// -6 dB point as a fraction of the lower Nyquist, and the Kaiser window
+// shape, about 80 dB of stopband
+static constexpr double s_CUTOFF = 0.9;
+static constexpr double s_KAISER_BETA = 8.0;
+
+static constexpr double s_PI = 3.14159265358979323846;
+
+/// Zeroth order modified Bessel function of the first kind
+static double s_besselI0(double x);
+
+/// \return     sum of x[i] * h[i], n must be a multiple of 8
+static float s_dot(const float* x, const float* h, int n);
+
+
+Resampler::Resampler()
+    :   channels(0),
+        inRate(0),
+        outRate(0),
+        nPhases(1),
+        step(1),
+        nTaps(0),
+        reservedFrames(0),
+        bufferStart(0),
+        outFrame(0)
+{
+
+}
+
+
+bool Resampler::init(int channels, int inRate, int outRate)
+{
+    if (channels <= 0 || inRate <= 0 || outRate <= 0)
+    {
+        std::cout << "Resampler: invalid format, " << channels << " channels, "
+                  << inRate << " Hz to " << outRate << " Hz" << std::endl;
+        return false;
+    }
+
+    if (channels != this->channels
+        || inRate != this->inRate
+        || outRate != this->outRate)
+    {
+        this->channels = channels;
+        this->inRate = inRate;
+        this->outRate = outRate;
+
+        int divisor = std::gcd(inRate, outRate);
+        this->nPhases = outRate / divisor;
+        this->step = inRate / divisor;
+
+        // e.g. 44100 to 44101 Hz, the rate is off by less than 1/2048
+        if (nPhases > s_MAX_PHASES)
+        {
+            this->step = std::max(1, static_cast<int>(std::lround(
+                static_cast<double>(step) * s_MAX_PHASES / nPhases)));
+            this->nPhases = s_MAX_PHASES;
+        }
+
+        this->buildFilter();
+        this->history.assign(channels, std::vector<float>());
+
+        // the filter length changed
+        this->reserve(reservedFrames);
+    }
+
+    this->reset();
+
+    return true;
+}
+
+
+void Resampler::reserve(int maxInFrames)
+{
+    this->reservedFrames = std::max(maxInFrames, 0);
+
+    if (reservedFrames == 0)
+    {
+        return;
+    }
+
+    // less than a filter is carried between chunks, then the chunk
+    for (std::vector<float>& row : history)
+    {
+        row.reserve(static_cast<size_t>(nTaps) + reservedFrames);
+    }
+}
+
+
+int Resampler::getHistoryCapacity()
+{
+    return history.empty() ? 0 : static_cast<int>(history[0].capacity());
+}
+
+
+void Resampler::reset(uint64_t outFrame)
+{
+    this->outFrame = outFrame;
+
+    if (this->getIsPassthrough())
+    {
+        return;
+    }
+
+    this->bufferStart = windowStart(outFrame);
+
+    // the stream is silent before its first frame
+    size_t nZeros = (bufferStart < 0) ? static_cast<size_t>(-bufferStart) : 0;
+
+    // assign() keeps the capacity reserved
+    for (std::vector<float>& row : history)
+    {
+        row.assign(nZeros, 0.0f);
+    }
+}
+
+
+uint64_t Resampler::getNextInputFrame()
+{
+    if (this->getIsPassthrough())
+    {
+        return this->outFrame;
+    }
+
+    return static_cast<uint64_t>(bufferStart + static_cast<int64_t>(history[0].size()));
+}
+
+
+int Resampler::process(const float* in, int nInFrames, float* out)
+{
+    if (channels == 0)
+    {
+        return 0;
+    }
+
+    if (this->getIsPassthrough())
+    {
+        memcpy(out, in, nInFrames * channels * sizeof(float));
+        this->outFrame += nInFrames;
+        return nInFrames;
+    }
+
+    // planar, so each dot product runs along contiguous memory
+    size_t historyLen = history[0].size();
+
+    for (int c = 0; c < channels; ++c)
+    {
+        history[c].resize(historyLen + nInFrames);
+        channelMixExtract(&history[c][historyLen], in, nInFrames, channels, c);
+    }
+    historyLen += nInFrames;
+
+    int nOut = 0;
+
+    while (true)
+    {
+        int64_t start = windowStart(outFrame) - bufferStart;
+        if (start + nTaps > static_cast<int64_t>(historyLen))
+        {
+            break;
+        }
+
+        int phase = static_cast<int>((outFrame * step) % nPhases);
+        const float* h = &coefs[phase * nTaps];
+
+        for (int c = 0; c < channels; ++c)
+        {
+            out[nOut * channels + c] = s_dot(&history[c][start], h, nTaps);
+        }
+
+        ++outFrame;
+        ++nOut;
+    }
+
+    // keep from the window of the next output frame on
+    int64_t nDropped = std::min(windowStart(outFrame) - bufferStart,
+                                static_cast<int64_t>(historyLen));
+    if (nDropped > 0)
+    {
+        for (std::vector<float>& row : history)
+        {
+            row.erase(row.begin(), row.begin() + nDropped);
+        }
+        this->bufferStart += nDropped;
+    }
+
+    return nOut;
+}
+
+
+int Resampler::getMaxOutputFrames(int nInFrames)
+{
+    if (this->getIsPassthrough() || channels == 0)
+    {
+        return nInFrames;
+    }
+
+    int64_t nFrames = static_cast<int64_t>(history[0].size()) + nInFrames;
+
+    return static_cast<int>(nFrames * nPhases / step + 1);
+}
+
+
+bool Resampler::resampleBlock(const float* in, int nInFrames, float* out, int nOutFrames)
+{
+    if (nInFrames < this->getBlockInputFrames(nOutFrames) || channels == 0)
+    {
+        return false;
+    }
+
+    if (this->getIsPassthrough())
+    {
+        memcpy(out,
+               &in[(nInFrames - nOutFrames) * channels],
+               nOutFrames * channels * sizeof(float));
+        return true;
+    }
+
+    this->reset();
+    blockOut.resize(static_cast<size_t>(getMaxOutputFrames(nInFrames)) * channels);
+
+    int nOut = this->process(in, nInFrames, blockOut.data());
+
+    memcpy(out,
+           &blockOut[(nOut - nOutFrames) * channels],
+           nOutFrames * channels * sizeof(float));
+
+    this->reset();
+
+    return true;
+}
+
+
+int Resampler::getBlockInputFrames(int nOutFrames)
+{
+    if (this->getIsPassthrough())
+    {
+        return nOutFrames;
+    }
+
+    // first output frame whose window doesn't reach before the block
+    int64_t firstFrame = ((nTaps / 2 - 1) * static_cast<int64_t>(nPhases) + step - 1) / step;
+    int64_t lastFrame = firstFrame + nOutFrames - 1;
+
+    return static_cast<int>(lastFrame * step / nPhases + nTaps / 2 + 1);
+}
+
+
+int Resampler::getChannels()
+{
+    return this->channels;
+}
+
+
+int Resampler::getInRate()
+{
+    return this->inRate;
+}
+
+
+int Resampler::getOutRate()
+{
+    return this->outRate;
+}
+
+
+int Resampler::getNumTaps()
+{
+    return this->nTaps;
+}
+
+
+bool Resampler::getIsPassthrough()
+{
+    return this->inRate == this->outRate;
+}
+
+
+void Resampler::buildFilter()
+{
+    if (this->getIsPassthrough())
+    {
+        this->nTaps = 0;
+        std::vector<float>().swap(coefs);
+        return;
+    }
+
+    // below both Nyquist frequencies, relative to the input one
+    double ratio = std::min(1.0, static_cast<double>(nPhases) / step);
+    double cutoff = s_CUTOFF * ratio;
+
+    // same transition width in output frames, a multiple of 8 for s_dot
+    this->nTaps = static_cast<int>(std::ceil(s_BASE_TAPS / ratio / 8.0)) * 8;
+
+    coefs.resize(static_cast<size_t>(nPhases) * nTaps);
+
+    const double halfLen = nTaps / 2.0;
+    const double i0Beta = s_besselI0(s_KAISER_BETA);
+
+    for (int phase = 0; phase < nPhases; ++phase)
+    {
+        float* row = &coefs[phase * nTaps];
+        double sum = 0.0;
+
+        for (int j = 0; j < nTaps; ++j)
+        {
+            // time from the output frame to input frame j of its window,
+            // in input frames
+            double t = (nTaps - 1 - j) - halfLen
+                       + static_cast<double>(phase) / nPhases;
+
+            double x = cutoff * t;
+            double sinc = (x == 0.0) ? 1.0 : std::sin(s_PI * x) / (s_PI * x);
+
+            double r = t / halfLen;
+            double window = s_besselI0(s_KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r)))
+                            / i0Beta;
+
+            row[j] = static_cast<float>(cutoff * sinc * window);
+            sum += row[j];
+        }
+
+        // unity gain at DC for every phase
+        for (int j = 0; j < nTaps; ++j)
+        {
+            row[j] = static_cast<float>(row[j] / sum);
+        }
+    }
+}
+
+
+int64_t Resampler::windowStart(uint64_t frame)
+{
+    // the window is centred on the input time of the output frame
+    int64_t inFrame = static_cast<int64_t>(frame * step / nPhases);
+
+    return inFrame - nTaps / 2 + 1;
+}
+
+
+double s_besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+
+        if (term < sum * 1e-12)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+
+float s_dot(const float* x, const float* h, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+
+#ifdef RESAMPLER_SSE2
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&x[i]),
+                                           _mm_loadu_ps(&h[i])));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&x[i + 4]),
+                                           _mm_loadu_ps(&h[i + 4])));
+    }
+
+    // horizontal sum
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#endif
+
+    for (; i < n; ++i)
+    {
+        sum += x[i] * h[i];
+    }
+    return sum;
+}
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+// Polyphase windowed-sinc sample rate converter
+//
+// The rate ratio is reduced to outRate/inRate = L/M, and the Kaiser windowed
+// sinc low-pass is stored as L phases of nTaps coefficients. Each output
+// frame is then a single dot product per channel with the phase it falls on,
+// done with SSE2 when available. Downsampling lowers the cutoff below the
+// output Nyquist and widens the filter to match.
+//
+// Input is fed in chunks of any size and the filter history is carried
+// between them, so a stream can be converted piece by piece. Ratios that
+// reduce to more than s_MAX_PHASES phases are rounded to that many phases.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstdint>
+#include <vector>
+
+class Resampler
+{
+public:
+    Resampler();
+
+    /// Build the filter for the rates, kept if they didn't change,
+    /// the stream starts over either way
+    ///
+    /// \param channels     number of interleaved channels
+    ///
+    /// \param inRate       input sample rate in Hz
+    ///
+    /// \param outRate      output sample rate in Hz
+    ///
+    /// \return             false if any of them is not positive
+    ///
+    bool init(int channels, int inRate, int outRate);
+
+    /// Make room in the history for process() chunks up to a size, so
+    /// they don't allocate, e.g. in an audio callback. Kept through
+    /// init() and reset().
+    ///
+    /// \param maxInFrames  largest nInFrames passed to process()
+    ///
+    void reserve(int maxInFrames);
+
+    /// \return     input frames the history holds without allocating
+    ///
+    int getHistoryCapacity();
+
+
+    /// Forget the history and start the stream at an output frame,
+    /// e.g. after a seek. Input frames before 0 are taken as zeros.
+    ///
+    /// \param outFrame     index of the next output frame
+    ///
+    void reset(uint64_t outFrame = 0);
+
+    /// \return     index of the input frame the next process() call starts at
+    ///
+    uint64_t getNextInputFrame();
+
+
+    /// Resample the next chunk of the stream, output frames need the input
+    /// up to half the filter ahead, the rest comes with the next chunk
+    ///
+    /// \param in           interleaved input
+    ///                     (array must have a length of nInFrames * channels)
+    ///
+    /// \param nInFrames    number of input frames
+    ///
+    /// \param out          interleaved output
+    ///                     (array must have a length of
+    ///                     getMaxOutputFrames(nInFrames) * channels)
+    ///
+    /// \return             number of output frames written
+    ///
+    int process(const float* in, int nInFrames, float* out);
+
+    /// \return     most frames process() writes for nInFrames of input
+    ///
+    int getMaxOutputFrames(int nInFrames);
+
+
+    /// Resample a block on its own, ignoring and discarding the stream,
+    /// for windows taken out of a signal (e.g. the FFT input)
+    ///
+    /// \param in           interleaved input
+    ///                     (array must have a length of nInFrames * channels)
+    ///
+    /// \param nInFrames    at least getBlockInputFrames(nOutFrames)
+    ///
+    /// \param out          the last nOutFrames frames of the block
+    ///                     (array must have a length of nOutFrames * channels)
+    ///
+    /// \return             false if nInFrames is too short
+    ///
+    bool resampleBlock(const float* in, int nInFrames, float* out, int nOutFrames);
+
+    /// \return     input frames for nOutFrames of output in resampleBlock
+    ///             that don't reach before the block
+    ///
+    int getBlockInputFrames(int nOutFrames);
+
+
+    int getChannels();
+    int getInRate();
+    int getOutRate();
+
+    /// \return     number of coefficients per phase
+    ///
+    int getNumTaps();
+
+    /// \return     whether the rates are the same and frames are copied
+    ///
+    bool getIsPassthrough();
+
+private:
+    static constexpr int s_MAX_PHASES = 1024;
+
+    int channels;
+    int inRate, outRate;
+
+    // outRate/inRate = nPhases/step
+    int nPhases;
+    int step;
+    int nTaps;
+
+    // nPhases rows of nTaps, each row reversed to run along the input
+    std::vector<float> coefs;
+
+    // planar input from bufferStart on, one row per channel
+    std::vector<std::vector<float>> history;
+    int reservedFrames;
+    int64_t bufferStart;
+    uint64_t outFrame;
+
+    // output of resampleBlock before the last frames are copied
+    std::vector<float> blockOut;
+
+    void buildFilter();
+
+    /// \return     index of the first input frame of the output frame
+    int64_t windowStart(uint64_t frame);
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "ring_followers.hpp"
+
+#include <algorithm>
+
+
+RingFollowers::RingFollowers(int maxHistorySec)
+    :   maxHistorySec(std::max(maxHistorySec, 0)),
+        savingMaxFileSec(0),
+        savingMaxFileMB(0),
+        channels(0),
+        sampleRate(0),
+        isHistorySuspended(false),
+        isSavingSuspended(false)
+{
+
+}
+
+
+bool RingFollowers::startHistory(SampleRing* ring, int channels, int sampleRate)
+{
+    if (maxHistorySec == 0 || history.getIsRunning())
+    {
+        return true;
+    }
+
+    this->setFormat(channels, sampleRate);
+
+    uint64_t maxHistorySamples =   static_cast<uint64_t>(sampleRate)
+                                 * maxHistorySec
+                                 * channels;
+
+    return history.start(ring, channels, maxHistorySamples);
+}
+
+
+bool RingFollowers::startSaving(SampleRing* ring, int channels, int sampleRate,
+                                const char* folderPath, int maxFileSec, int maxFileMB)
+{
+    // kept to start again after suspend()
+    this->savingFolder = folderPath;
+    this->savingMaxFileSec = maxFileSec;
+    this->savingMaxFileMB = maxFileMB;
+
+    return recorder.start(ring, channels, sampleRate, folderPath, maxFileSec,
+                          static_cast<uint64_t>(maxFileMB) << 20);
+}
+
+
+void RingFollowers::stopSaving()
+{
+    recorder.stop();
+    this->isSavingSuspended = false;
+}
+
+
+void RingFollowers::stop()
+{
+    recorder.stop();
+    history.stop();
+    this->isSavingSuspended = false;
+    this->isHistorySuspended = false;
+}
+
+
+void RingFollowers::clearHistory()
+{
+    history.clear();
+}
+
+
+void RingFollowers::suspend()
+{
+    // suspended twice, the first one counts
+    this->isHistorySuspended = isHistorySuspended || history.getIsRunning();
+    this->isSavingSuspended = isSavingSuspended || recorder.getIsRecording();
+
+    // the followers take what was published before the ring goes
+    history.stop();
+    recorder.stop();
+}
+
+
+void RingFollowers::resume(SampleRing* ring, int channels, int sampleRate)
+{
+    this->setFormat(channels, sampleRate);
+
+    if (isHistorySuspended)
+    {
+        this->isHistorySuspended = false;
+        this->startHistory(ring, channels, sampleRate);
+    }
+
+    if (isSavingSuspended)
+    {
+        this->isSavingSuspended = false;
+        recorder.start(ring, channels, sampleRate, savingFolder.c_str(),
+                       savingMaxFileSec,
+                       static_cast<uint64_t>(savingMaxFileMB) << 20);
+    }
+}
+
+
+bool RingFollowers::getIsFollowing()
+{
+    return    history.getIsRunning() || recorder.getIsRecording()
+           || isHistorySuspended || isSavingSuspended;
+}
+
+
+int RingFollowers::getMaxHistorySec()
+{
+    return maxHistorySec;
+}
+
+
+SampleHistory& RingFollowers::getHistory()
+{
+    return history;
+}
+
+
+CaptureRecorder& RingFollowers::getRecorder()
+{
+    return recorder;
+}
+
+
+void RingFollowers::setFormat(int channels, int sampleRate)
+{
+    // the samples kept wouldn't play at the new rate or line up in frames
+    if (channels != this->channels || sampleRate != this->sampleRate)
+    {
+        history.clear();
+    }
+
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+}
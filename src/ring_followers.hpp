@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+// RingFollowers class for the threads that follow a capture SampleRing
+//
+// A SampleHistory and a CaptureRecorder each follow the ring's write counter
+// from their own thread. Whenever the ring is reset, e.g. grown or the
+// device reopened with another block size, they have to stop and start
+// again on it. suspend() and resume() do that, saving goes on in a new set
+// of files and the history is kept as long as the format stays the same.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RING_FOLLOWERS_HPP
+#define RING_FOLLOWERS_HPP
+
+#include <string>
+
+#include "sample_ring.hpp"
+#include "sample_history.hpp"
+#include "capture_recorder.hpp"
+
+class RingFollowers
+{
+public:
+    /// \param maxHistorySec    longest history kept, 0 to keep none
+    ///
+    RingFollowers(int maxHistorySec = 300);
+
+    RingFollowers(const RingFollowers&) = delete;
+    RingFollowers& operator=(const RingFollowers&) = delete;
+
+    /// Keep a history of the ring from now on, nothing if it already is
+    /// or maxHistorySec is 0. The history kept so far is dropped if the
+    /// format changed.
+    ///
+    /// \param ring         ring of interleaved frames, not owned
+    ///
+    /// \return             false if the ring isn't allocated
+    ///
+    bool startHistory(SampleRing* ring, int channels, int sampleRate);
+
+    /// Save the ring to WAV files from now on, see CaptureRecorder
+    ///
+    /// \param maxFileSec   start a new file after this many seconds,
+    ///                     0 for no limit
+    ///
+    /// \param maxFileMB    start a new file before it outgrows this,
+    ///                     0 for no limit
+    ///
+    /// \return             whether the first file could be created
+    ///
+    bool startSaving(SampleRing* ring, int channels, int sampleRate,
+                     const char* folderPath, int maxFileSec = 0, int maxFileMB = 0);
+
+    /// Stop saving, the last file is completed and closed
+    ///
+    void stopSaving();
+
+    /// Stop both for good, the history is kept
+    ///
+    void stop();
+
+    /// Drop the history and free its memory
+    ///
+    void clearHistory();
+
+
+    /// Stop the ones running before the ring is reset or reallocated
+    ///
+    void suspend();
+
+    /// Start the ones suspended again on the ring, the history is dropped
+    /// if the format changed, saving goes on in a new set of files
+    ///
+    void resume(SampleRing* ring, int channels, int sampleRate);
+
+
+    /// \return     whether either one is running or suspended, the ring
+    ///             then needs room for them to fall behind
+    ///
+    bool getIsFollowing();
+
+    int getMaxHistorySec();
+
+    SampleHistory& getHistory();
+    CaptureRecorder& getRecorder();
+
+private:
+    int maxHistorySec;
+
+    SampleHistory history;
+    CaptureRecorder recorder;
+
+    // kept to start saving again
+    std::string savingFolder;
+    int savingMaxFileSec;
+    int savingMaxFileMB;
+
+    // format of the history kept
+    int channels;
+    int sampleRate;
+
+    // running before suspend()
+    bool isHistorySuspended;
+    bool isSavingSuspended;
+
+    /// Drop the history if it is of another format
+    void setFormat(int channels, int sampleRate);
+};
+
+#endif
@@ -0,0 +1,315 @@
+#include "sample_history.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "wav_writer.hpp"
+
+// how often the follower wakes up
+static constexpr std::chrono::milliseconds s_POLL_INTERVAL(20);
+
+// samples copied out of the ring per append
+static constexpr uint64_t s_CHUNK_SAMPLES = 8192;
+
+
+SampleHistory::SampleHistory()
+    :   ring(nullptr),
+        channels(1),
+        maxSamples(0),
+        running(false),
+        stopping(false),
+        nextSample(0),
+        droppedSamples(0),
+        firstCount(0),
+        endCount(0)
+{
+
+}
+
+
+SampleHistory::~SampleHistory()
+{
+    this->stop();
+}
+
+
+bool SampleHistory::start(SampleRing* ring, int channels, uint64_t maxSamples)
+{
+    if (running)
+    {
+        this->stop();
+    }
+
+    if (ring == nullptr || ring->getCapacity() == 0 || channels <= 0)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+
+        // another channel count can't follow the samples kept
+        if (channels != this->channels)
+        {
+            this->segments.clear();
+            this->firstCount = 0;
+            this->endCount = 0;
+        }
+
+        this->channels = channels;
+        this->maxSamples = maxSamples;
+    }
+
+    this->ring = ring;
+
+    // from the samples published from now on
+    this->nextSample = ring->getWriteCount();
+    this->nextSample -= nextSample % channels;
+
+    this->chunk.resize(s_CHUNK_SAMPLES - s_CHUNK_SAMPLES % channels);
+    this->silence.assign(chunk.size(), 0.0f);
+    this->droppedSamples = 0;
+    this->stopping = false;
+    this->running = true;
+
+    this->follower = std::thread(&SampleHistory::followerLoop, this);
+
+    return true;
+}
+
+
+void SampleHistory::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        this->stopping = true;
+    }
+    stopCondition.notify_one();
+    follower.join();
+
+    this->running = false;
+}
+
+
+void SampleHistory::clear()
+{
+    std::lock_guard<std::mutex> lock(segmentMutex);
+
+    // frees the memory, unlike clear() on each segment
+    std::deque<std::vector<float>>().swap(segments);
+    this->firstCount = 0;
+    this->endCount = 0;
+}
+
+
+bool SampleHistory::getIsRunning()
+{
+    return running;
+}
+
+
+uint64_t SampleHistory::getSampleCount()
+{
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    return endCount - getFirstKept();
+}
+
+
+uint64_t SampleHistory::getAllocatedSamples()
+{
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    return segments.size() * s_SEGMENT_SAMPLES;
+}
+
+
+uint64_t SampleHistory::getDroppedSamples()
+{
+    return droppedSamples;
+}
+
+
+bool SampleHistory::save(const char* filepath, int sampleRate)
+{
+    uint64_t from, end;
+    int channels;
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        from = getFirstKept();
+        end = endCount;
+        channels = this->channels;
+    }
+
+    if (from == end)
+    {
+        std::cout << "Sample History: nothing to save" << std::endl;
+        return false;
+    }
+
+    WavWriter writer;
+    if (!writer.open(filepath, channels, sampleRate))
+    {
+        return false;
+    }
+
+    // a segment at a time, so the follower is never held up for long
+    std::vector<float> buffer(s_SEGMENT_SAMPLES - s_SEGMENT_SAMPLES % channels);
+    bool isWritten = true;
+
+    while (from < end && isWritten)
+    {
+        uint64_t nSamples = std::min<uint64_t>(end - from, buffer.size());
+        {
+            std::lock_guard<std::mutex> lock(segmentMutex);
+
+            // dropped for newer samples while saving, those stay out
+            from = std::max(from, getFirstKept());
+            if (from >= std::min(end, endCount))
+            {
+                break;
+            }
+            nSamples = std::min(nSamples, std::min(end, endCount) - from);
+
+            this->copy(buffer.data(), from, nSamples);
+        }
+
+        isWritten = writer.write(buffer.data(), nSamples / channels);
+        from += nSamples;
+    }
+
+    isWritten = writer.close() && isWritten;
+    if (!isWritten)
+    {
+        std::cout << "Sample History: failed to write " << filepath << std::endl;
+    }
+
+    return isWritten;
+}
+
+
+void SampleHistory::followerLoop()
+{
+    while (true)
+    {
+        bool isStopping;
+        {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            stopCondition.wait_for(lock, s_POLL_INTERVAL,
+                                   [this] { return stopping; });
+            isStopping = stopping;
+        }
+
+        // what was published before stop() is kept
+        this->drain();
+
+        if (isStopping)
+        {
+            break;
+        }
+    }
+}
+
+
+void SampleHistory::drain()
+{
+    uint64_t end = ring->getWriteCount();
+
+    while (nextSample < end)
+    {
+        uint64_t nSkipped = 0;
+        uint64_t nSamples = ring->readNext(chunk.data(), &nextSample,
+                                           std::min<uint64_t>(chunk.size(), end - nextSample),
+                                           channels, &nSkipped);
+        this->droppedSamples += nSkipped;
+
+        std::lock_guard<std::mutex> lock(segmentMutex);
+
+        // a gap of silence where samples were overwritten, whole frames
+        // as the ring skips to a frame start
+        while (nSkipped > 0)
+        {
+            uint64_t len = std::min<uint64_t>(nSkipped, silence.size());
+            this->append(silence.data(), len);
+            nSkipped -= len;
+        }
+
+        if (nSamples == 0)
+        {
+            break;
+        }
+
+        this->append(chunk.data(), nSamples);
+    }
+}
+
+
+void SampleHistory::append(const float* samples, uint64_t nSamples)
+{
+    // enough segments for maxSamples wherever the first kept sample falls
+    uint64_t maxSegments = maxSamples / s_SEGMENT_SAMPLES + 2;
+
+    while (nSamples > 0)
+    {
+        uint64_t offset = endCount - firstCount;
+
+        if (offset == segments.size() * s_SEGMENT_SAMPLES)
+        {
+            if (segments.size() >= maxSegments)
+            {
+                // the oldest segment becomes the newest, nothing allocated
+                this->segments.push_back(std::move(segments.front()));
+                this->segments.pop_front();
+                this->firstCount += s_SEGMENT_SAMPLES;
+                offset -= s_SEGMENT_SAMPLES;
+            }
+            else
+            {
+                this->segments.emplace_back(s_SEGMENT_SAMPLES);
+            }
+        }
+
+        uint64_t slot = offset % s_SEGMENT_SAMPLES;
+        uint64_t len = std::min(nSamples, s_SEGMENT_SAMPLES - slot);
+
+        memcpy(&segments[offset / s_SEGMENT_SAMPLES][slot], samples,
+               len * sizeof(float));
+
+        samples += len;
+        nSamples -= len;
+        this->endCount += len;
+    }
+}
+
+
+void SampleHistory::copy(float* dst, uint64_t from, uint64_t nSamples)
+{
+    while (nSamples > 0)
+    {
+        uint64_t offset = from - firstCount;
+        uint64_t slot = offset % s_SEGMENT_SAMPLES;
+        uint64_t len = std::min(nSamples, s_SEGMENT_SAMPLES - slot);
+
+        memcpy(dst, &segments[offset / s_SEGMENT_SAMPLES][slot],
+               len * sizeof(float));
+
+        dst += len;
+        from += len;
+        nSamples -= len;
+    }
+}
+
+
+uint64_t SampleHistory::getFirstKept()
+{
+    uint64_t first = (endCount - firstCount > maxSamples) ? endCount - maxSamples
+                                                          : firstCount;
+
+    // counted from a frame start
+    return first + (channels - first % channels) % channels;
+}
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+// SampleHistory class for keeping a long history of a SampleRing
+//
+// The ring only holds what analysis needs. A background thread follows its
+// write counter and appends to a list of fixed-size segments, allocated one
+// at a time as recording goes on, so memory grows with what was actually
+// recorded rather than with the longest history allowed. Once the limit is
+// reached the oldest segment is reused for the newest samples. Samples
+// overwritten in the ring before they were appended are kept as silence,
+// so the history stays as long as the recording.
+//
+// The history can be saved as a WAV file while it is being appended to.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SAMPLE_HISTORY_HPP
+#define SAMPLE_HISTORY_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "sample_ring.hpp"
+
+class SampleHistory
+{
+public:
+    SampleHistory();
+    ~SampleHistory();
+
+    SampleHistory(const SampleHistory&) = delete;
+    SampleHistory& operator=(const SampleHistory&) = delete;
+
+    /// Append the samples written to a ring from now on, after the ones
+    /// already kept
+    ///
+    /// \param ring         ring of interleaved frames, not owned,
+    ///                     must not be reallocated until stop()
+    ///
+    /// \param channels     channels per frame in the ring
+    ///
+    /// \param maxSamples   number of samples kept at most, the oldest are
+    ///                     dropped past it
+    ///
+    /// \return             false if the ring isn't allocated
+    ///
+    bool start(SampleRing* ring, int channels, uint64_t maxSamples);
+
+    /// Stop following the ring, appends what it holds up to now,
+    /// the history is kept
+    ///
+    void stop();
+
+    /// Drop the history and free its segments
+    ///
+    void clear();
+
+    bool getIsRunning();
+
+    /// \return     number of samples kept, at most maxSamples
+    ///
+    uint64_t getSampleCount();
+
+    /// \return     number of samples the segments hold, kept or not
+    ///
+    uint64_t getAllocatedSamples();
+
+    /// \return     number of samples overwritten in the ring before they
+    ///             were appended, since start(), kept as silence
+    ///
+    uint64_t getDroppedSamples();
+
+    /// Write the kept samples to a float-32 WAV file, oldest first
+    ///
+    /// \param sampleRate   sample rate written to the header
+    ///
+    /// \return             false if nothing is kept or on a write error
+    ///
+    bool save(const char* filepath, int sampleRate);
+
+private:
+    static constexpr uint64_t s_SEGMENT_SAMPLES = 1 << 16;
+
+    // settings
+    SampleRing* ring;
+    int channels;
+    uint64_t maxSamples;
+    bool running;
+
+    // follower thread
+    std::thread follower;
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stopping;
+
+    uint64_t nextSample;            // ring count of the next sample
+    std::vector<float> chunk;
+    std::vector<float> silence;     // zeros, as long as chunk
+    std::atomic<uint64_t> droppedSamples;
+
+    // samples [firstCount, endCount) counted from the first one appended,
+    // firstCount at the start of segments[0]
+    std::mutex segmentMutex;
+    std::deque<std::vector<float>> segments;
+    uint64_t firstCount;
+    uint64_t endCount;
+
+    void followerLoop();
+
+    /// Append everything published up to now
+    void drain();
+
+    /// Append to the segments, segmentMutex held
+    void append(const float* samples, uint64_t nSamples);
+
+    /// Copy [from, from + nSamples), segmentMutex held
+    void copy(float* dst, uint64_t from, uint64_t nSamples);
+
+    /// First kept sample, at the start of a frame, segmentMutex held
+    uint64_t getFirstKept();
+};
+
+#endif
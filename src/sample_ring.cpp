@@ -0,0 +1,163 @@
+#include "sample_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+SampleRing::SampleRing()
+    :   mask(0),
+        writeCount(0),
+        reserveCount(0)
+{
+
+}
+
+
+void SampleRing::allocate(uint64_t minCapacity)
+{
+    uint64_t capacity = 1;
+    while (capacity < minCapacity)
+    {
+        capacity <<= 1;
+    }
+
+    this->buffer.assign(capacity, 0.0f);
+    this->mask = capacity - 1;
+
+    this->writeCount.store(0);
+    this->reserveCount.store(0);
+}
+
+
+uint64_t SampleRing::getCapacity()
+{
+    return this->buffer.size();
+}
+
+
+void SampleRing::write(const float* samples, uint64_t nSamples)
+{
+    uint64_t capacity = buffer.size();
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    uint64_t count = writeCount.load(std::memory_order_relaxed);
+
+    // the older ones would be overwritten by the same block
+    if (nSamples > capacity)
+    {
+        samples += nSamples - capacity;
+        count += nSamples - capacity;
+        nSamples = capacity;
+    }
+
+    // readers of the slots about to be written see them as overwritten
+    this->reserveCount.store(count + nSamples, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t slot = count & mask;
+    uint64_t firstLen = std::min(nSamples, capacity - slot);
+
+    memcpy(&buffer[slot], samples, firstLen * sizeof(float));
+    memcpy(&buffer[0], samples + firstLen, (nSamples - firstLen) * sizeof(float));
+
+    this->writeCount.store(count + nSamples, std::memory_order_release);
+}
+
+
+uint64_t SampleRing::getWriteCount()
+{
+    return this->writeCount.load(std::memory_order_acquire);
+}
+
+
+bool SampleRing::read(float* dst, uint64_t from, uint64_t nSamples)
+{
+    uint64_t capacity = buffer.size();
+    uint64_t end = writeCount.load(std::memory_order_acquire);
+
+    if (from + nSamples > end || end - from > capacity)
+    {
+        return false;
+    }
+
+    uint64_t slot = from & mask;
+    uint64_t firstLen = std::min(nSamples, capacity - slot);
+
+    memcpy(dst, &buffer[slot], firstLen * sizeof(float));
+    memcpy(dst + firstLen, &buffer[0], (nSamples - firstLen) * sizeof(float));
+
+    // nothing the producer started writing since reaches back to from
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t reserved = reserveCount.load(std::memory_order_relaxed);
+
+    return reserved - from <= capacity;
+}
+
+
+void SampleRing::readLatest(float* dst, uint64_t nSamples)
+{
+    if (nSamples > buffer.size())
+    {
+        // not allocated, or would always be overwritten
+        memset(dst, 0, nSamples * sizeof(float));
+        return;
+    }
+
+    while (true)
+    {
+        uint64_t end = writeCount.load(std::memory_order_acquire);
+        uint64_t nZeros = (end < nSamples) ? nSamples - end : 0;
+
+        memset(dst, 0, nZeros * sizeof(float));
+
+        if (read(dst + nZeros, end - (nSamples - nZeros), nSamples - nZeros))
+        {
+            return;
+        }
+    }
+}
+
+
+uint64_t SampleRing::readNext(float* dst, uint64_t* from, uint64_t maxSamples,
+                              uint64_t frameLen, uint64_t* nSkipped)
+{
+    uint64_t capacity = buffer.size();
+    if (capacity == 0)
+    {
+        return 0;
+    }
+
+    while (true)
+    {
+        uint64_t end = writeCount.load(std::memory_order_acquire);
+
+        // the producer can't catch up again right away
+        if (end - *from > capacity)
+        {
+            uint64_t skipTo = end - capacity / 2;
+            skipTo -= skipTo % frameLen;
+
+            *nSkipped += skipTo - *from;
+            *from = skipTo;
+        }
+
+        uint64_t nSamples = std::min(end - *from, maxSamples);
+        nSamples -= nSamples % frameLen;
+
+        if (nSamples == 0)
+        {
+            return 0;
+        }
+
+        if (read(dst, *from, nSamples))
+        {
+            *from += nSamples;
+            return nSamples;
+        }
+
+        // overwritten while copying, skipped on the next try
+    }
+}
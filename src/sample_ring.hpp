@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+// Single-producer ring of float samples with lock-free readers
+//
+// Samples are counted from the first one ever written with 64-bit counters
+// that never wrap in practice, sample c lives at slot c & (capacity - 1).
+// The producer (the audio callback) never waits: it bumps a reserve counter,
+// copies the block and publishes the write counter. A reader copies what it
+// wants and then checks the reserve counter, like a seqlock, to tell whether
+// the producer overwrote any of it meanwhile.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SAMPLE_RING_HPP
+#define SAMPLE_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class SampleRing
+{
+public:
+    SampleRing();
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    /// Allocate and zero the ring, the counters start over,
+    /// only while the producer isn't running
+    ///
+    /// \param minCapacity  number of samples, rounded up to a power of 2
+    ///
+    void allocate(uint64_t minCapacity);
+
+    /// \return     number of samples the ring holds
+    ///
+    uint64_t getCapacity();
+
+
+    /// Append samples, the oldest are overwritten, producer thread only
+    ///
+    /// \param samples      (array must have a length of nSamples)
+    ///
+    /// \param nSamples     number of samples, only the last capacity of them
+    ///                     are kept if more
+    ///
+    void write(const float* samples, uint64_t nSamples);
+
+    /// \return     number of samples written since allocate()
+    ///
+    uint64_t getWriteCount();
+
+
+    /// Copy samples [from, from + nSamples) by their count
+    ///
+    /// \return     false if they are not all written yet or were
+    ///             overwritten, dst is then left undefined
+    ///
+    bool read(float* dst, uint64_t from, uint64_t nSamples);
+
+    /// Copy the latest samples, zeros before the first one written,
+    /// tried again if the producer overwrote them while copying
+    ///
+    /// \param nSamples     at most the capacity, all zeros otherwise
+    ///
+    void readLatest(float* dst, uint64_t nSamples);
+
+    /// Copy the samples that follow a sequential reader's position, if the
+    /// producer overwrote them it resumes halfway back in the ring instead
+    ///
+    /// \param from         count of the next sample to read, moved past the
+    ///                     samples copied and skipped
+    ///
+    /// \param maxSamples   at most this many are copied
+    ///
+    /// \param frameLen     samples per frame, whole frames are copied and
+    ///                     skipped
+    ///
+    /// \param nSkipped     incremented by the number of samples skipped
+    ///
+    /// \return             number of samples copied, 0 if none are new
+    ///
+    uint64_t readNext(float* dst, uint64_t* from, uint64_t maxSamples,
+                      uint64_t frameLen, uint64_t* nSkipped);
+
+private:
+    std::vector<float> buffer;
+    uint64_t mask;
+
+    // samples [writeCount - capacity, writeCount) are readable,
+    // the producer is writing up to reserveCount
+    std::atomic<uint64_t> writeCount;
+    std::atomic<uint64_t> reserveCount;
+};
+
+#endif
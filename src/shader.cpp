@@ -3,8 +3,31 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+// program binary file header
+static constexpr uint32_t s_BINARY_MAGIC = 0x42475053; // "SPGB"
+static constexpr uint32_t s_BINARY_VERSION = 1;
+
+/// 64-bit FNV-1a hash, chained through seed
+static uint64_t s_fnv1a(const char* data, size_t len, 
+                        uint64_t seed = 14695981039346656037ULL);
+
+/// Hash of the driver, the shader sources, and the transform feedback 
+/// varying, identifies a program binary
+static uint64_t s_programKey(const std::string& vertexCode, 
+                             const std::string& fragmentCode,
+                             const char* feedbackVarying);
+
+Shader::Shader(const char* vertexPath, 
+               const char* fragmentPath, 
+               const char* cacheDir,
+               const char* feedbackVarying)
+    :   ID(0),
+        loadedFromCache(false)
 {
     // retrieve the vertex and fragment source code from filePath
     // ----------------------------------------------------------
@@ -50,6 +73,32 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     }
     const char* vShaderCode = vertexCode.c_str();
     const char * fShaderCode = fragmentCode.c_str();
+
+    // try the program binary cache first
+    // ----------------------------------
+    std::string binaryPath;
+    GLint numBinaryFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+
+    if (cacheDir != nullptr && numBinaryFormats > 0)
+    {
+        char keyStr[17];
+        snprintf(keyStr, sizeof(keyStr), "%016llx", 
+                 static_cast<unsigned long long>(
+                    s_programKey(vertexCode, fragmentCode, feedbackVarying)
+                 ));
+        binaryPath = std::string(cacheDir) + "shader_" + keyStr + ".bin";
+
+        if (loadProgramBinary(binaryPath))
+        {
+            this->loadedFromCache = true;
+            return;
+        }
+        else
+        {
+            // nothing, cache miss or invalid binary, compile below
+        }
+    }
     
     // compile shaders
     // ---------------
@@ -71,12 +120,29 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
+    if (feedbackVarying != nullptr)
+    {
+        // must be set before linking
+        glTransformFeedbackVaryings(ID, 1, &feedbackVarying, 
+                                    GL_INTERLEAVED_ATTRIBS);
+    }
+    if (!binaryPath.empty())
+    {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(ID);
     checkCompileErrors(ID, "PROGRAM");
 
     // delete the shaders as they're already linked into our program
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    // store the binary for the next launch
+    // ------------------------------------
+    if (!binaryPath.empty())
+    {
+        saveProgramBinary(binaryPath);
+    }
 }
 
 Shader::~Shader() 
@@ -90,37 +156,93 @@ void Shader::use() const
 { 
     glUseProgram(ID); 
 }
+// uniform location cache
+// ------------------------------------------------------------------------
+GLint Shader::getUniformLocation(const std::string &name) const
+{
+    auto it = uniformLocations.find(name);
+    if (it != uniformLocations.end())
+    {
+        return it->second;
+    }
+
+    // first lookup, ask the driver once
+    GLint location = glGetUniformLocation(ID, name.c_str());
+    uniformLocations.emplace(name, location);
+
+    return location;
+}
+// ------------------------------------------------------------------------
+bool Shader::getLoadedFromCache() const
+{
+    return loadedFromCache;
+}
 // utility uniform functions
 // ------------------------------------------------------------------------
 void Shader::setBool(const std::string &name, bool value) const
 {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    setBool(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setInt(const std::string &name, int value) const
 { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    setInt(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setFloat(const std::string &name, float value) const
 { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    setFloat(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setVec3(const std::string &name, glm::vec3 value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()),
-                 1, glm::value_ptr(value)); 
+    setVec3(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    glUniform3f(getUniformLocation(name), x, y, z); 
+}
+// ------------------------------------------------------------------------
+void Shader::setVec4(const std::string &name, glm::vec4 value) const
+{
+    setVec4(getUniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setMat4(const std::string &name, glm::mat4 value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value)); 
+    setMat4(getUniformLocation(name), value);
+}
+// utility uniform functions with cached locations
+// ------------------------------------------------------------------------
+void Shader::setBool(GLint location, bool value) const
+{         
+    glUniform1i(location, (int)value); 
+}
+// ------------------------------------------------------------------------
+void Shader::setInt(GLint location, int value) const
+{ 
+    glUniform1i(location, value); 
+}
+// ------------------------------------------------------------------------
+void Shader::setFloat(GLint location, float value) const
+{ 
+    glUniform1f(location, value); 
+}
+// ------------------------------------------------------------------------
+void Shader::setVec3(GLint location, glm::vec3 value) const
+{
+    glUniform3fv(location, 1, glm::value_ptr(value)); 
+}
+// ------------------------------------------------------------------------
+void Shader::setVec4(GLint location, glm::vec4 value) const
+{
+    glUniform4fv(location, 1, glm::value_ptr(value)); 
+}
+// ------------------------------------------------------------------------
+void Shader::setMat4(GLint location, glm::mat4 value) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); 
 }
 
 // utility function for checking shader compilation/linking errors.
@@ -147,4 +269,137 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
             std::cerr << "ERROR::PROGRAM::LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
+}
+
+
+// program binary cache
+// ------------------------------------------------------------------------
+bool Shader::loadProgramBinary(const std::string& binaryPath)
+{
+    std::ifstream file(binaryPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    GLenum format = 0;
+    GLint length = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+
+    if (!file || magic != s_BINARY_MAGIC || version != s_BINARY_VERSION 
+        || length <= 0)
+    {
+        std::cout << "Shader cache: ignoring invalid binary " 
+                  << binaryPath << std::endl;
+        return false;
+    }
+
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file)
+    {
+        std::cout << "Shader cache: ignoring truncated binary " 
+                  << binaryPath << std::endl;
+        return false;
+    }
+
+    ID = glCreateProgram();
+    glProgramBinary(ID, format, binary.data(), length);
+
+    // the driver may reject the binary, e.g. after a driver update 
+    // with the same version string
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        std::cout << "Shader cache: driver rejected " 
+                  << binaryPath << ", recompiling" << std::endl;
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    return true;
+}
+// ------------------------------------------------------------------------
+void Shader::saveProgramBinary(const std::string& binaryPath)
+{
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+
+    GLint length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (!success || length <= 0)
+    {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(ID, length, &length, &format, binary.data());
+
+    std::ofstream file(binaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cout << "Shader cache: failed to write " << binaryPath << std::endl;
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(&s_BINARY_MAGIC), 
+               sizeof(s_BINARY_MAGIC));
+    file.write(reinterpret_cast<const char*>(&s_BINARY_VERSION), 
+               sizeof(s_BINARY_VERSION));
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.write(binary.data(), length);
+}
+// ------------------------------------------------------------------------
+uint64_t s_fnv1a(const char* data, size_t len, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+// ------------------------------------------------------------------------
+uint64_t s_programKey(const std::string& vertexCode, 
+                      const std::string& fragmentCode,
+                      const char* feedbackVarying)
+{
+    // a binary is only valid for the exact same driver
+    const GLenum driverStrings[] = {
+        GL_VENDOR, 
+        GL_RENDERER, 
+        GL_VERSION, 
+        GL_SHADING_LANGUAGE_VERSION
+    };
+
+    uint64_t hash = s_fnv1a(nullptr, 0);
+    for (GLenum name : driverStrings)
+    {
+        const char* str = reinterpret_cast<const char*>(glGetString(name));
+        if (str != nullptr)
+        {
+            hash = s_fnv1a(str, strlen(str), hash);
+        }
+    }
+
+    hash = s_fnv1a(vertexCode.data(), vertexCode.size(), hash);
+    hash = s_fnv1a(fragmentCode.data(), fragmentCode.size(), hash);
+
+    if (feedbackVarying != nullptr)
+    {
+        hash = s_fnv1a(feedbackVarying, strlen(feedbackVarying), hash);
+    }
+
+    return hash;
 }
\ No newline at end of file
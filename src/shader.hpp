@@ -2,6 +2,11 @@
 //
 // Shader class for loading shader programs in OpenGL
 // Source code is modified from learnopengl.com
+//
+// Linked programs can be stored with glGetProgramBinary and reloaded on the
+// next launch, skipping compilation. The binary is keyed by a hash of the
+// driver strings and the shader sources, so updating either of them simply
+// falls back to compiling.
 // 
 //===----------------------------------------------------------------------===//
 
@@ -16,6 +21,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <unordered_map>
   
 
 class Shader
@@ -24,23 +30,68 @@ public:
     // the program ID
     unsigned int ID;
   
-    // constructor reads and builds the shader
-    Shader(const char* vertexPath, const char* fragmentPath);
+    /// constructor reads and builds the shader
+    ///
+    /// \param vertexPath       vertex shader source file
+    ///
+    /// \param fragmentPath     fragment shader source file
+    ///
+    /// \param cacheDir         directory (ending with a path separator) for 
+    ///                         storing the program binary, 
+    ///                         defaulted to nullptr (no caching)
+    ///
+    /// \param feedbackVarying  vertex shader output captured with transform
+    ///                         feedback (GL_INTERLEAVED_ATTRIBS),
+    ///                         defaulted to nullptr (no transform feedback)
+    ///
+    Shader(const char* vertexPath, 
+           const char* fragmentPath, 
+           const char* cacheDir = nullptr,
+           const char* feedbackVarying = nullptr);
     ~Shader();
 
     // use/activate the shader
     void use() const;
 
+    /// Uniform locations are looked up once and cached, use the location 
+    /// with the set functions below for uniforms updated every frame
+    ///
+    /// \return     uniform location, -1 if it does not exist in the program
+    ///
+    GLint getUniformLocation(const std::string &name) const;
+
+    /// \return     whether the program was loaded from the binary cache
+    ///
+    bool getLoadedFromCache() const;
+
     // utility uniform functions
     void setBool(const std::string &name, bool value) const;  
     void setInt(const std::string &name, int value) const;   
     void setFloat(const std::string &name, float value) const;
     void setVec3(const std::string &name, glm::vec3 value) const;
     void setVec3(const std::string &name, float x, float y, float z) const;
+    void setVec4(const std::string &name, glm::vec4 value) const;
     void setMat4(const std::string &name, glm::mat4 value) const;
 
+    // utility uniform functions with cached locations
+    void setBool(GLint location, bool value) const;  
+    void setInt(GLint location, int value) const;   
+    void setFloat(GLint location, float value) const;
+    void setVec3(GLint location, glm::vec3 value) const;
+    void setVec4(GLint location, glm::vec4 value) const;
+    void setMat4(GLint location, glm::mat4 value) const;
+
 private:
+    // uniform name -> location, filled on first lookup
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    bool loadedFromCache;
+
     void checkCompileErrors(unsigned int shader, std::string type);
+
+    /// \return     whether ID now holds a valid program from the binary
+    bool loadProgramBinary(const std::string& binaryPath);
+    void saveProgramBinary(const std::string& binaryPath);
 };
   
 #endif
\ No newline at end of file
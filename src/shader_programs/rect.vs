@@ -5,24 +5,37 @@ layout (location = 0) in vec2 aPosXY;
 layout (location = 1) in float aPosZ;
 
 uniform mat4 rotationMat;
-uniform vec3 rgbColormap0;
-uniform vec3 rgbColormap1;
+
+// xy scale and offset of the surface, for drawing several spectrograms
+// (see channelMixLayout), (1, 1, 0, 0) for one
+uniform vec4 surfaceTransform;
+
+// z input is linear power (fftComplexToPower) instead of dB scaled to [0, 1]
+// (fftComplexToRealDB), mapped to [floorDB, floorDB + rangeDB] here
+uniform bool powerInput;
+uniform float floorDB;
+uniform float rangeDB;
 
 out float height;
-out vec3 rgb_colormap0;
-out vec3 rgb_colormap1;
+
+float powerToNormalizedDB(float power);
 
 void main()
 {
+    float z = powerInput ? powerToNormalizedDB(aPosZ) : aPosZ;
+
     float zScaling = 0.6;
-    height = clamp(aPosZ / zScaling, 0.0, 1.0);
+    height = clamp(z / zScaling, 0.0, 1.0);
 
-    // colormap base colors
-    rgb_colormap0 = vec3(0.906,  1.000,  0.529);
-    rgb_colormap1 = vec3(0.000,  0.502,  0.502);
-    
-    // rgb_colormap0 = rgbColormap0;
-    // rgb_colormap1 = rgbColormap1;
+    vec2 posXY = aPosXY * surfaceTransform.xy + surfaceTransform.zw;
+
+    gl_Position = rotationMat * vec4(posXY.x, posXY.y, -z + zScaling/2.0, 1.0);
+}
+
+float powerToNormalizedDB(float power)
+{
+    // 10 * log10(power), floored like fftComplexToRealDB
+    float dB = 10.0 * 0.30102999566 * log2(max(power, 1e-30));
 
-    gl_Position = rotationMat * vec4(aPosXY.x, aPosXY.y, -aPosZ + zScaling/2.0, 1.0);
-}
\ No newline at end of file
+    return max((dB - floorDB) / rangeDB, 0.0);
+}
@@ -0,0 +1,11 @@
+#version 300 es
+precision highp float; // for OpenGL 3.0 es
+
+// required to link spectrum.vs, never runs with GL_RASTERIZER_DISCARD
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.0);
+}
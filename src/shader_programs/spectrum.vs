@@ -0,0 +1,48 @@
+#version 300 es
+precision highp float; // for OpenGL 3.0 es
+
+// one vertex per spectrogram column, captured with transform feedback
+// (see spectrum_feedback.hpp), nothing is rasterized
+
+// complex bins (real, imag) left of, at, and right of this column
+layout (location = 0) in vec2 aComplexL;
+layout (location = 1) in vec2 aComplexC;
+layout (location = 2) in vec2 aComplexR;
+
+// this column in the previous row, for the temporal smoothing
+layout (location = 3) in float aPrevious;
+
+// 20 * log10(fftLen), same reference as fftComplexToRealDB
+uniform float fftLenLog10;
+uniform float floorDB;
+
+// row-direction kernel, a + b + c = 1
+uniform vec3 rowKernel;
+
+// weight of the previous row, 0 for no temporal smoothing
+uniform float smoothing;
+
+out float zOut;
+
+float complexToNormalizedDB(vec2 complex);
+
+void main()
+{
+    float z = rowKernel.x * complexToNormalizedDB(aComplexL)
+            + rowKernel.y * complexToNormalizedDB(aComplexC)
+            + rowKernel.z * complexToNormalizedDB(aComplexR);
+
+    zOut = mix(z, aPrevious, smoothing);
+
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+}
+
+float complexToNormalizedDB(vec2 complex)
+{
+    // 10 * log10(|X|^2), floored and scaled to [0, 1] like fftComplexToRealDB
+    float magnitudeSquared = max(dot(complex, complex), 1e-20);
+    float dB = 10.0 * 0.30102999566 * log2(magnitudeSquared) - fftLenLog10;
+    dB = max(dB, floorDB);
+
+    return 1.0 - dB / floorDB;
+}
@@ -0,0 +1,298 @@
+#include "spectrogram_lane.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <pffft.h>
+
+#include "array2d.hpp"
+#include "fft.hpp"
+#include "smoothing.hpp"
+#include "quantize.hpp"
+
+
+SpectrogramLane::SpectrogramLane(const int nRowsV,
+                                 const int nColsV,
+                                 const int fftLen,
+                                 const char* spectrumVsPath,
+                                 const char* spectrumFsPath,
+                                 const char* cacheDir)
+    :   nRowsV(nRowsV),
+        nColsV(nColsV),
+        fftLen(fftLen),
+        z(nRowsV * nColsV, 0.0f),
+        grid(z.data(),
+             nRowsV, nColsV,
+             0,
+             false,
+             0.8f, -0.8f,
+             0.8f, -0.8f),
+        spectrumFeedback(spectrumVsPath,
+                         spectrumFsPath,
+                         nRowsV, nColsV,
+                         fftLen,
+                         cacheDir),
+        powerInput(false),
+        gpuSpectrum(false),
+        zDirty(false),
+        magnitudeBuffer(fftLen / 2, 0.0f)
+{
+    const size_t rowSize = (fftLen / 2) * sizeof(float);
+
+    this->signalBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    this->complexBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    this->workBuffer = static_cast<float*>(pffft_aligned_malloc(fftLen * sizeof(float)));
+    memset(signalBuffer, 0, fftLen * sizeof(float));
+
+    smoothingHalfGaussian(&colKernel[0], s_N_CONV_ROWS);
+
+    this->previousRows = static_cast<float*>(pffft_aligned_malloc((s_N_CONV_ROWS - 1) * rowSize));
+    this->workRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+    this->workFFTRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+    this->workConvRow = static_cast<float*>(pffft_aligned_malloc(rowSize));
+    memset(previousRows, 0, (s_N_CONV_ROWS - 1) * rowSize);
+}
+
+
+SpectrogramLane::~SpectrogramLane()
+{
+    pffft_aligned_free(signalBuffer);
+    pffft_aligned_free(complexBuffer);
+    pffft_aligned_free(workBuffer);
+    pffft_aligned_free(previousRows);
+    pffft_aligned_free(workRow);
+    pffft_aligned_free(workFFTRow);
+    pffft_aligned_free(workConvRow);
+}
+
+
+float* SpectrogramLane::getSignalBuffer()
+{
+    return this->signalBuffer;
+}
+
+
+void SpectrogramLane::analyze(const int signalLen)
+{
+    // perfrom FFT
+    memset(&signalBuffer[signalLen],
+           0,
+           (fftLen - signalLen) * sizeof(float));
+
+    fftForwardFFT(&signalBuffer[0],
+                  &complexBuffer[0],
+                  &workBuffer[0]);
+
+    if (gpuSpectrum)
+    {
+        // only for the frequency plot, z is done in spectrumFeedback
+        fftComplexToRealDB(&magnitudeBuffer[0],
+                           &complexBuffer[0],
+                           fftLen / 2,
+                           true);
+        return;
+    }
+    else if (powerInput)
+    {
+        // no log on the CPU, floor and range are uniforms
+        fftComplexToPower(&magnitudeBuffer[0],
+                          &complexBuffer[0],
+                          fftLen / 2);
+    }
+    else
+    {
+        fftComplexToRealDB(&magnitudeBuffer[0],
+                           &complexBuffer[0],
+                           fftLen / 2,
+                           true);
+    }
+
+    gridZFormat zFormat = grid.getZFormat();
+
+    if (zFormat == GRID_Z_FLOAT32)
+    {
+        array2dMoveRowsUp(&z[0], nRowsV, nColsV, 1);
+    }
+    else
+    {
+        array2dMoveRowsUp(&z16[0], nRowsV, nColsV, 1);
+    }
+
+    smoothingBlurRow(&magnitudeBuffer[1],
+                     &magnitudeBuffer[1],
+                     &previousRows[0],
+                     &workRow[0],
+                     &workFFTRow[0],
+                     &workConvRow[0],
+                     &colKernel[0],
+                     fftLen,
+                     s_N_CONV_ROWS);
+
+    //  omit DC and the freq before Nyquist
+    int lastRowIdx = array2dIdx(nRowsV - 1, 0, nColsV);
+
+    switch (zFormat)
+    {
+        case GRID_Z_FLOAT32:
+            memcpy(&z[lastRowIdx],
+                   &magnitudeBuffer[1],
+                   nColsV * sizeof(float));
+            break;
+
+        case GRID_Z_UNORM16:
+            quantizeFloatToUnorm16(&z16[lastRowIdx],
+                                   &magnitudeBuffer[1],
+                                   nColsV);
+            break;
+
+        case GRID_Z_HALF16:
+            quantizeFloatToHalf(&z16[lastRowIdx],
+                                &magnitudeBuffer[1],
+                                nColsV);
+            break;
+    }
+}
+
+
+void SpectrogramLane::upload(const bool analyzed)
+{
+    if (!analyzed && !zDirty)
+    {
+        return;
+    }
+
+    if (gpuSpectrum)
+    {
+        // the CPU history is only uploaded to clear it
+        if (zDirty)
+        {
+            grid.zSubAllData(z.data());
+        }
+        if (analyzed)
+        {
+            spectrumFeedback.process(&complexBuffer[0], grid.getZBuffer());
+        }
+    }
+    else if (grid.getZFormat() == GRID_Z_FLOAT32)
+    {
+        grid.zSubAllData(z.data());
+    }
+    else
+    {
+        grid.zSubAllData(z16.data());
+    }
+
+    this->zDirty = false;
+}
+
+
+void SpectrogramLane::setZFormat(gridZFormat format)
+{
+    gridZFormat current = grid.getZFormat();
+    int len = nRowsV * nColsV;
+
+    if (format == current)
+    {
+        return;
+    }
+
+    if (current == GRID_Z_UNORM16)
+    {
+        z.resize(len);
+        quantizeUnorm16ToFloat(z.data(), z16.data(), len);
+    }
+    else if (current == GRID_Z_HALF16)
+    {
+        z.resize(len);
+        quantizeHalfToFloat(z.data(), z16.data(), len);
+    }
+
+    if (format == GRID_Z_UNORM16)
+    {
+        z16.resize(len);
+        quantizeFloatToUnorm16(z16.data(), z.data(), len);
+    }
+    else if (format == GRID_Z_HALF16)
+    {
+        z16.resize(len);
+        quantizeFloatToHalf(z16.data(), z.data(), len);
+    }
+
+    // free the one not in use
+    if (format == GRID_Z_FLOAT32)
+    {
+        std::vector<uint16_t>().swap(z16);
+    }
+    else
+    {
+        std::vector<float>().swap(z);
+    }
+
+    grid.setZFormat(format);
+    this->zDirty = true;
+}
+
+
+void SpectrogramLane::setPowerInput(bool powerInput)
+{
+    // the history has a different meaning in each mode, start over
+    if (this->powerInput != powerInput)
+    {
+        this->powerInput = powerInput;
+        this->clear();
+    }
+}
+
+
+void SpectrogramLane::setGPUSpectrum(bool gpuSpectrum)
+{
+    // the CPU history is stale after the GPU wrote z, start over
+    if (this->gpuSpectrum != gpuSpectrum)
+    {
+        this->gpuSpectrum = gpuSpectrum;
+        this->clear();
+    }
+}
+
+
+void SpectrogramLane::setGPUSpectrumSmoothing(float smoothing)
+{
+    spectrumFeedback.setSmoothing(smoothing);
+}
+
+
+void SpectrogramLane::clear()
+{
+    std::fill(z.begin(), z.end(), 0.0f);
+    std::fill(z16.begin(), z16.end(), 0);
+    std::fill(magnitudeBuffer.begin(), magnitudeBuffer.end(), 0.0f);
+    memset(previousRows, 0, (s_N_CONV_ROWS - 1) * (fftLen / 2) * sizeof(float));
+    spectrumFeedback.reset();
+
+    this->zDirty = true;
+}
+
+
+Grid& SpectrogramLane::getGrid()
+{
+    return this->grid;
+}
+
+
+float* SpectrogramLane::getMagnitude()
+{
+    return this->magnitudeBuffer.data();
+}
+
+
+void spectrogramLaneAnalyzeAll(SpectrogramLane* const* lanes,
+                               const int nLanes,
+                               const int signalLen)
+{
+    // the FFT setup is only read, the rest is per lane
+    #pragma omp parallel for if(nLanes > 1)
+    for (int i = 0; i < nLanes; ++i)
+    {
+        lanes[i]->analyze(signalLen);
+    }
+}
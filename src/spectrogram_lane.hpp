@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+// One spectrogram: the FFT of a mono signal, its smoothed history and the
+// grid it is drawn on
+//
+// An input with several channels is analysed in several lanes (see
+// channel_mix.hpp). analyze() only touches the buffers of its own lane, so
+// the lanes can be analysed in parallel (see spectrogramLaneAnalyzeAll),
+// upload() and drawing the grid need the OpenGL context.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SPECTROGRAM_LANE_HPP
+#define SPECTROGRAM_LANE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "grid.hpp"
+#include "spectrum_feedback.hpp"
+
+class SpectrogramLane
+{
+public:
+    /// \param nRowsV           number of rows in the history
+    ///
+    /// \param nColsV           number of columns in the history,
+    ///                         column j is FFT bin j + 1,
+    ///                         must be fftLen/2 - 2 (see smoothing.hpp)
+    ///
+    /// \param fftLen           length of the FFT (see fftInit)
+    ///
+    /// \param spectrumVsPath   path to spectrum.vs (see SpectrumFeedback)
+    ///
+    /// \param spectrumFsPath   path to spectrum.fs
+    ///
+    /// \param cacheDir         program binary cache directory (see Shader),
+    ///                         defaulted to nullptr (no caching)
+    ///
+    SpectrogramLane(const int nRowsV,
+                    const int nColsV,
+                    const int fftLen,
+                    const char* spectrumVsPath,
+                    const char* spectrumFsPath,
+                    const char* cacheDir = nullptr);
+
+    ~SpectrogramLane();
+
+    SpectrogramLane(const SpectrogramLane&) = delete;
+    SpectrogramLane& operator=(const SpectrogramLane&) = delete;
+
+
+    /// \return     the input signal of the next analyze(),
+    ///             64-byte aligned (array has a length of fftLen)
+    ///
+    float* getSignalBuffer();
+
+
+    /// FFT of the signal buffer and the new row of the CPU history,
+    /// makes no OpenGL calls
+    ///
+    /// \param signalLen    number of samples in the signal buffer,
+    ///                     the rest is zero padded
+    ///
+    void analyze(const int signalLen);
+
+
+    /// Upload the history to the grid, or compute the new row on the GPU
+    /// with the GPU spectrum, skipped if there is nothing new
+    ///
+    /// \param analyzed     analyze() was called since the last upload
+    ///
+    void upload(const bool analyzed);
+
+
+    /// Convert the history to another storage format, through float
+    ///
+    void setZFormat(gridZFormat format);
+
+    /// Linear power instead of dB in [0, 1] (see rect.vs),
+    /// the history is cleared when it changes
+    ///
+    void setPowerInput(bool powerInput);
+
+    /// Rows computed by SpectrumFeedback instead of the CPU,
+    /// the history is cleared when it changes
+    ///
+    void setGPUSpectrum(bool gpuSpectrum);
+
+    /// Weight of the previous row in the GPU spectrum
+    ///
+    void setGPUSpectrumSmoothing(float smoothing);
+
+
+    /// Zero the history, e.g. when the lane shows another signal
+    ///
+    void clear();
+
+
+    Grid& getGrid();
+
+    /// \return     the last analysed row, [DC bin1 ... bin(fftLen/2 - 1)],
+    ///             dB in [0, 1] or linear power (see setPowerInput)
+    ///
+    float* getMagnitude();
+
+private:
+    int nRowsV, nColsV;
+    int fftLen;
+
+    // only one of z and z16 holds the history at a time
+    std::vector<float> z;
+    std::vector<uint16_t> z16;
+
+    Grid grid;
+    SpectrumFeedback spectrumFeedback;
+
+    bool powerInput;
+    bool gpuSpectrum;
+    bool zDirty;
+
+    // fftLen, aligned for pffft
+    float* signalBuffer;
+    float* complexBuffer;
+    float* workBuffer;
+
+    std::vector<float> magnitudeBuffer;
+
+    // column-direction blurring (see smoothingBlurRow),
+    // work rows of fftLen/2 aligned to 64 bytes
+    static constexpr int s_N_CONV_ROWS = 10; // 10 seems good for freqPlot
+    float colKernel[s_N_CONV_ROWS];
+    float* previousRows;
+    float* workRow;
+    float* workFFTRow;
+    float* workConvRow;
+};
+
+
+/// Analyze the lanes in parallel with OpenMP, one after another without
+///
+/// \param lanes        lanes to analyze (array must have a length of nLanes)
+///
+/// \param nLanes       number of lanes
+///
+/// \param signalLen    see SpectrogramLane::analyze
+///
+void spectrogramLaneAnalyzeAll(SpectrogramLane* const* lanes,
+                               const int nLanes,
+                               const int signalLen);
+
+#endif
@@ -0,0 +1,182 @@
+#include "spectrum_feedback.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+SpectrumFeedback::SpectrumFeedback(const char* vertexPath,
+                                   const char* fragmentPath,
+                                   const int nRowsV,
+                                   const int nColsV,
+                                   const int fftLen,
+                                   const char* cacheDir)
+    :   shader(vertexPath, fragmentPath, cacheDir, "zOut"),
+        nRowsV(nRowsV), nColsV(nColsV),
+        fftLen(fftLen),
+        floorDB(-120.0f),
+        smoothing(0.0f),
+        rowKernel(1.0f/4.0f, 1.0f/2.0f, 1.0f/4.0f),
+        complexRow(2 * (nColsV + 2), 0.0f),
+        current(0)
+{
+    // the right neighbour of the last column must be a bin below Nyquist
+    assert(nColsV + 2 <= fftLen / 2);
+
+    this->fftLenLog10Loc = shader.getUniformLocation("fftLenLog10");
+    this->floorDBLoc = shader.getUniformLocation("floorDB");
+    this->rowKernelLoc = shader.getUniformLocation("rowKernel");
+    this->smoothingLoc = shader.getUniformLocation("smoothing");
+
+    size_t rowSize = nColsV * sizeof(float);
+
+    glGenBuffers(1, &complexVBO);
+    glGenBuffers(2, rowVBOs);
+    glGenBuffers(1, &scratchVBO);
+    glGenVertexArrays(2, VAOs);
+
+    glBindBuffer(GL_ARRAY_BUFFER, complexVBO);
+    glBufferData(GL_ARRAY_BUFFER, complexRow.size() * sizeof(float),
+                 complexRow.data(), GL_STREAM_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, scratchVBO);
+    glBufferData(GL_ARRAY_BUFFER, (nRowsV - 1) * rowSize, nullptr, GL_STREAM_COPY);
+
+    std::vector<float> zeros(nColsV, 0.0f);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, rowVBOs[i]);
+        glBufferData(GL_ARRAY_BUFFER, rowSize, zeros.data(), GL_STREAM_COPY);
+    }
+
+    // VAO i writes rowVBOs[i] and reads the previous row from the other one
+    for (int i = 0; i < 2; ++i)
+    {
+        glBindVertexArray(VAOs[i]);
+
+        // column j reads bins j, j + 1, and j + 2
+        glBindBuffer(GL_ARRAY_BUFFER, complexVBO);
+        for (int k = 0; k < 3; ++k)
+        {
+            glVertexAttribPointer(k, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                                  (void*)(k * 2 * sizeof(float)));
+            glEnableVertexAttribArray(k);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, rowVBOs[1 - i]);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+        glEnableVertexAttribArray(3);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+SpectrumFeedback::~SpectrumFeedback()
+{
+    glDeleteVertexArrays(2, VAOs);
+    glDeleteBuffers(1, &complexVBO);
+    glDeleteBuffers(2, rowVBOs);
+    glDeleteBuffers(1, &scratchVBO);
+}
+
+
+void SpectrumFeedback::process(const float* complexBuffer, GLuint zBuffer)
+{
+    size_t rowSize = nColsV * sizeof(float);
+
+    // upload the complex row
+    // ----------------------
+    // bin 0 is the left neighbour of column 0, its imaginary slot holds
+    // the Nyquist in pffft's order
+    memcpy(complexRow.data(), complexBuffer, complexRow.size() * sizeof(float));
+    complexRow[1] = 0.0f;
+
+    glBindBuffer(GL_ARRAY_BUFFER, complexVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, complexRow.size() * sizeof(float),
+                    complexRow.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // shift the history up a row
+    // --------------------------
+    glBindBuffer(GL_COPY_READ_BUFFER, zBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scratchVBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        rowSize, 0, (nRowsV - 1) * rowSize);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, scratchVBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, zBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        0, 0, (nRowsV - 1) * rowSize);
+
+    // compute the new row with transform feedback
+    // -------------------------------------------
+    shader.use();
+    shader.setFloat(fftLenLog10Loc, 20.0f * std::log10(static_cast<float>(fftLen)));
+    shader.setFloat(floorDBLoc, -std::fabs(floorDB));
+    shader.setVec3(rowKernelLoc, rowKernel);
+    shader.setFloat(smoothingLoc, smoothing);
+
+    glBindVertexArray(VAOs[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, rowVBOs[current]);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, nColsV);
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+
+    // new row into the last row of the history
+    glBindBuffer(GL_COPY_READ_BUFFER, rowVBOs[current]);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, zBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        0, (nRowsV - 1) * rowSize, rowSize);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // this row is the previous row of the next one
+    this->current = 1 - current;
+}
+
+
+void SpectrumFeedback::reset()
+{
+    std::vector<float> zeros(nColsV, 0.0f);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, rowVBOs[i]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, nColsV * sizeof(float), zeros.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void SpectrumFeedback::setFloorDB(float floorDB)
+{
+    this->floorDB = floorDB;
+}
+
+
+void SpectrumFeedback::setSmoothing(float smoothing)
+{
+    this->smoothing = smoothing;
+}
+
+
+float SpectrumFeedback::getSmoothing()
+{
+    return this->smoothing;
+}
+
+
+void SpectrumFeedback::setRowKernel(float a, float b, float c)
+{
+    this->rowKernel = glm::vec3(a, b, c);
+}
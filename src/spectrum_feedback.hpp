@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+// Experimental GPU spectrum stage with transform feedback
+//
+// OpenGL ES 3.0 has no compute shaders, instead the per-bin math is done in
+// a vertex shader (shader_programs/spectrum.vs) with one vertex per column,
+// its output captured with transform feedback while the rasterizer is off.
+//
+// Each row, the complex FFT output is uploaded and turned into dB scaled to
+// [0, 1] (same as fftComplexToRealDB with scale = true), blurred along the
+// frequency with a 3-tap kernel, and smoothed over time with the previous
+// row. The history in the z buffer of Grid is shifted up a row on the GPU
+// and the new row written to the last row, the CPU never sees the values.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SPECTRUM_FEEDBACK_HPP
+#define SPECTRUM_FEEDBACK_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+
+class SpectrumFeedback
+{
+public:
+    /// \param vertexPath       path to spectrum.vs
+    ///
+    /// \param fragmentPath     path to spectrum.fs
+    ///
+    /// \param nRowsV           number of rows in the z buffer
+    ///
+    /// \param nColsV           number of columns in the z buffer,
+    ///                         column j is FFT bin j + 1,
+    ///                         must be smaller or equal to fftLen/2 - 2
+    ///
+    /// \param fftLen           length of the FFT (see fftInit)
+    ///
+    /// \param cacheDir         program binary cache directory (see Shader),
+    ///                         defaulted to nullptr (no caching)
+    ///
+    SpectrumFeedback(const char* vertexPath,
+                     const char* fragmentPath,
+                     const int nRowsV,
+                     const int nColsV,
+                     const int fftLen,
+                     const char* cacheDir = nullptr);
+
+    ~SpectrumFeedback();
+
+
+    /// Shift the history up a row and compute the new last row on the GPU
+    ///
+    /// \param complexBuffer    output of fftForwardFFT
+    ///                         order: [DC Nyquist real1 imag1 real2 imag2 ...]
+    ///                         (array must have a length of fftLen)
+    ///
+    /// \param zBuffer          the z buffer to write to, in GRID_Z_FLOAT32
+    ///                         (see Grid::getZBuffer)
+    ///
+    void process(const float* complexBuffer, GLuint zBuffer);
+
+
+    /// Forget the previous row, for when the history is cleared
+    ///
+    void reset();
+
+
+    /// Bottom of the dB scaling, defaulted to -120 dB
+    ///
+    void setFloorDB(float floorDB);
+
+    /// Weight of the previous row in [0, 1), defaulted to 0 (none)
+    ///
+    void setSmoothing(float smoothing);
+
+    float getSmoothing();
+
+    /// Frequency direction kernel, a + b + c = 1,
+    /// defaulted to {1/4, 1/2, 1/4} like smoothingBlurRow
+    ///
+    void setRowKernel(float a, float b, float c);
+
+private:
+    Shader shader;
+    GLint fftLenLog10Loc, floorDBLoc, rowKernelLoc, smoothingLoc;
+
+    int nRowsV, nColsV;
+    int fftLen;
+
+    float floorDB;
+    float smoothing;
+    glm::vec3 rowKernel;
+
+    // bins 0 to nColsV + 1 of the complex input, with the Nyquist removed
+    std::vector<float> complexRow;
+    GLuint complexVBO;
+
+    // ping-pong new row / previous row, one VAO each
+    GLuint rowVBOs[2];
+    GLuint VAOs[2];
+    int current;
+
+    // ES 3.0 can't copy between overlapping ranges of the same buffer,
+    // the history is shifted through this buffer
+    GLuint scratchVBO;
+};
+
+#endif
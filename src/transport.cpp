@@ -0,0 +1,199 @@
+#include "transport.hpp"
+
+#include <algorithm>
+
+
+Transport::Transport()
+    :   command(0),
+        state(0),
+        seekFrame(0),
+        loopStartArg(0),
+        loopEndArg(0),
+        totalFrames(0),
+        position(0),
+        isPlaying(false),
+        isLooping(false),
+        loopStart(0),
+        loopEnd(0)
+{
+
+}
+
+
+void Transport::reset(uint64_t totalFrames)
+{
+    this->command.store(0);
+    this->totalFrames = totalFrames;
+    this->position = 0;
+    this->isPlaying = false;
+    this->isLooping = false;
+    this->loopStart = 0;
+    this->loopEnd = 0;
+
+    this->endBlock();
+}
+
+
+void Transport::play()
+{
+    this->post(s_CMD_RUN_CHANGE | s_CMD_RUN, 0);
+}
+
+
+void Transport::pause()
+{
+    this->post(s_CMD_RUN_CHANGE, s_CMD_RUN);
+}
+
+
+void Transport::seek(uint64_t frame)
+{
+    this->seekFrame.store(frame, std::memory_order_relaxed);
+    this->post(s_CMD_SEEK, 0);
+}
+
+
+bool Transport::setLoop(uint64_t startFrame, uint64_t endFrame)
+{
+    if (startFrame >= endFrame)
+    {
+        return false;
+    }
+
+    this->loopStartArg.store(startFrame, std::memory_order_relaxed);
+    this->loopEndArg.store(endFrame, std::memory_order_relaxed);
+    this->post(s_CMD_LOOP | s_CMD_LOOP_ON, 0);
+
+    return true;
+}
+
+
+void Transport::clearLoop()
+{
+    this->post(s_CMD_LOOP, s_CMD_LOOP_ON);
+}
+
+
+uint64_t Transport::getPosition()
+{
+    // a seek not yet applied, so the UI doesn't jump back for a block
+    if (command.load(std::memory_order_acquire) & s_CMD_SEEK)
+    {
+        return seekFrame.load(std::memory_order_relaxed);
+    }
+
+    return state.load(std::memory_order_acquire) >> s_STATE_SHIFT;
+}
+
+
+bool Transport::getIsPlaying()
+{
+    uint32_t cmd = command.load(std::memory_order_acquire);
+
+    if (cmd & s_CMD_RUN_CHANGE)
+    {
+        return (cmd & s_CMD_RUN) != 0;
+    }
+
+    return (state.load(std::memory_order_acquire) & s_STATE_PLAYING) != 0;
+}
+
+
+bool Transport::getIsLooping()
+{
+    return (state.load(std::memory_order_acquire) & s_STATE_LOOPING) != 0;
+}
+
+
+void Transport::beginBlock()
+{
+    // everything posted since the last block, the arguments were stored
+    // before their bits
+    uint32_t cmd = command.exchange(0, std::memory_order_acq_rel);
+
+    if (cmd == 0)
+    {
+        return;
+    }
+
+    if (cmd & s_CMD_SEEK)
+    {
+        this->position = std::min(seekFrame.load(std::memory_order_relaxed),
+                                  totalFrames);
+    }
+
+    if (cmd & s_CMD_LOOP)
+    {
+        this->loopStart = loopStartArg.load(std::memory_order_relaxed);
+        this->loopEnd = std::min(loopEndArg.load(std::memory_order_relaxed),
+                                 totalFrames);
+        this->isLooping = (cmd & s_CMD_LOOP_ON) && loopStart < loopEnd;
+    }
+
+    if (cmd & s_CMD_RUN_CHANGE)
+    {
+        this->isPlaying = (cmd & s_CMD_RUN) != 0;
+
+        // played again after the end
+        if (isPlaying && position >= totalFrames)
+        {
+            this->position = 0;
+        }
+    }
+}
+
+
+uint64_t Transport::nextSegment(uint64_t* frame, uint64_t maxFrames)
+{
+    if (!isPlaying)
+    {
+        return 0;
+    }
+
+    // wrap on the exact frame
+    if (isLooping && position == loopEnd)
+    {
+        this->position = loopStart;
+    }
+
+    uint64_t end = (isLooping && position < loopEnd) ? loopEnd : totalFrames;
+
+    if (position >= end)
+    {
+        // the end of the stream, stopped without a call to the device
+        this->isPlaying = false;
+        return 0;
+    }
+
+    *frame = position;
+    return std::min(maxFrames, end - position);
+}
+
+
+void Transport::advance(uint64_t nFrames)
+{
+    this->position += nFrames;
+}
+
+
+void Transport::endBlock()
+{
+    uint64_t flags = (isPlaying ? s_STATE_PLAYING : 0)
+                     | (isLooping ? s_STATE_LOOPING : 0);
+
+    this->state.store((position << s_STATE_SHIFT) | flags,
+                      std::memory_order_release);
+}
+
+
+void Transport::post(uint32_t set, uint32_t clear)
+{
+    uint32_t cmd = command.load(std::memory_order_relaxed);
+
+    while (!command.compare_exchange_weak(cmd, (cmd & ~clear) | set,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed))
+    {
+        // cmd was reloaded, try again
+    }
+}
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+// Playback transport shared by the UI thread and the audio callback
+//
+// The UI thread posts commands (play, pause, seek, loop) as bits of a single
+// atomic command word, the arguments are stored before the bit is set. The
+// callback takes the whole word at the start of each block, so commands
+// posted together are applied together, and plays the block as segments
+// that end exactly at the loop end or the end of the stream. The position
+// and the playing and looping flags are published in a single atomic state
+// word at the end of the block, so the UI always reads a consistent state.
+//
+// Neither side locks, the callback side makes no system calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include <atomic>
+#include <cstdint>
+
+class Transport
+{
+public:
+    Transport();
+
+    /// Stop at the first frame of a stream, the pending commands and the
+    /// loop are dropped, only while the audio callback isn't running
+    ///
+    /// \param totalFrames  length of the stream in frames
+    ///
+    void reset(uint64_t totalFrames);
+
+
+    // UI thread
+    // ---------
+
+    /// Play from the position, from the beginning if it's at the end
+    ///
+    void play();
+
+    /// Stop at the position
+    ///
+    void pause();
+
+    /// \param frame    next frame to play, clamped to the stream length
+    ///
+    void seek(uint64_t frame);
+
+    /// Play [startFrame, endFrame) over and over once the position is in it,
+    /// past the end of the loop the stream plays to its end
+    ///
+    /// \return     false if the region is empty, the loop is left as is
+    ///
+    bool setLoop(uint64_t startFrame, uint64_t endFrame);
+
+    /// Play through the loop end
+    ///
+    void clearLoop();
+
+    /// \return     next frame to play, as of the last block
+    ///
+    uint64_t getPosition();
+
+    /// \return     whether the last block was played, false once the
+    ///             stream has ended
+    ///
+    bool getIsPlaying();
+
+    /// \return     whether a loop was set as of the last block
+    ///
+    bool getIsLooping();
+
+
+    // audio callback
+    // --------------
+
+    /// Apply the commands posted since the last block
+    ///
+    void beginBlock();
+
+    /// Next frames to play, cut at the loop end and the end of the stream
+    ///
+    /// \param frame        first frame of the segment
+    ///
+    /// \param maxFrames    frames left in the block
+    ///
+    /// \return             number of frames from frame on,
+    ///                     0 if stopped or the stream has ended
+    ///
+    uint64_t nextSegment(uint64_t* frame, uint64_t maxFrames);
+
+    /// \param nFrames  frames of the last segment actually played,
+    ///                 fewer if the source was behind
+    ///
+    void advance(uint64_t nFrames);
+
+    /// Publish the position and flags for the UI thread
+    ///
+    void endBlock();
+
+private:
+    // command bits
+    static constexpr uint32_t s_CMD_RUN_CHANGE = 1u << 0;
+    static constexpr uint32_t s_CMD_RUN = 1u << 1;
+    static constexpr uint32_t s_CMD_SEEK = 1u << 2;
+    static constexpr uint32_t s_CMD_LOOP = 1u << 3;
+    static constexpr uint32_t s_CMD_LOOP_ON = 1u << 4;
+
+    // state word, the position above the flags
+    static constexpr uint64_t s_STATE_PLAYING = 1u << 0;
+    static constexpr uint64_t s_STATE_LOOPING = 1u << 1;
+    static constexpr int s_STATE_SHIFT = 2;
+
+    std::atomic<uint32_t> command;
+    std::atomic<uint64_t> state;
+
+    // arguments, written before their command bit
+    std::atomic<uint64_t> seekFrame;
+    std::atomic<uint64_t> loopStartArg, loopEndArg;
+
+    // owned by the audio callback
+    uint64_t totalFrames;
+    uint64_t position;
+    bool isPlaying;
+    bool isLooping;
+    uint64_t loopStart, loopEnd;
+
+    /// Set and clear command bits in one step
+    void post(uint32_t set, uint32_t clear);
+};
+
+#endif
@@ -0,0 +1,409 @@
+#include "wav_source.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAV_SOURCE_SSE2
+#include <emmintrin.h>
+#endif
+
+// format tags of the fmt chunk
+static constexpr uint16_t s_WAVE_FORMAT_PCM = 0x0001;
+static constexpr uint16_t s_WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static constexpr uint16_t s_WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// WAV is little-endian, read byte by byte so the header can be unaligned
+static uint16_t s_readU16(const uint8_t* bytes);
+static uint32_t s_readU32(const uint8_t* bytes);
+static uint64_t s_readU64(const uint8_t* bytes);
+
+// sample conversions, len is the number of samples
+static void s_u8ToFloat(float* dst, const uint8_t* src, uint64_t len);
+static void s_s16ToFloat(float* dst, const uint8_t* src, uint64_t len);
+static void s_s24ToFloat(float* dst, const uint8_t* src, uint64_t len);
+static void s_s32ToFloat(float* dst, const uint8_t* src, uint64_t len);
+static void s_f64ToFloat(float* dst, const uint8_t* src, uint64_t len);
+
+
+WavSource::WavSource()
+    :   sampleFormat(SampleFormat::NONE),
+        channels(0),
+        sampleRate(0),
+        totalFrames(0),
+        samples(nullptr),
+        bytesPerFrame(0)
+{
+
+}
+
+
+WavSource::~WavSource()
+{
+    this->close();
+}
+
+
+bool WavSource::open(const char* filepath, AudioSourceLoadStatus* status)
+{
+    this->close();
+
+    if (!file.open(filepath))
+    {
+        return false;
+    }
+
+    if (!parseHeader())
+    {
+        std::cout << "Unsupported or corrupted WAV file: " << filepath << std::endl;
+        this->close();
+        return false;
+    }
+
+    if (status != nullptr)
+    {
+        status->bytesTotal.store(file.getSize());
+        status->bytesDone.store(file.getSize());
+    }
+
+    return true;
+}
+
+
+void WavSource::close()
+{
+    file.close();
+
+    this->sampleFormat = SampleFormat::NONE;
+    this->channels = 0;
+    this->sampleRate = 0;
+    this->totalFrames = 0;
+    this->samples = nullptr;
+    this->bytesPerFrame = 0;
+}
+
+
+int WavSource::getChannels()
+{
+    return this->channels;
+}
+
+
+int WavSource::getSampleRate()
+{
+    return this->sampleRate;
+}
+
+
+uint64_t WavSource::getTotalFrames()
+{
+    return this->totalFrames;
+}
+
+
+uint64_t WavSource::readFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    // no read-ahead, the OS pages the mapping in
+    return peekFrames(dst, frame, nFrames);
+}
+
+
+uint64_t WavSource::peekFrames(float* dst, uint64_t frame, uint64_t nFrames)
+{
+    uint64_t n = (frame < totalFrames) ? std::min(nFrames, totalFrames - frame) : 0;
+    uint64_t len = n * channels;
+
+    const uint8_t* src = samples + frame * bytesPerFrame;
+
+    switch (sampleFormat)
+    {
+        case SampleFormat::U8:
+            s_u8ToFloat(dst, src, len);
+            break;
+        case SampleFormat::S16:
+            s_s16ToFloat(dst, src, len);
+            break;
+        case SampleFormat::S24:
+            s_s24ToFloat(dst, src, len);
+            break;
+        case SampleFormat::S32:
+            s_s32ToFloat(dst, src, len);
+            break;
+        case SampleFormat::F32:
+            // already float, the mapping is the only storage
+            memcpy(dst, src, len * sizeof(float));
+            break;
+        case SampleFormat::F64:
+            s_f64ToFloat(dst, src, len);
+            break;
+        default:
+            break;
+    }
+
+    memset(dst + len, 0, (nFrames - n) * channels * sizeof(float));
+
+    return n;
+}
+
+
+bool WavSource::parseHeader()
+{
+    const uint8_t* data = file.getData();
+    uint64_t size = file.getSize();
+
+    if (size < 12
+        || (memcmp(data, "RIFF", 4) != 0 && memcmp(data, "RF64", 4) != 0)
+        || memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool hasFormat = false;
+    uint16_t formatTag = 0;
+    uint16_t blockAlign = 0;
+
+    const uint8_t* dataChunk = nullptr;
+    uint64_t dataSize = 0;
+
+    // RF64 keeps the 64-bit data size in the ds64 chunk
+    uint64_t rf64DataSize = 0;
+
+    // walk the chunks, they are padded to an even size
+    // -------------------------------------------------
+    uint64_t pos = 12;
+    while (pos + 8 <= size && !(hasFormat && dataChunk != nullptr))
+    {
+        const uint8_t* chunk = data + pos;
+        uint64_t chunkSize = s_readU32(chunk + 4);
+        uint64_t bodySize = std::min(chunkSize, size - pos - 8);
+        const uint8_t* body = chunk + 8;
+
+        if (memcmp(chunk, "ds64", 4) == 0 && bodySize >= 16)
+        {
+            rf64DataSize = s_readU64(body + 8);
+        }
+        else if (memcmp(chunk, "fmt ", 4) == 0 && bodySize >= 16)
+        {
+            formatTag = s_readU16(body);
+            this->channels = s_readU16(body + 2);
+            this->sampleRate = static_cast<int>(s_readU32(body + 4));
+            blockAlign = s_readU16(body + 12);
+
+            // the actual format is the first 2 bytes of the sub-format GUID
+            if (formatTag == s_WAVE_FORMAT_EXTENSIBLE && bodySize >= 40)
+            {
+                formatTag = s_readU16(body + 24);
+            }
+
+            hasFormat = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            dataChunk = body;
+            dataSize = (chunkSize == 0xFFFFFFFF && rf64DataSize > 0)
+                       ? rf64DataSize : chunkSize;
+
+            // recordings cut short leave the size of the full take
+            dataSize = std::min(dataSize, size - pos - 8);
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!hasFormat || dataChunk == nullptr
+        || channels <= 0 || sampleRate <= 0 || blockAlign % channels != 0)
+    {
+        return false;
+    }
+
+    // 20-bit in a 24-bit container etc. is left-justified,
+    // only the container size matters
+    int bytesPerSample = blockAlign / channels;
+
+    if (formatTag == s_WAVE_FORMAT_PCM)
+    {
+        switch (bytesPerSample)
+        {
+            case 1: this->sampleFormat = SampleFormat::U8; break;
+            case 2: this->sampleFormat = SampleFormat::S16; break;
+            case 3: this->sampleFormat = SampleFormat::S24; break;
+            case 4: this->sampleFormat = SampleFormat::S32; break;
+            default: return false;
+        }
+    }
+    else if (formatTag == s_WAVE_FORMAT_IEEE_FLOAT)
+    {
+        switch (bytesPerSample)
+        {
+            case 4: this->sampleFormat = SampleFormat::F32; break;
+            case 8: this->sampleFormat = SampleFormat::F64; break;
+            default: return false;
+        }
+    }
+    else
+    {
+        // compressed (ADPCM, mu-law, ...)
+        return false;
+    }
+
+    this->samples = dataChunk;
+    this->bytesPerFrame = blockAlign;
+    this->totalFrames = dataSize / blockAlign;
+
+    return true;
+}
+
+
+uint16_t s_readU16(const uint8_t* bytes)
+{
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+
+uint32_t s_readU32(const uint8_t* bytes)
+{
+    return   static_cast<uint32_t>(bytes[0])
+           | (static_cast<uint32_t>(bytes[1]) << 8)
+           | (static_cast<uint32_t>(bytes[2]) << 16)
+           | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+
+uint64_t s_readU64(const uint8_t* bytes)
+{
+    return s_readU32(bytes) | (static_cast<uint64_t>(s_readU32(bytes + 4)) << 32);
+}
+
+
+void s_u8ToFloat(float* dst, const uint8_t* src, uint64_t len)
+{
+    const float scale = 1.0f / 128.0f;
+    uint64_t i = 0;
+
+#ifdef WAV_SOURCE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128 scaleV = _mm_set1_ps(scale);
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+
+        // unsigned bytes to signed 16-bit centred on 0
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias);
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), bias);
+
+        // sign extend to 32-bit, (x << 16) >> 16
+        __m128i v0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16);
+        __m128i v1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16);
+        __m128i v2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16);
+        __m128i v3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16);
+
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(v0), scaleV));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(v1), scaleV));
+        _mm_storeu_ps(&dst[i + 8], _mm_mul_ps(_mm_cvtepi32_ps(v2), scaleV));
+        _mm_storeu_ps(&dst[i + 12], _mm_mul_ps(_mm_cvtepi32_ps(v3), scaleV));
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        dst[i] = (static_cast<int>(src[i]) - 128) * scale;
+    }
+}
+
+
+void s_s16ToFloat(float* dst, const uint8_t* src, uint64_t len)
+{
+    const float scale = 1.0f / 32768.0f;
+    uint64_t i = 0;
+
+#ifdef WAV_SOURCE_SSE2
+    const __m128 scaleV = _mm_set1_ps(scale);
+
+    for (; i + 8 <= len; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[2 * i]));
+
+        // sign extend to 32-bit, (x << 16) >> 16
+        __m128i v0 = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i v1 = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(v0), scaleV));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(v1), scaleV));
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        int16_t sample = static_cast<int16_t>(s_readU16(&src[2 * i]));
+        dst[i] = sample * scale;
+    }
+}
+
+
+void s_s24ToFloat(float* dst, const uint8_t* src, uint64_t len)
+{
+    // SSE2 has no byte shuffle for the 3-byte stride,
+    // the shifts and the scaling vectorize well enough
+    const float scale = 1.0f / 2147483648.0f;
+
+    for (uint64_t i = 0; i < len; ++i)
+    {
+        const uint8_t* bytes = &src[3 * i];
+
+        // into the top 24 bits, the sign comes for free
+        uint32_t bits =   (static_cast<uint32_t>(bytes[0]) << 8)
+                        | (static_cast<uint32_t>(bytes[1]) << 16)
+                        | (static_cast<uint32_t>(bytes[2]) << 24);
+
+        dst[i] = static_cast<int32_t>(bits) * scale;
+    }
+}
+
+
+void s_s32ToFloat(float* dst, const uint8_t* src, uint64_t len)
+{
+    const float scale = 1.0f / 2147483648.0f;
+    uint64_t i = 0;
+
+#ifdef WAV_SOURCE_SSE2
+    const __m128 scaleV = _mm_set1_ps(scale);
+
+    for (; i + 4 <= len; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[4 * i]));
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(v), scaleV));
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        int32_t sample = static_cast<int32_t>(s_readU32(&src[4 * i]));
+        dst[i] = sample * scale;
+    }
+}
+
+
+void s_f64ToFloat(float* dst, const uint8_t* src, uint64_t len)
+{
+    uint64_t i = 0;
+
+#ifdef WAV_SOURCE_SSE2
+    for (; i + 4 <= len; i += 4)
+    {
+        __m128d v0 = _mm_loadu_pd(reinterpret_cast<const double*>(&src[8 * i]));
+        __m128d v1 = _mm_loadu_pd(reinterpret_cast<const double*>(&src[8 * i + 16]));
+
+        _mm_storeu_ps(&dst[i], _mm_movelh_ps(_mm_cvtpd_ps(v0), _mm_cvtpd_ps(v1)));
+    }
+#endif
+
+    for (; i < len; ++i)
+    {
+        double sample;
+        memcpy(&sample, &src[8 * i], sizeof(double));
+        dst[i] = static_cast<float>(sample);
+    }
+}
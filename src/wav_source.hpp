@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+// Memory-mapped WAV reader
+//
+// The file is mapped instead of loaded (see mapped_file.hpp) and samples are
+// converted to float only for the frames that are read, straight from the
+// mapping into the caller's buffer. Float-32 files are copied as they are,
+// integer PCM is converted with SSE2 when available.
+//
+// Supports PCM 8/16/24/32-bit, IEEE float 32/64-bit, WAVE_FORMAT_EXTENSIBLE,
+// and RF64 for files over 4 GB.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef WAV_SOURCE_HPP
+#define WAV_SOURCE_HPP
+
+#include "audio_source.hpp"
+#include "mapped_file.hpp"
+
+class WavSource : public AudioSource
+{
+public:
+    WavSource();
+    ~WavSource();
+
+    WavSource(const WavSource&) = delete;
+    WavSource& operator=(const WavSource&) = delete;
+
+    /// Map a .wav file and parse its header
+    ///
+    /// \param status   progress while opening, can be nullptr,
+    ///                 mapping doesn't read the file so it completes at once
+    ///
+    /// \return         false if the file can't be mapped or the format
+    ///                 is not supported
+    ///
+    bool open(const char* filepath, AudioSourceLoadStatus* status = nullptr);
+
+    /// Unmap the file
+    ///
+    void close();
+
+    int getChannels() override;
+    int getSampleRate() override;
+    uint64_t getTotalFrames() override;
+
+    /// Thread safe, nothing is buffered
+    uint64_t readFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+    uint64_t peekFrames(float* dst, uint64_t frame, uint64_t nFrames) override;
+
+private:
+    enum class SampleFormat
+    {
+        NONE,
+        U8,
+        S16,
+        S24,
+        S32,
+        F32,
+        F64
+    };
+
+    MappedFile file;
+
+    SampleFormat sampleFormat;
+    int channels;
+    int sampleRate;
+    uint64_t totalFrames;
+
+    // location of the sample data in the mapping
+    const uint8_t* samples;
+    uint64_t bytesPerFrame;
+
+    bool parseHeader();
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "wav_writer.hpp"
+
+#include <cstring>
+#include <iostream>
+
+static constexpr uint16_t s_WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+
+// RIFF + WAVE, JUNK (or ds64), fmt, data
+static constexpr uint64_t s_JUNK_SIZE = 28;
+static constexpr uint64_t s_FMT_SIZE = 16;
+static constexpr uint64_t s_HEADER_SIZE = 12 + (8 + s_JUNK_SIZE) + (8 + s_FMT_SIZE) + 8;
+
+static void s_putU16(uint8_t* bytes, uint16_t value);
+static void s_putU32(uint8_t* bytes, uint32_t value);
+static void s_putU64(uint8_t* bytes, uint64_t value);
+
+
+WavWriter::WavWriter()
+    :   file(nullptr),
+        channels(0),
+        sampleRate(0),
+        framesWritten(0)
+{
+
+}
+
+
+WavWriter::~WavWriter()
+{
+    this->close();
+}
+
+
+bool WavWriter::open(const char* filepath, int channels, int sampleRate)
+{
+    this->close();
+
+    this->file = fopen(filepath, "wb");
+    if (file == nullptr)
+    {
+        std::cout << "Failed to create WAV file: " << filepath << std::endl;
+        return false;
+    }
+
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+    this->framesWritten = 0;
+
+    // sizes are patched on close
+    if (!writeHeader(0))
+    {
+        std::cout << "Failed to write WAV header: " << filepath << std::endl;
+        fclose(file);
+        this->file = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool WavWriter::write(const float* frames, uint64_t nFrames)
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    size_t len = nFrames * channels;
+    size_t nWritten = fwrite(frames, sizeof(float), len, file);
+
+    this->framesWritten += nWritten / channels;
+
+    return nWritten == len;
+}
+
+
+bool WavWriter::flush()
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    uint64_t dataSize = framesWritten * channels * sizeof(float);
+
+    // back to the end for the next write
+    bool isWritten = (fseek(file, 0, SEEK_SET) == 0) && writeHeader(dataSize);
+    isWritten = (fseek(file, 0, SEEK_END) == 0) && isWritten;
+
+    return (fflush(file) == 0) && isWritten;
+}
+
+
+bool WavWriter::close()
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    uint64_t dataSize = framesWritten * channels * sizeof(float);
+
+    bool isWritten = (fseek(file, 0, SEEK_SET) == 0) && writeHeader(dataSize);
+    isWritten = (fclose(file) == 0) && isWritten;
+
+    this->file = nullptr;
+
+    return isWritten;
+}
+
+
+bool WavWriter::getIsOpen()
+{
+    return this->file != nullptr;
+}
+
+
+uint64_t WavWriter::getFramesWritten()
+{
+    return this->framesWritten;
+}
+
+
+bool WavWriter::writeHeader(uint64_t dataSize)
+{
+    uint8_t header[s_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+
+    uint64_t riffSize = s_HEADER_SIZE - 8 + dataSize;
+    bool isRF64 = riffSize > 0xFFFFFFFF;
+
+    uint8_t* chunk = header;
+
+    memcpy(chunk, isRF64 ? "RF64" : "RIFF", 4);
+    s_putU32(chunk + 4, isRF64 ? 0xFFFFFFFF : static_cast<uint32_t>(riffSize));
+    memcpy(chunk + 8, "WAVE", 4);
+    chunk += 12;
+
+    // placeholder, or the 64-bit sizes
+    memcpy(chunk, isRF64 ? "ds64" : "JUNK", 4);
+    s_putU32(chunk + 4, s_JUNK_SIZE);
+    if (isRF64)
+    {
+        uint64_t bytesPerFrame = channels * sizeof(float);
+
+        s_putU64(chunk + 8, riffSize);
+        s_putU64(chunk + 16, dataSize);
+        s_putU64(chunk + 24, dataSize / bytesPerFrame);
+        // no table, chunk + 32 stays 0
+    }
+    chunk += 8 + s_JUNK_SIZE;
+
+    uint16_t blockAlign = static_cast<uint16_t>(channels * sizeof(float));
+
+    memcpy(chunk, "fmt ", 4);
+    s_putU32(chunk + 4, s_FMT_SIZE);
+    s_putU16(chunk + 8, s_WAVE_FORMAT_IEEE_FLOAT);
+    s_putU16(chunk + 10, static_cast<uint16_t>(channels));
+    s_putU32(chunk + 12, static_cast<uint32_t>(sampleRate));
+    s_putU32(chunk + 16, static_cast<uint32_t>(sampleRate) * blockAlign);
+    s_putU16(chunk + 20, blockAlign);
+    s_putU16(chunk + 22, 32);
+    chunk += 8 + s_FMT_SIZE;
+
+    memcpy(chunk, "data", 4);
+    s_putU32(chunk + 4, isRF64 ? 0xFFFFFFFF : static_cast<uint32_t>(dataSize));
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+
+void s_putU16(uint8_t* bytes, uint16_t value)
+{
+    bytes[0] = static_cast<uint8_t>(value);
+    bytes[1] = static_cast<uint8_t>(value >> 8);
+}
+
+
+void s_putU32(uint8_t* bytes, uint32_t value)
+{
+    s_putU16(bytes, static_cast<uint16_t>(value));
+    s_putU16(bytes + 2, static_cast<uint16_t>(value >> 16));
+}
+
+
+void s_putU64(uint8_t* bytes, uint64_t value)
+{
+    s_putU32(bytes, static_cast<uint32_t>(value));
+    s_putU32(bytes + 4, static_cast<uint32_t>(value >> 32));
+}
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+// Float-32 WAV file writer
+//
+// Frames are appended as they come and the sizes in the header are patched
+// on close(). A JUNK chunk is reserved after the RIFF header, so files over
+// 4 GB become RF64 in place (EBU Tech 3306), readable by WavSource.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef WAV_WRITER_HPP
+#define WAV_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+
+class WavWriter
+{
+public:
+    WavWriter();
+    ~WavWriter();
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    /// Create the file and write a header, closing the previous one
+    ///
+    /// \return     false if the file can't be created
+    ///
+    bool open(const char* filepath, int channels, int sampleRate);
+
+    /// Append interleaved float frames
+    ///
+    /// \return     false on a write error
+    ///
+    bool write(const float* frames, uint64_t nFrames);
+
+    /// Patch the header with the frames written so far and push them to
+    /// disk, so the file reads as complete while it's still being written
+    ///
+    /// \return     false if nothing was open or the header can't be written
+    ///
+    bool flush();
+
+    /// Patch the header and close the file
+    ///
+    /// \return     false if nothing was open or the header can't be written
+    ///
+    bool close();
+
+    bool getIsOpen();
+
+    uint64_t getFramesWritten();
+
+private:
+    FILE* file;
+    int channels;
+    int sampleRate;
+    uint64_t framesWritten;
+
+    bool writeHeader(uint64_t dataSize);
+};
+
+#endif
@@ -87,6 +87,31 @@ TEST(Array2DTest, MoveRowsUpTest)
     );
 }
 
+
+TEST(Array2DTest, MoveRowsUpUint16Test)
+{
+    const unsigned int nRows = 4;
+    const unsigned int nCols = 3;
+
+    std::vector<uint16_t> array = {
+        1, 2, 3,
+        4, 5, 6,
+        7, 8, 9,
+        65533, 65534, 65535
+    };
+
+    const std::vector<uint16_t> expectedArray = {
+        7, 8, 9,
+        65533, 65534, 65535,
+        7, 8, 9,
+        65533, 65534, 65535
+    };
+
+    array2dMoveRowsUp(array.data(), nRows, nCols, 2);
+
+    EXPECT_EQ(array, expectedArray);
+}
+
 TEST(Array2DTest, ElementIndicesTest)
 {
     // 1x1 cell
@@ -117,6 +142,63 @@ TEST(Array2DTest, ElementIndicesTest)
     EXPECT_EQ(indices3x4, expected3x4);
 }
 
+TEST(Array2DTest, ElementIndicesOrderedTest)
+{
+    // row forward is the same as array2dElementIndices
+    std::vector<int> expected3x4(3 * 4 * 6);
+    array2dElementIndices(expected3x4.data(), 3, 4);
+
+    std::vector<int> rowForward(3 * 4 * 6);
+    array2dElementIndicesOrdered(rowForward.data(), 3, 4, ARRAY2D_ROW_FORWARD);
+
+    EXPECT_EQ(rowForward, expected3x4);
+
+    // 2x3 cells
+    //  0---1---2---3
+    //  | / | / | / |
+    //  4---5---6---7
+    //  | / | / | / |
+    //  8---9--10--11
+    std::vector<int> rowReverse(2 * 3 * 6);
+    array2dElementIndicesOrdered(rowReverse.data(), 2, 3, ARRAY2D_ROW_REVERSE);
+    const std::vector<int> expectedRowReverse = {
+         5,  4,  8,   8,  9,  5,
+         6,  5,  9,   9, 10,  6,
+         7,  6, 10,  10, 11,  7,
+         1,  0,  4,   4,  5,  1,
+         2,  1,  5,   5,  6,  2,
+         3,  2,  6,   6,  7,  3
+    };
+
+    EXPECT_EQ(rowReverse, expectedRowReverse);
+
+    std::vector<int> colForward(2 * 3 * 6);
+    array2dElementIndicesOrdered(colForward.data(), 2, 3, ARRAY2D_COL_FORWARD);
+    const std::vector<int> expectedColForward = {
+         1,  0,  4,   4,  5,  1,
+         5,  4,  8,   8,  9,  5,
+         2,  1,  5,   5,  6,  2,
+         6,  5,  9,   9, 10,  6,
+         3,  2,  6,   6,  7,  3,
+         7,  6, 10,  10, 11,  7
+    };
+
+    EXPECT_EQ(colForward, expectedColForward);
+
+    std::vector<int> colReverse(2 * 3 * 6);
+    array2dElementIndicesOrdered(colReverse.data(), 2, 3, ARRAY2D_COL_REVERSE);
+    const std::vector<int> expectedColReverse = {
+         3,  2,  6,   6,  7,  3,
+         7,  6, 10,  10, 11,  7,
+         2,  1,  5,   5,  6,  2,
+         6,  5,  9,   9, 10,  6,
+         1,  0,  4,   4,  5,  1,
+         5,  4,  8,   8,  9,  5
+    };
+
+    EXPECT_EQ(colReverse, expectedColReverse);
+}
+
 TEST(Array2DTest, PatchIndicesTest)
 {
     // 1x1 cell
@@ -0,0 +1,108 @@
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "../src/batch_analysis.hpp"
+#include "../src/fft.hpp"
+#include "../src/wav_writer.hpp"
+
+static const double s_PI = 3.14159265358979323846;
+
+/// Read the rows of a .npy written by NpyWriter
+static std::vector<float> s_readNpy(const char* filepath, size_t nCols, size_t& nRows)
+{
+    std::vector<float> rows;
+    nRows = 0;
+
+    FILE* file = fopen(filepath, "rb");
+    if (file == nullptr)
+    {
+        return rows;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 128, SEEK_SET);
+
+    rows.resize((size - 128) / sizeof(float));
+    nRows = fread(rows.data(), sizeof(float), rows.size(), file) / nCols;
+    fclose(file);
+
+    return rows;
+}
+
+
+TEST(BatchAnalysisTest, SineTest)
+{
+    const int fftLen = 1024;
+    const int sampleRate = 16000;
+    const int nFrames = sampleRate;
+    const double freq = 1000.0;
+
+    // stereo sine, the same in both channels
+    std::vector<float> frames(nFrames * 2);
+    for (int i = 0; i < nFrames; ++i)
+    {
+        frames[i * 2] = frames[i * 2 + 1] = static_cast<float>(
+            0.5 * std::sin(2.0 * s_PI * freq * i / sampleRate));
+    }
+
+    const char* inputPath = "batch_analysis_test.wav";
+    const char* outputPath = "batch_analysis_test.npy";
+
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(inputPath, 2, sampleRate));
+    ASSERT_TRUE(writer.write(frames.data(), nFrames));
+    ASSERT_TRUE(writer.close());
+
+    fftInit(fftLen);
+
+    BatchAnalysisOptions options;
+    options.fftLen = fftLen;
+    options.signalLen = 512;
+    options.hopLen = 256;
+    options.smoothing = false;
+
+    BatchAnalyzer analyzer(options);
+    ASSERT_TRUE(analyzer.analyzeFile(inputPath, outputPath));
+
+    // a row for every hop with a full signal
+    uint64_t expectedRows = (nFrames - options.signalLen) / options.hopLen + 1;
+    EXPECT_EQ(analyzer.getRowsWritten(), expectedRows);
+    EXPECT_DOUBLE_EQ(analyzer.getAudioSeconds(), 1.0);
+
+    size_t nCols = fftLen / 2 - 2;
+    size_t nRows;
+    std::vector<float> rows = s_readNpy(outputPath, nCols, nRows);
+    ASSERT_EQ(nRows, expectedRows);
+
+    // column j is bin j + 1
+    int sineBin = static_cast<int>(std::round(freq * fftLen / sampleRate));
+    for (size_t i = 0; i < nRows; ++i)
+    {
+        const float* row = &rows[i * nCols];
+        int peak = static_cast<int>(std::max_element(row, row + nCols) - row);
+
+        ASSERT_NEAR(peak + 1, sineBin, 1) << "row " << i;
+    }
+
+    // resampled, the sine moves to the bin of the new rate
+    options.sampleRate = 8000;
+    BatchAnalyzer resampledAnalyzer(options);
+    ASSERT_TRUE(resampledAnalyzer.analyzeFile(inputPath, outputPath));
+
+    rows = s_readNpy(outputPath, nCols, nRows);
+    ASSERT_GT(nRows, 2u);
+
+    const float* row = &rows[(nRows / 2) * nCols];
+    int peak = static_cast<int>(std::max_element(row, row + nCols) - row);
+    EXPECT_NEAR(peak + 1, std::round(freq * fftLen / 8000), 1);
+
+    fftCleanUp();
+
+    EXPECT_FALSE(analyzer.analyzeFile("missing.wav", outputPath));
+
+    remove(inputPath);
+    remove(outputPath);
+}
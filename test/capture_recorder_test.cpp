@@ -0,0 +1,216 @@
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include "../src/capture_recorder.hpp"
+#include "../src/sample_ring.hpp"
+#include "../src/wav_source.hpp"
+
+/// Samples valued by their count
+static std::vector<float> s_counting(uint64_t from, uint64_t nSamples)
+{
+    std::vector<float> samples(nSamples);
+    for (uint64_t i = 0; i < nSamples; ++i)
+    {
+        samples[i] = static_cast<float>(from + i);
+    }
+    return samples;
+}
+
+
+/// Path of the n-th file, from the path of any of them
+static std::string s_filePath(const std::string& anyPath, int n)
+{
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "_%03d.wav", n);
+
+    // "_NNN.wav"
+    return anyPath.substr(0, anyPath.size() - 8) + suffix;
+}
+
+
+TEST(CaptureRecorderTest, RotateTest)
+{
+    const int channels = 2;
+    const int sampleRate = 1000;
+    const uint64_t nFrames = 25000;
+
+    // room for more than a poll interval of blocks
+    SampleRing ring;
+    ring.allocate(1 << 16);
+
+    // published before start() isn't recorded
+    ring.write(s_counting(0, 100).data(), 100);
+    const uint64_t first = ring.getWriteCount();
+
+    // split every 4 s, 4000 frames
+    CaptureRecorder recorder;
+    ASSERT_TRUE(recorder.start(&ring, channels, sampleRate, ".", 4));
+
+    // faster than real time, still within the ring between two polls
+    const uint64_t blockFrames = 256;
+    for (uint64_t frame = 0; frame < nFrames; frame += blockFrames)
+    {
+        uint64_t len = std::min(blockFrames, nFrames - frame) * channels;
+        ring.write(s_counting(first + frame * channels, len).data(), len);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    recorder.stop();
+    EXPECT_FALSE(recorder.getIsRecording());
+    EXPECT_EQ(recorder.getFramesDropped(), 0u);
+    EXPECT_EQ(recorder.getFramesWritten(), nFrames);
+    ASSERT_EQ(recorder.getFileCount(), 7);
+
+    // continuous across the files
+    uint64_t frame = 0;
+    for (int n = 0; n < recorder.getFileCount(); ++n)
+    {
+        std::string filepath = s_filePath(recorder.getOutputPath(), n);
+
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath.c_str()));
+        EXPECT_EQ(source.getChannels(), channels);
+        EXPECT_EQ(source.getSampleRate(), sampleRate);
+
+        uint64_t fileFrames = source.getTotalFrames();
+        EXPECT_EQ(fileFrames, std::min<uint64_t>(4000, nFrames - frame));
+
+        std::vector<float> read(fileFrames * channels);
+        EXPECT_EQ(source.readFrames(read.data(), 0, fileFrames), fileFrames);
+        EXPECT_EQ(read, s_counting(first + frame * channels, fileFrames * channels));
+
+        frame += fileFrames;
+
+        source.close();
+        remove(filepath.c_str());
+    }
+}
+
+
+TEST(CaptureRecorderTest, OverrunTest)
+{
+    SampleRing ring;
+    ring.allocate(1024);
+
+    CaptureRecorder recorder;
+    ASSERT_TRUE(recorder.start(&ring, 1, 48000, "."));
+
+    // far more than the ring holds in one go, the writer can only keep
+    // the newest half of the ring
+    ring.write(s_counting(0, 4096).data(), 4096);
+
+    recorder.stop();
+    EXPECT_EQ(recorder.getFramesDropped(), 4096u - 512u);
+    EXPECT_EQ(recorder.getFramesWritten(), 4096u);
+
+    std::string filepath = recorder.getOutputPath();
+
+    // as long as the capture, silence where it was dropped
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath.c_str()));
+    ASSERT_EQ(source.getTotalFrames(), 4096u);
+
+    std::vector<float> read(4096);
+    EXPECT_EQ(source.readFrames(read.data(), 0, 4096), 4096u);
+
+    std::vector<float> expected(4096 - 512, 0.0f);
+    std::vector<float> kept = s_counting(4096 - 512, 512);
+    expected.insert(expected.end(), kept.begin(), kept.end());
+    EXPECT_EQ(read, expected);
+
+    source.close();
+    remove(filepath.c_str());
+}
+
+
+TEST(CaptureRecorderTest, GapTest)
+{
+    const int channels = 2;
+
+    SampleRing ring;
+    ring.allocate(1024);
+
+    // split every 1000 frames, the gap runs across files
+    CaptureRecorder recorder;
+    ASSERT_TRUE(recorder.start(&ring, channels, 1000, ".", 1));
+
+    // written before the overrun
+    ring.write(s_counting(0, 300).data(), 300);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(recorder.getFramesWritten(), 150u);
+
+    // then the writer falls behind, the newest half of the ring is kept
+    ring.write(s_counting(300, 4000).data(), 4000);
+
+    recorder.stop();
+    EXPECT_EQ(recorder.getFramesDropped(), (4000u - 512u) / channels);
+    EXPECT_EQ(recorder.getFramesWritten(), 4300u / channels);
+    ASSERT_EQ(recorder.getFileCount(), 3);
+
+    std::vector<float> expected = s_counting(0, 300);
+    expected.resize(4300 - 512, 0.0f);
+    std::vector<float> kept = s_counting(4300 - 512, 512);
+    expected.insert(expected.end(), kept.begin(), kept.end());
+
+    // the files together are as long as the capture
+    std::vector<float> read;
+    for (int n = 0; n < recorder.getFileCount(); ++n)
+    {
+        std::string filepath = s_filePath(recorder.getOutputPath(), n);
+
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath.c_str()));
+
+        uint64_t fileFrames = source.getTotalFrames();
+        std::vector<float> fileRead(fileFrames * channels);
+        EXPECT_EQ(source.readFrames(fileRead.data(), 0, fileFrames), fileFrames);
+        read.insert(read.end(), fileRead.begin(), fileRead.end());
+
+        source.close();
+        remove(filepath.c_str());
+    }
+
+    EXPECT_EQ(read, expected);
+}
+
+
+TEST(CaptureRecorderTest, RestartTest)
+{
+    SampleRing ring;
+    ring.allocate(1 << 16);
+
+    CaptureRecorder recorder;
+    ASSERT_TRUE(recorder.start(&ring, 1, 1000, "."));
+    ring.write(s_counting(0, 1000).data(), 1000);
+    recorder.stop();
+    std::string firstPath = recorder.getOutputPath();
+
+    // e.g. after the ring is reallocated, within the same second
+    ASSERT_TRUE(recorder.start(&ring, 1, 1000, "."));
+    ring.write(s_counting(1000, 500).data(), 500);
+    recorder.stop();
+    std::string secondPath = recorder.getOutputPath();
+
+    // in another file, the first one is left as it was
+    EXPECT_NE(firstPath, secondPath);
+
+    WavSource source;
+    ASSERT_TRUE(source.open(firstPath.c_str()));
+    EXPECT_EQ(source.getTotalFrames(), 1000u);
+    source.close();
+
+    ASSERT_TRUE(source.open(secondPath.c_str()));
+    EXPECT_EQ(source.getTotalFrames(), 500u);
+
+    std::vector<float> read(500);
+    EXPECT_EQ(source.readFrames(read.data(), 0, 500), 500u);
+    EXPECT_EQ(read, s_counting(1000, 500));
+    source.close();
+
+    remove(firstPath.c_str());
+    remove(secondPath.c_str());
+}
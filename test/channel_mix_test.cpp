@@ -0,0 +1,129 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "../src/channel_mix.hpp"
+
+/// Interleaved frames with sample i * channels + c = (c + 1) * (i - 3)
+static std::vector<float> s_makeFrames(int nFrames, int channels)
+{
+    std::vector<float> frames(nFrames * channels);
+    for (int i = 0; i < nFrames; ++i)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            frames[i * channels + c] = (c + 1) * static_cast<float>(i - 3);
+        }
+    }
+    return frames;
+}
+
+
+TEST(ChannelMixTest, DownmixTest)
+{
+    // longer than one SIMD block, with a scalar tail
+    const int nFrames = 11;
+
+    for (int channels = 1; channels <= 6; ++channels)
+    {
+        std::vector<float> src = s_makeFrames(nFrames, channels);
+        std::vector<float> dst(nFrames);
+
+        channelMixDownmix(dst.data(), src.data(), nFrames, channels);
+
+        // mean of (c + 1) over the channels is (channels + 1) / 2
+        for (int i = 0; i < nFrames; ++i)
+        {
+            EXPECT_FLOAT_EQ(dst[i], 0.5f * (channels + 1) * (i - 3))
+                << "channels " << channels << ", frame " << i;
+        }
+    }
+}
+
+
+TEST(ChannelMixTest, ExtractTest)
+{
+    const int nFrames = 11;
+
+    for (int channels = 1; channels <= 6; ++channels)
+    {
+        std::vector<float> src = s_makeFrames(nFrames, channels);
+        std::vector<float> dst(nFrames);
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            channelMixExtract(dst.data(), src.data(), nFrames, channels, channel);
+
+            for (int i = 0; i < nFrames; ++i)
+            {
+                EXPECT_EQ(dst[i], src[i * channels + channel]);
+            }
+        }
+    }
+}
+
+
+TEST(ChannelMixTest, MidSideTest)
+{
+    const int nFrames = 11;
+
+    for (int channels = 2; channels <= 3; ++channels)
+    {
+        std::vector<float> src = s_makeFrames(nFrames, channels);
+        std::vector<float> mid(nFrames);
+        std::vector<float> side(nFrames);
+
+        channelMixMidSide(mid.data(), side.data(), src.data(), nFrames, channels);
+
+        // mid + side = L, mid - side = R
+        for (int i = 0; i < nFrames; ++i)
+        {
+            EXPECT_FLOAT_EQ(mid[i] + side[i], src[i * channels]);
+            EXPECT_FLOAT_EQ(mid[i] - side[i], src[i * channels + 1]);
+        }
+    }
+
+    // identical channels have no side
+    std::vector<float> dual = {1.0f, 1.0f, -2.0f, -2.0f, 3.0f, 3.0f,
+                               0.5f, 0.5f, 7.0f, 7.0f};
+    std::vector<float> mid(5);
+    std::vector<float> side(5);
+
+    channelMixMidSide(mid.data(), side.data(), dual.data(), 5, 2);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(mid[i], dual[2 * i]);
+        EXPECT_EQ(side[i], 0.0f);
+    }
+}
+
+
+TEST(ChannelMixTest, NumOutputsTest)
+{
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_DOWNMIX, 2), 1);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_SELECT, 2), 1);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_SPLIT, 2), 2);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_MID_SIDE, 6), 2);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_EACH, 6), 6);
+
+    // a mono input is drawn once whatever the mode
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_SPLIT, 1), 1);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_MID_SIDE, 1), 1);
+    EXPECT_EQ(channelMixGetNumOutputs(CHANNEL_MIX_EACH, 1), 1);
+}
+
+
+TEST(ChannelMixTest, TilesTest)
+{
+    const int expected[][2] = {
+        {1, 1}, {2, 1}, {2, 2}, {2, 2}, {3, 2}, {3, 2}, {3, 3}, {3, 3}
+    };
+
+    for (int n = 1; n <= 8; ++n)
+    {
+        int nCols, nRows;
+        channelMixGetTiles(n, &nCols, &nRows);
+        EXPECT_EQ(nCols, expected[n - 1][0]);
+        EXPECT_EQ(nRows, expected[n - 1][1]);
+        EXPECT_GE(nCols * nRows, n);
+    }
+}
@@ -0,0 +1,120 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "gmock/gmock.h"
+#include "../src/colormap.hpp"
+
+TEST(ColormapTest, OklabRoundTripTest)
+{
+    const float tolerance = 1e-4f;
+
+    const std::vector<std::vector<float>> colors = {
+        {0.0f, 0.0f, 0.0f},
+        {1.0f, 1.0f, 1.0f},
+        {0.906f, 1.000f, 0.529f},
+        {0.000f, 0.502f, 0.502f},
+        {0.2f, 0.4f, 0.8f}
+    };
+
+    for (const std::vector<float>& rgb : colors)
+    {
+        float lab[3];
+        float result[3];
+        colormapSrgbToOklab(lab, rgb.data());
+        colormapOklabToSrgb(result, lab);
+
+        EXPECT_THAT(
+            result,
+            testing::Pointwise(testing::FloatNear(tolerance), rgb)
+        );
+    }
+
+    // white has lightness 1 and no chroma
+    float white[3] = {1.0f, 1.0f, 1.0f};
+    float lab[3];
+    colormapSrgbToOklab(lab, white);
+
+    EXPECT_NEAR(lab[0], 1.0f, 1e-3f);
+    EXPECT_NEAR(lab[1], 0.0f, 1e-3f);
+    EXPECT_NEAR(lab[2], 0.0f, 1e-3f);
+}
+
+
+TEST(ColormapTest, OklabRampTest)
+{
+    const float tolerance = 1e-4f;
+    const int lutLen = 256;
+
+    const float rgb0[3] = {0.906f, 1.000f, 0.529f};
+    const float rgb1[3] = {0.000f, 0.502f, 0.502f};
+
+    std::vector<float> lut(lutLen * 3);
+    colormapOklabRamp(lut.data(), lutLen, rgb0, rgb1);
+
+    // height 0 is rgb1, height 1 is rgb0
+    EXPECT_THAT(
+        std::vector<float>(lut.begin(), lut.begin() + 3),
+        testing::Pointwise(testing::FloatNear(tolerance), rgb1)
+    );
+    EXPECT_THAT(
+        std::vector<float>(lut.end() - 3, lut.end()),
+        testing::Pointwise(testing::FloatNear(tolerance), rgb0)
+    );
+
+    // lightness increases monotonically along the ramp
+    float lastLightness = -1.0f;
+    for (int i = 0; i < lutLen; ++i)
+    {
+        float lab[3];
+        colormapSrgbToOklab(lab, &lut[3 * i]);
+
+        EXPECT_GT(lab[0], lastLightness);
+        lastLightness = lab[0];
+    }
+}
+
+
+TEST(ColormapTest, FillTest)
+{
+    // the polynomial fit is within ~1.5% of matplotlib's table
+    const float tolerance = 0.02f;
+    const int lutLen = 1024;
+
+    const float rgb0[3] = {1.0f, 1.0f, 1.0f};
+    const float rgb1[3] = {0.0f, 0.0f, 0.0f};
+
+    std::vector<float> lut(lutLen * 3);
+
+    // matplotlib viridis endpoints
+    colormapFill(lut.data(), lutLen, COLORMAP_VIRIDIS, rgb0, rgb1);
+
+    const float expectedStart[3] = {0.267f, 0.005f, 0.329f};
+    const float expectedEnd[3] = {0.993f, 0.906f, 0.144f};
+
+    EXPECT_THAT(
+        std::vector<float>(lut.begin(), lut.begin() + 3),
+        testing::Pointwise(testing::FloatNear(tolerance), expectedStart)
+    );
+    EXPECT_THAT(
+        std::vector<float>(lut.end() - 3, lut.end()),
+        testing::Pointwise(testing::FloatNear(tolerance), expectedEnd)
+    );
+
+    // every colormap is clamped to [0, 1]
+    const colormapType types[] = {
+        COLORMAP_OKLAB, 
+        COLORMAP_VIRIDIS, 
+        COLORMAP_MAGMA, 
+        COLORMAP_INFERNO
+    };
+
+    for (colormapType type : types)
+    {
+        colormapFill(lut.data(), lutLen, type, rgb0, rgb1);
+
+        for (float value : lut)
+        {
+            EXPECT_GE(value, 0.0f);
+            EXPECT_LE(value, 1.0f);
+        }
+    }
+}
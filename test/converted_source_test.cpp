@@ -0,0 +1,176 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "../src/converted_source.hpp"
+#include "../src/resampler.hpp"
+
+static const double s_PI = 3.14159265358979323846;
+
+/// Interleaved frames held in memory
+class MemorySource : public AudioSource
+{
+public:
+    MemorySource(std::vector<float> frames, int channels, int sampleRate)
+        :   frames(frames), channels(channels), sampleRate(sampleRate) {}
+
+    int getChannels() override { return channels; }
+    int getSampleRate() override { return sampleRate; }
+    uint64_t getTotalFrames() override { return frames.size() / channels; }
+
+    uint64_t readFrames(float* dst, uint64_t frame, uint64_t nFrames) override
+    {
+        uint64_t n = std::min(nFrames, getTotalFrames() - std::min(frame, getTotalFrames()));
+        std::copy(frames.begin() + frame * channels,
+                  frames.begin() + (frame + n) * channels,
+                  dst);
+        std::fill(dst + n * channels, dst + nFrames * channels, 0.0f);
+        return n;
+    }
+
+    uint64_t peekFrames(float* dst, uint64_t frame, uint64_t nFrames) override
+    {
+        return readFrames(dst, frame, nFrames);
+    }
+
+private:
+    std::vector<float> frames;
+    int channels;
+    int sampleRate;
+};
+
+
+static std::vector<float> s_makeSines(int nFrames, int channels, int rate,
+                                      const std::vector<double>& freqs)
+{
+    std::vector<float> frames(nFrames * channels);
+    for (int i = 0; i < nFrames; ++i)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            frames[i * channels + c] = static_cast<float>(
+                std::sin(2.0 * s_PI * freqs[c] * i / rate));
+        }
+    }
+    return frames;
+}
+
+
+/// Read the whole source in chunks of chunkLen frames
+static std::vector<float> s_readAll(AudioSource& source, int chunkLen)
+{
+    int channels = source.getChannels();
+    uint64_t totalFrames = source.getTotalFrames();
+    std::vector<float> out(totalFrames * channels);
+
+    for (uint64_t i = 0; i < totalFrames; i += chunkLen)
+    {
+        uint64_t len = std::min<uint64_t>(chunkLen, totalFrames - i);
+        EXPECT_EQ(source.readFrames(&out[i * channels], i, len), len);
+    }
+    return out;
+}
+
+
+TEST(ConvertedSourceTest, ChannelTest)
+{
+    std::vector<float> stereo = s_makeSines(1000, 2, 48000, {440.0, 1000.0});
+    MemorySource stereoSource(stereo, 2, 48000);
+
+    // downmixed to mono
+    ConvertedSource mono(&stereoSource, 1, 48000);
+    ASSERT_EQ(mono.getTotalFrames(), 1000u);
+
+    std::vector<float> monoOut = s_readAll(mono, 300);
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_FLOAT_EQ(monoOut[i], 0.5f * (stereo[i * 2] + stereo[i * 2 + 1]));
+    }
+
+    // mono to every channel
+    MemorySource monoSource(monoOut, 1, 48000);
+    ConvertedSource quad(&monoSource, 4, 48000);
+
+    std::vector<float> quadOut = s_readAll(quad, 256);
+    for (int i = 0; i < 1000; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            EXPECT_EQ(quadOut[i * 4 + c], monoOut[i]);
+        }
+    }
+
+    // the first channels, the rest silent
+    ConvertedSource six(&stereoSource, 6, 48000);
+
+    std::vector<float> sixOut = s_readAll(six, 1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(sixOut[i * 6], stereo[i * 2]);
+        EXPECT_EQ(sixOut[i * 6 + 1], stereo[i * 2 + 1]);
+        for (int c = 2; c < 6; ++c)
+        {
+            EXPECT_EQ(sixOut[i * 6 + c], 0.0f);
+        }
+    }
+}
+
+
+TEST(ConvertedSourceTest, RateTest)
+{
+    std::vector<float> in = s_makeSines(4410, 2, 44100, {440.0, 5000.0});
+    MemorySource source(in, 2, 44100);
+
+    ConvertedSource converted(&source, 2, 48000);
+    ASSERT_EQ(converted.getTotalFrames(), 4800u);
+
+    // the same as resampling the whole stream, up to the end
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(2, 44100, 48000));
+
+    std::vector<float> padded(in);
+    padded.resize(in.size() + resampler.getNumTaps() * 2, 0.0f);
+    std::vector<float> expected(resampler.getMaxOutputFrames(padded.size() / 2) * 2);
+    resampler.process(padded.data(), padded.size() / 2, expected.data());
+
+    for (int chunkLen : {1, 100, 4096})
+    {
+        ConvertedSource chunked(&source, 2, 48000);
+        std::vector<float> out = s_readAll(chunked, chunkLen);
+
+        ASSERT_LE(out.size(), expected.size());
+        EXPECT_TRUE(std::equal(out.begin(), out.end(), expected.begin()))
+            << "chunks of " << chunkLen;
+    }
+}
+
+
+TEST(ConvertedSourceTest, SeekTest)
+{
+    std::vector<float> in = s_makeSines(8000, 1, 44100, {1000.0});
+    MemorySource source(in, 1, 44100);
+
+    ConvertedSource converted(&source, 1, 48000);
+    std::vector<float> whole = s_readAll(converted, 512);
+
+    // reading elsewhere restarts there, peeking leaves playback alone
+    std::vector<float> seeked(700);
+    std::vector<float> peeked(100);
+
+    EXPECT_EQ(converted.readFrames(seeked.data(), 3000, 300), 300u);
+    EXPECT_EQ(converted.peekFrames(peeked.data(), 100, 100), 100u);
+    EXPECT_EQ(converted.readFrames(&seeked[300], 3300, 400), 400u);
+
+    for (int i = 0; i < 700; ++i)
+    {
+        ASSERT_EQ(seeked[i], whole[3000 + i]) << "frame " << 3000 + i;
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(peeked[i], whole[100 + i]) << "frame " << 100 + i;
+    }
+
+    // nothing past the end
+    EXPECT_EQ(converted.readFrames(seeked.data(), converted.getTotalFrames() - 10, 100), 10u);
+    EXPECT_EQ(seeked[50], 0.0f);
+}
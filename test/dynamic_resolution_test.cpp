@@ -0,0 +1,72 @@
+#include <cmath>
+#include <limits>
+#include <gtest/gtest.h>
+#include "../src/dynamic_resolution.hpp"
+
+TEST(DynamicResolutionTest, DisabledTest)
+{
+    DynamicResolution controller(8.0f, 0.5f);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_FLOAT_EQ(controller.update(50.0f), 1.0f);
+    }
+}
+
+
+TEST(DynamicResolutionTest, OverBudgetTest)
+{
+    DynamicResolution controller(8.0f, 0.5f);
+    controller.setEnabled(true);
+
+    // a single spike should not change the scale
+    EXPECT_FLOAT_EQ(controller.update(16.0f), 1.0f);
+    EXPECT_FLOAT_EQ(controller.update(6.0f), 1.0f);
+
+    // sustained 2x over budget, pixel count should halve
+    float scale = 1.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        scale = controller.update(16.0f);
+    }
+    EXPECT_NEAR(scale, 1.0f / std::sqrt(2.0f), 1e-4f);
+
+    // never below the minimum
+    for (int i = 0; i < 200; ++i)
+    {
+        scale = controller.update(100.0f);
+    }
+    EXPECT_FLOAT_EQ(scale, 0.5f);
+}
+
+
+TEST(DynamicResolutionTest, HeadroomTest)
+{
+    DynamicResolution controller(8.0f, 0.5f);
+    controller.setEnabled(true);
+
+    float scale = 1.0f;
+    for (int i = 0; i < 200; ++i)
+    {
+        scale = controller.update(100.0f);
+    }
+    ASSERT_FLOAT_EQ(scale, 0.5f);
+
+    // within budget but without headroom, hold the scale
+    for (int i = 0; i < 200; ++i)
+    {
+        scale = controller.update(7.0f);
+    }
+    EXPECT_FLOAT_EQ(scale, 0.5f);
+
+    // plenty of headroom, back to full resolution (not above)
+    for (int i = 0; i < 1000; ++i)
+    {
+        scale = controller.update(2.0f);
+    }
+    EXPECT_FLOAT_EQ(scale, 1.0f);
+
+    // missing samples are ignored
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_FLOAT_EQ(controller.update(nan), 1.0f);
+}
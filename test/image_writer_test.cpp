@@ -0,0 +1,95 @@
+#include <vector>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include "../src/image_writer.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../external/stb_image.h"
+
+TEST(ImageWriterTest, ChecksumTest)
+{
+    const unsigned char text[] = "123456789";
+
+    // standard check values
+    EXPECT_EQ(imageWriterCRC32(0, text, 9), 0xCBF43926u);
+    EXPECT_EQ(imageWriterAdler32(1, text, 9), 0x091E01DEu);
+
+    // incremental
+    uint32_t crc = imageWriterCRC32(0, text, 4);
+    EXPECT_EQ(imageWriterCRC32(crc, text + 4, 5), 0xCBF43926u);
+}
+
+
+TEST(ImageWriterTest, PNGRoundTripTest)
+{
+    // larger than one stored deflate block
+    const int width = 203;
+    const int height = 117;
+
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (int i = 0; i < width * height; ++i)
+    {
+        rgba[4 * i]     = static_cast<unsigned char>(i);
+        rgba[4 * i + 1] = static_cast<unsigned char>(i * 7);
+        rgba[4 * i + 2] = static_cast<unsigned char>(i * 13);
+        rgba[4 * i + 3] = 255;
+    }
+
+    const char* filepath = "image_writer_test.png";
+    ASSERT_TRUE(imageWriterPNG(filepath, rgba.data(), width, height, true));
+
+    int w, h, channels;
+    unsigned char* decoded = stbi_load(filepath, &w, &h, &channels, 3);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(w, width);
+    EXPECT_EQ(h, height);
+
+    // first decoded row is the last input row
+    bool match = true;
+    for (int row = 0; row < height; ++row)
+    {
+        for (int col = 0; col < width; ++col)
+        {
+            const unsigned char* src = &rgba[((height - 1 - row) * width + col) * 4];
+            const unsigned char* dst = &decoded[(row * width + col) * 3];
+            match = match && src[0] == dst[0] && src[1] == dst[1] && src[2] == dst[2];
+        }
+    }
+    EXPECT_TRUE(match);
+
+    stbi_image_free(decoded);
+    std::remove(filepath);
+}
+
+
+TEST(ImageWriterTest, YUV420Test)
+{
+    const int width = 4;
+    const int height = 2;
+
+    // white block, then red block
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (int row = 0; row < height; ++row)
+    {
+        for (int col = 0; col < width; ++col)
+        {
+            unsigned char* px = &rgba[(row * width + col) * 4];
+            bool white = col < 2;
+            px[0] = 255;
+            px[1] = white ? 255 : 0;
+            px[2] = white ? 255 : 0;
+            px[3] = 255;
+        }
+    }
+
+    std::vector<unsigned char> yuv(width * height * 3 / 2);
+    imageWriterRGBAToYUV420(yuv.data(), rgba.data(), width, height, false);
+
+    const int tolerance = 1;
+    EXPECT_NEAR(yuv[0], 255, tolerance);            // Y white
+    EXPECT_NEAR(yuv[2], 76, tolerance);             // Y red
+    EXPECT_NEAR(yuv[8], 128, tolerance);            // U white
+    EXPECT_NEAR(yuv[9], 85, tolerance);             // U red
+    EXPECT_NEAR(yuv[10], 128, tolerance);           // V white
+    EXPECT_NEAR(yuv[11], 255, tolerance);           // V red
+}
@@ -0,0 +1,48 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include "../src/latency_meter.hpp"
+
+TEST(LatencyMeterTest, PercentileTest)
+{
+    LatencyMeter meter(100);
+    EXPECT_EQ(meter.getNumSamples(), 0);
+    EXPECT_TRUE(std::isnan(meter.getPercentile(50.0)));
+
+    // 1 to 100 ms, out of order
+    for (int i = 0; i < 100; ++i)
+    {
+        meter.add(static_cast<double>((i * 37) % 100 + 1));
+    }
+
+    EXPECT_EQ(meter.getNumSamples(), 100);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(0.0), 1.0);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(50.0), 50.0);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(95.0), 95.0);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(99.0), 99.0);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(100.0), 100.0);
+}
+
+
+TEST(LatencyMeterTest, RollingTest)
+{
+    LatencyMeter meter(4);
+
+    meter.add(1000.0);
+    meter.add(1000.0);
+    EXPECT_EQ(meter.getNumSamples(), 2);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(50.0), 1000.0);
+
+    // the old measurements roll out
+    for (int i = 1; i <= 4; ++i)
+    {
+        meter.add(static_cast<double>(i));
+    }
+
+    EXPECT_EQ(meter.getNumSamples(), 4);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(50.0), 2.0);
+    EXPECT_DOUBLE_EQ(meter.getPercentile(99.0), 4.0);
+
+    meter.clear();
+    EXPECT_EQ(meter.getNumSamples(), 0);
+    EXPECT_TRUE(std::isnan(meter.getPercentile(99.0)));
+}
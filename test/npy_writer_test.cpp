@@ -0,0 +1,94 @@
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "../src/npy_writer.hpp"
+
+/// Whole file as bytes
+static std::vector<char> s_readFile(const char* filepath)
+{
+    std::vector<char> bytes;
+
+    FILE* file = fopen(filepath, "rb");
+    if (file == nullptr)
+    {
+        return bytes;
+    }
+
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+
+    return bytes;
+}
+
+
+TEST(NpyWriterTest, RoundTripTest)
+{
+    const int nCols = 5;
+    const int nRows = 7;
+
+    std::vector<float> rows(nRows * nCols);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        rows[i] = static_cast<float>(i) * 0.25f - 1.0f;
+    }
+
+    const char* filepath = "npy_writer_test.npy";
+
+    // in uneven pieces
+    NpyWriter writer;
+    ASSERT_TRUE(writer.open(filepath, nCols));
+    EXPECT_TRUE(writer.write(rows.data(), 3));
+    EXPECT_TRUE(writer.write(rows.data() + 3 * nCols, nRows - 3));
+    EXPECT_EQ(writer.getRowsWritten(), static_cast<uint64_t>(nRows));
+    EXPECT_TRUE(writer.close());
+    EXPECT_FALSE(writer.getIsOpen());
+
+    std::vector<char> bytes = s_readFile(filepath);
+    ASSERT_GE(bytes.size(), 10u);
+
+    // magic and version 1.0
+    EXPECT_EQ(memcmp(bytes.data(), "\x93NUMPY\x01\x00", 8), 0);
+
+    // the data starts aligned after the header
+    size_t headerLen = static_cast<uint8_t>(bytes[8]) 
+                       | (static_cast<uint8_t>(bytes[9]) << 8);
+    size_t dataStart = 10 + headerLen;
+    EXPECT_EQ(dataStart % 64, 0u);
+    EXPECT_EQ(bytes[dataStart - 1], '\n');
+
+    std::string header(&bytes[10], headerLen);
+    EXPECT_NE(header.find("'descr': '<f4'"), std::string::npos);
+    EXPECT_NE(header.find("'fortran_order': False"), std::string::npos);
+    EXPECT_NE(header.find("'shape': (7, 5)"), std::string::npos) << header;
+
+    ASSERT_EQ(bytes.size(), dataStart + rows.size() * sizeof(float));
+    EXPECT_EQ(memcmp(&bytes[dataStart], rows.data(), rows.size() * sizeof(float)), 0);
+
+    remove(filepath);
+}
+
+
+TEST(NpyWriterTest, EmptyTest)
+{
+    const char* filepath = "npy_writer_test_empty.npy";
+
+    NpyWriter writer;
+    ASSERT_TRUE(writer.open(filepath, 4094));
+    EXPECT_TRUE(writer.close());
+
+    // a header and no rows
+    std::vector<char> bytes = s_readFile(filepath);
+    ASSERT_EQ(bytes.size(), 128u);
+
+    std::string header(&bytes[10], bytes.size() - 10);
+    EXPECT_NE(header.find("'shape': (0, 4094)"), std::string::npos) << header;
+
+    remove(filepath);
+}
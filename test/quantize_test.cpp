@@ -0,0 +1,134 @@
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <gtest/gtest.h>
+#include "../src/quantize.hpp"
+
+TEST(QuantizeTest, Unorm16Test)
+{
+    // longer than one SIMD block, with a scalar tail
+    const std::vector<float> input = {
+        0.0f, 1.0f, 0.5f, -1.0f, 2.0f, 1.0f / 65535.0f, 0.25f, 0.75f,
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        0.0f, 1.0f, 0.5f, -1.0f, 2.0f,
+        std::numeric_limits<float>::quiet_NaN(), 0.25f, 0.75f
+    };
+
+    const std::vector<uint16_t> expected = {
+        0, 65535, 32768, 0, 65535, 1, 16384, 49151,
+        0, 65535, 0,
+        0, 65535, 32768, 0, 65535,
+        0, 16384, 49151
+    };
+
+    std::vector<uint16_t> output(input.size());
+    quantizeFloatToUnorm16(output.data(), input.data(), input.size());
+
+    EXPECT_EQ(output, expected);
+
+    // round trip error within half a step
+    const int len = 10001;
+    std::vector<float> ramp(len);
+    for (int i = 0; i < len; ++i)
+    {
+        ramp[i] = static_cast<float>(i) / (len - 1);
+    }
+
+    std::vector<uint16_t> quantized(len);
+    std::vector<float> dequantized(len);
+    quantizeFloatToUnorm16(quantized.data(), ramp.data(), len);
+    quantizeUnorm16ToFloat(dequantized.data(), quantized.data(), len);
+
+    float maxError = 0.0f;
+    for (int i = 0; i < len; ++i)
+    {
+        maxError = std::fmax(maxError, std::fabs(dequantized[i] - ramp[i]));
+    }
+    EXPECT_LE(maxError, 0.5f / 65535.0f + 1e-7f);
+}
+
+
+TEST(QuantizeTest, HalfValueTest)
+{
+    EXPECT_EQ(quantizeFloatToHalfValue(0.0f), 0x0000);
+    EXPECT_EQ(quantizeFloatToHalfValue(-0.0f), 0x8000);
+    EXPECT_EQ(quantizeFloatToHalfValue(1.0f), 0x3C00);
+    EXPECT_EQ(quantizeFloatToHalfValue(-2.0f), 0xC000);
+    EXPECT_EQ(quantizeFloatToHalfValue(0.5f), 0x3800);
+    EXPECT_EQ(quantizeFloatToHalfValue(65504.0f), 0x7BFF);  // largest half
+    EXPECT_EQ(quantizeFloatToHalfValue(65520.0f), 0x7C00);  // rounds to inf
+    EXPECT_EQ(quantizeFloatToHalfValue(std::ldexp(1.0f, -24)), 0x0001);
+    EXPECT_EQ(quantizeFloatToHalfValue(std::ldexp(1.0f, -26)), 0x0000);
+    EXPECT_EQ(quantizeFloatToHalfValue(std::numeric_limits<float>::infinity()),
+              0x7C00);
+    EXPECT_EQ(quantizeFloatToHalfValue(std::numeric_limits<float>::quiet_NaN())
+              & 0x7E00, 0x7E00);
+
+    // ties to even: 1 + 2^-11 is halfway between 1 and 1 + 2^-10
+    EXPECT_EQ(quantizeFloatToHalfValue(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+    EXPECT_EQ(quantizeFloatToHalfValue(1.0f + 3.0f * std::ldexp(1.0f, -11)),
+              0x3C02);
+
+    // every non-NaN half survives a round trip through float
+    for (uint32_t h = 0; h < 0x10000; ++h)
+    {
+        bool isNaN = (h & 0x7C00) == 0x7C00 && (h & 0x03FF) != 0;
+        if (isNaN)
+        {
+            continue;
+        }
+
+        float value = quantizeHalfToFloatValue(static_cast<uint16_t>(h));
+        ASSERT_EQ(quantizeFloatToHalfValue(value), h);
+    }
+}
+
+
+TEST(QuantizeTest, HalfArrayTest)
+{
+    // SIMD path matches the scalar path on arbitrary bit patterns
+    const int len = 100003;
+    std::vector<float> input(len);
+
+    uint32_t state = 12345;
+    for (int i = 0; i < len; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        memcpy(&input[i], &state, sizeof(float));
+    }
+
+    std::vector<uint16_t> output(len);
+    quantizeFloatToHalf(output.data(), input.data(), len);
+
+    int mismatches = 0;
+    for (int i = 0; i < len; ++i)
+    {
+        uint16_t expected = quantizeFloatToHalfValue(input[i]);
+        bool bothNaN = std::isnan(input[i]) && (output[i] & 0x7E00) == 0x7E00;
+        mismatches += (output[i] != expected && !bothNaN);
+    }
+    EXPECT_EQ(mismatches, 0);
+
+    // relative error on [0, 1] within half an ulp of the 11-bit mantissa
+    const int rampLen = 10001;
+    std::vector<float> ramp(rampLen);
+    for (int i = 0; i < rampLen; ++i)
+    {
+        ramp[i] = static_cast<float>(i) / (rampLen - 1);
+    }
+
+    std::vector<uint16_t> quantized(rampLen);
+    std::vector<float> dequantized(rampLen);
+    quantizeFloatToHalf(quantized.data(), ramp.data(), rampLen);
+    quantizeHalfToFloat(dequantized.data(), quantized.data(), rampLen);
+
+    for (int i = 1; i < rampLen; ++i)
+    {
+        ASSERT_LE(std::fabs(dequantized[i] - ramp[i]) / ramp[i],
+                  std::ldexp(1.0f, -11));
+    }
+}
@@ -0,0 +1,231 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "../src/resampler.hpp"
+
+static const double s_PI = 3.14159265358979323846;
+
+/// Interleaved sine, a different frequency in each channel
+static std::vector<float> s_makeSines(int nFrames, int channels, int rate,
+                                      const std::vector<double>& freqs)
+{
+    std::vector<float> frames(nFrames * channels);
+    for (int i = 0; i < nFrames; ++i)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            frames[i * channels + c] = static_cast<float>(
+                std::sin(2.0 * s_PI * freqs[c] * i / rate));
+        }
+    }
+    return frames;
+}
+
+
+/// Resample in chunks of chunkLen frames
+static std::vector<float> s_resample(Resampler& resampler,
+                                     const std::vector<float>& in,
+                                     int chunkLen)
+{
+    int channels = resampler.getChannels();
+    int nInFrames = in.size() / channels;
+
+    std::vector<float> out;
+    std::vector<float> chunkOut;
+
+    for (int i = 0; i < nInFrames; i += chunkLen)
+    {
+        int len = std::min(chunkLen, nInFrames - i);
+        chunkOut.resize(resampler.getMaxOutputFrames(len) * channels);
+
+        int nOut = resampler.process(&in[i * channels], len, chunkOut.data());
+        out.insert(out.end(), chunkOut.begin(), chunkOut.begin() + nOut * channels);
+    }
+    return out;
+}
+
+
+TEST(ResamplerTest, PassthroughTest)
+{
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(2, 48000, 48000));
+    EXPECT_TRUE(resampler.getIsPassthrough());
+
+    std::vector<float> in = s_makeSines(1000, 2, 48000, {440.0, 1000.0});
+    std::vector<float> out = s_resample(resampler, in, 300);
+
+    EXPECT_EQ(out, in);
+
+    EXPECT_FALSE(resampler.init(0, 48000, 44100));
+    EXPECT_FALSE(resampler.init(2, 48000, 0));
+}
+
+
+TEST(ResamplerTest, SineTest)
+{
+    const int rates[][2] = {{44100, 48000}, {48000, 44100}, {96000, 22050},
+                            {8000, 48000}, {11025, 16000}};
+
+    for (const auto& rate : rates)
+    {
+        const int inRate = rate[0];
+        const int outRate = rate[1];
+        // well inside the passband of both rates
+        const double lowerRate = std::min(inRate, outRate);
+        const std::vector<double> freqs = {0.01 * lowerRate, 0.3 * lowerRate};
+
+        Resampler resampler;
+        ASSERT_TRUE(resampler.init(2, inRate, outRate));
+
+        int nInFrames = inRate / 10;
+        std::vector<float> in = s_makeSines(nInFrames, 2, inRate, freqs);
+        std::vector<float> out = s_resample(resampler, in, 1000);
+
+        // a window in output frames
+        int windowLen = static_cast<int>(std::ceil(
+            resampler.getNumTaps() * static_cast<double>(outRate) / inRate));
+
+        // short of the last half window
+        int nOutFrames = out.size() / 2;
+        EXPECT_NEAR(nOutFrames,
+                    static_cast<double>(nInFrames) * outRate / inRate,
+                    windowLen);
+
+        // aligned with the input, away from the silence before it
+        double maxError = 0.0;
+        for (int i = windowLen; i < nOutFrames; ++i)
+        {
+            for (int c = 0; c < 2; ++c)
+            {
+                double expected = std::sin(2.0 * s_PI * freqs[c] * i / outRate);
+                maxError = std::max(maxError, std::fabs(out[i * 2 + c] - expected));
+            }
+        }
+        EXPECT_LT(maxError, 2e-3) << inRate << " Hz to " << outRate << " Hz";
+    }
+}
+
+
+TEST(ResamplerTest, AliasTest)
+{
+    // above the output Nyquist, removed instead of folded down
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(1, 48000, 16000));
+
+    std::vector<float> in = s_makeSines(48000 / 10, 1, 48000, {12000.0});
+    std::vector<float> out = s_resample(resampler, in, 512);
+
+    double sumSquares = 0.0;
+    int n = 0;
+    for (size_t i = resampler.getNumTaps(); i < out.size(); ++i)
+    {
+        sumSquares += out[i] * out[i];
+        ++n;
+    }
+    EXPECT_LT(std::sqrt(sumSquares / n), 1e-3);
+}
+
+
+TEST(ResamplerTest, ChunkTest)
+{
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(3, 44100, 48000));
+
+    std::vector<float> in = s_makeSines(5000, 3, 44100, {100.0, 2000.0, 9000.0});
+
+    std::vector<float> whole = s_resample(resampler, in, 5000);
+
+    // the same frames whatever the chunk size
+    for (int chunkLen : {1, 7, 64, 1001})
+    {
+        resampler.reset();
+        std::vector<float> chunked = s_resample(resampler, in, chunkLen);
+
+        EXPECT_EQ(chunked, whole) << "chunks of " << chunkLen;
+    }
+}
+
+
+TEST(ResamplerTest, SeekTest)
+{
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(2, 44100, 48000));
+
+    std::vector<float> in = s_makeSines(8000, 2, 44100, {440.0, 5000.0});
+    std::vector<float> whole = s_resample(resampler, in, 8000);
+
+    // restarted at an output frame, fed from the input frame it asks for
+    const uint64_t seekFrame = 4321;
+    resampler.reset(seekFrame);
+
+    uint64_t inFrame = resampler.getNextInputFrame();
+    ASSERT_LT(inFrame, 8000u);
+
+    std::vector<float> tail(in.begin() + inFrame * 2, in.end());
+    std::vector<float> seeked = s_resample(resampler, tail, 500);
+
+    ASSERT_LE(seekFrame * 2 + seeked.size(), whole.size());
+    for (size_t i = 0; i < seeked.size(); ++i)
+    {
+        ASSERT_EQ(seeked[i], whole[seekFrame * 2 + i]) << "sample " << i;
+    }
+}
+
+
+TEST(ResamplerTest, ReserveTest)
+{
+    const int maxChunk = 1024;
+
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(2, 44100, 48000));
+    resampler.reserve(maxChunk);
+
+    std::vector<float> in = s_makeSines(20000, 2, 44100, {440.0, 5000.0});
+
+    // kept when the filter is rebuilt for other rates
+    for (int outRate : {48000, 22050})
+    {
+        ASSERT_TRUE(resampler.init(2, 44100, outRate));
+
+        int capacity = resampler.getHistoryCapacity();
+        EXPECT_GE(capacity, resampler.getNumTaps() + maxChunk);
+
+        // chunks up to the size reserved never grow the history,
+        // through seeks as well
+        for (int chunkLen : {1, 333, maxChunk})
+        {
+            s_resample(resampler, in, chunkLen);
+            EXPECT_EQ(resampler.getHistoryCapacity(), capacity)
+                << outRate << " Hz, chunks of " << chunkLen;
+
+            resampler.reset(777);
+            EXPECT_EQ(resampler.getHistoryCapacity(), capacity);
+        }
+    }
+}
+
+
+TEST(ResamplerTest, BlockTest)
+{
+    Resampler resampler;
+    ASSERT_TRUE(resampler.init(2, 96000, 48000));
+
+    const int nOutFrames = 2048;
+    int nInFrames = resampler.getBlockInputFrames(nOutFrames);
+
+    std::vector<float> in = s_makeSines(nInFrames + 100, 2, 96000, {1000.0, 7000.0});
+    std::vector<float> block(nOutFrames * 2);
+
+    EXPECT_FALSE(resampler.resampleBlock(in.data(), nInFrames - 1,
+                                         block.data(), nOutFrames));
+    ASSERT_TRUE(resampler.resampleBlock(in.data(), nInFrames + 100,
+                                        block.data(), nOutFrames));
+
+    // the same as the end of the stream
+    std::vector<float> whole = s_resample(resampler, in, nInFrames + 100);
+    ASSERT_GE(whole.size(), block.size());
+
+    std::vector<float> tail(whole.end() - block.size(), whole.end());
+    EXPECT_EQ(block, tail);
+}
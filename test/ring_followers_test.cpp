@@ -0,0 +1,140 @@
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include "../src/ring_followers.hpp"
+#include "../src/sample_ring.hpp"
+#include "../src/wav_source.hpp"
+
+/// Samples valued by their count
+static std::vector<float> s_counting(uint64_t from, uint64_t nSamples)
+{
+    std::vector<float> samples(nSamples);
+    for (uint64_t i = 0; i < nSamples; ++i)
+    {
+        samples[i] = static_cast<float>(from + i);
+    }
+    return samples;
+}
+
+
+/// Write counting samples in blocks, the ring holds well over a poll
+/// interval of them
+static void s_feed(SampleRing& ring, uint64_t from, uint64_t nSamples)
+{
+    const uint64_t blockLen = 4096;
+    for (uint64_t count = from; count < from + nSamples; count += blockLen)
+    {
+        uint64_t len = std::min(blockLen, from + nSamples - count);
+        ring.write(s_counting(count, len).data(), len);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+
+/// \return     number of frames in a WAV file, which is then removed
+static uint64_t s_takeFrames(const std::string& filepath)
+{
+    WavSource source;
+    if (!source.open(filepath.c_str()))
+    {
+        return 0;
+    }
+
+    uint64_t nFrames = source.getTotalFrames();
+    source.close();
+    remove(filepath.c_str());
+
+    return nFrames;
+}
+
+
+TEST(RingFollowersTest, ResumeTest)
+{
+    const int channels = 2;
+    const int sampleRate = 1000;
+
+    SampleRing ring;
+    ring.allocate(1 << 19);
+
+    RingFollowers followers(300);
+    ASSERT_TRUE(followers.startHistory(&ring, channels, sampleRate));
+    ASSERT_TRUE(followers.startSaving(&ring, channels, sampleRate, "."));
+
+    s_feed(ring, 0, 20000);
+
+    // e.g. the device reopened with another block size, same format
+    followers.suspend();
+    EXPECT_TRUE(followers.getIsFollowing());
+    EXPECT_FALSE(followers.getRecorder().getIsRecording());
+    std::string firstPath = followers.getRecorder().getOutputPath();
+
+    ring.allocate(ring.getCapacity());
+    followers.resume(&ring, channels, sampleRate);
+
+    // both going again, the history kept
+    EXPECT_TRUE(followers.getHistory().getIsRunning());
+    EXPECT_TRUE(followers.getRecorder().getIsRecording());
+    EXPECT_EQ(followers.getHistory().getSampleCount(), 20000u);
+
+    s_feed(ring, 20000, 10000);
+    followers.stop();
+
+    EXPECT_FALSE(followers.getIsFollowing());
+    EXPECT_EQ(followers.getHistory().getSampleCount(), 30000u);
+
+    // saved on in another file
+    std::string secondPath = followers.getRecorder().getOutputPath();
+    ASSERT_NE(firstPath, secondPath);
+    EXPECT_EQ(s_takeFrames(firstPath), 10000u);
+    EXPECT_EQ(s_takeFrames(secondPath), 5000u);
+}
+
+
+TEST(RingFollowersTest, FormatTest)
+{
+    SampleRing ring;
+    ring.allocate(1 << 19);
+
+    RingFollowers followers(300);
+    ASSERT_TRUE(followers.startHistory(&ring, 2, 1000));
+    s_feed(ring, 0, 20000);
+
+    // another rate, the samples kept wouldn't play right
+    followers.suspend();
+    ring.allocate(ring.getCapacity());
+    followers.resume(&ring, 2, 2000);
+
+    EXPECT_TRUE(followers.getHistory().getIsRunning());
+    EXPECT_EQ(followers.getHistory().getSampleCount(), 0u);
+
+    s_feed(ring, 0, 6000);
+    followers.suspend();
+    EXPECT_EQ(followers.getHistory().getSampleCount(), 6000u);
+
+    // another channel count
+    ring.allocate(ring.getCapacity());
+    followers.resume(&ring, 1, 2000);
+    EXPECT_EQ(followers.getHistory().getSampleCount(), 0u);
+
+    // nothing suspended, only the format is followed
+    followers.stop();
+    followers.resume(&ring, 1, 2000);
+    EXPECT_FALSE(followers.getIsFollowing());
+}
+
+
+TEST(RingFollowersTest, NoHistoryTest)
+{
+    SampleRing ring;
+    ring.allocate(1 << 16);
+
+    // nothing to follow, the ring needs no headroom
+    RingFollowers followers(0);
+    EXPECT_TRUE(followers.startHistory(&ring, 1, 1000));
+    EXPECT_FALSE(followers.getHistory().getIsRunning());
+    EXPECT_FALSE(followers.getIsFollowing());
+}
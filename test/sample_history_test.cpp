@@ -0,0 +1,160 @@
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include "../src/sample_history.hpp"
+#include "../src/sample_ring.hpp"
+#include "../src/wav_source.hpp"
+
+/// Samples valued by their count
+static std::vector<float> s_counting(uint64_t from, uint64_t nSamples)
+{
+    std::vector<float> samples(nSamples);
+    for (uint64_t i = 0; i < nSamples; ++i)
+    {
+        samples[i] = static_cast<float>(from + i);
+    }
+    return samples;
+}
+
+
+/// Write counting samples in blocks, the ring holds well over a poll
+/// interval of them
+static void s_feed(SampleRing& ring, uint64_t from, uint64_t nSamples)
+{
+    const uint64_t blockLen = 4096;
+    for (uint64_t count = from; count < from + nSamples; count += blockLen)
+    {
+        uint64_t len = std::min(blockLen, from + nSamples - count);
+        ring.write(s_counting(count, len).data(), len);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+
+TEST(SampleHistoryTest, GrowTest)
+{
+    SampleRing ring;
+    ring.allocate(1 << 19);
+
+    // nothing allocated before there is something to keep
+    SampleHistory history;
+    ASSERT_TRUE(history.start(&ring, 1, 1000000));
+    EXPECT_EQ(history.getAllocatedSamples(), 0u);
+
+    s_feed(ring, 0, 100000);
+    history.stop();
+
+    EXPECT_EQ(history.getDroppedSamples(), 0u);
+    EXPECT_EQ(history.getSampleCount(), 100000u);
+
+    // in whole segments, no more than needed
+    uint64_t allocated = history.getAllocatedSamples();
+    EXPECT_GE(allocated, 100000u);
+    EXPECT_LT(allocated, 200000u);
+
+    // stopped and started again, appended after
+    ASSERT_TRUE(history.start(&ring, 1, 1000000));
+    s_feed(ring, 100000, 50000);
+    history.stop();
+    EXPECT_EQ(history.getSampleCount(), 150000u);
+
+    const char* filepath = "sample_history_test_grow.wav";
+    ASSERT_TRUE(history.save(filepath, 8000));
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    EXPECT_EQ(source.getSampleRate(), 8000);
+    ASSERT_EQ(source.getTotalFrames(), 150000u);
+
+    std::vector<float> read(150000);
+    EXPECT_EQ(source.readFrames(read.data(), 0, 150000), 150000u);
+    EXPECT_EQ(read, s_counting(0, 150000));
+
+    source.close();
+    remove(filepath);
+
+    history.clear();
+    EXPECT_EQ(history.getSampleCount(), 0u);
+    EXPECT_EQ(history.getAllocatedSamples(), 0u);
+}
+
+
+TEST(SampleHistoryTest, LimitTest)
+{
+    const int channels = 2;
+    const uint64_t maxSamples = 150000;
+
+    SampleRing ring;
+    ring.allocate(1 << 19);
+
+    SampleHistory history;
+    ASSERT_TRUE(history.start(&ring, channels, maxSamples));
+    s_feed(ring, 0, 500000);
+    history.stop();
+
+    // the newest only, in the same memory however long it runs
+    EXPECT_EQ(history.getDroppedSamples(), 0u);
+    EXPECT_EQ(history.getSampleCount(), maxSamples);
+    EXPECT_LE(history.getAllocatedSamples(), maxSamples + 2 * (1 << 16));
+
+    const char* filepath = "sample_history_test_limit.wav";
+    ASSERT_TRUE(history.save(filepath, 8000));
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    EXPECT_EQ(source.getChannels(), channels);
+    ASSERT_EQ(source.getTotalFrames(), maxSamples / channels);
+
+    std::vector<float> read(maxSamples);
+    EXPECT_EQ(source.readFrames(read.data(), 0, maxSamples / channels),
+              maxSamples / channels);
+    EXPECT_EQ(read, s_counting(500000 - maxSamples, maxSamples));
+
+    source.close();
+    remove(filepath);
+}
+
+
+TEST(SampleHistoryTest, GapTest)
+{
+    SampleRing ring;
+    ring.allocate(1024);
+
+    SampleHistory history;
+    ASSERT_TRUE(history.start(&ring, 1, 1000000));
+
+    // appended before the overrun
+    ring.write(s_counting(0, 300).data(), 300);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(history.getSampleCount(), 300u);
+
+    // then the follower falls behind, the newest half of the ring is kept
+    ring.write(s_counting(300, 4000).data(), 4000);
+    history.stop();
+
+    // as long as the recording, silence where it was dropped
+    EXPECT_EQ(history.getDroppedSamples(), 4300u - 512u - 300u);
+    ASSERT_EQ(history.getSampleCount(), 4300u);
+
+    const char* filepath = "sample_history_test_gap.wav";
+    ASSERT_TRUE(history.save(filepath, 8000));
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    ASSERT_EQ(source.getTotalFrames(), 4300u);
+
+    std::vector<float> read(4300);
+    EXPECT_EQ(source.readFrames(read.data(), 0, 4300), 4300u);
+
+    std::vector<float> expected = s_counting(0, 300);
+    expected.resize(4300 - 512, 0.0f);
+    std::vector<float> kept = s_counting(4300 - 512, 512);
+    expected.insert(expected.end(), kept.begin(), kept.end());
+    EXPECT_EQ(read, expected);
+
+    source.close();
+    remove(filepath);
+}
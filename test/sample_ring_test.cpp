@@ -0,0 +1,145 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <gtest/gtest.h>
+#include "../src/sample_ring.hpp"
+
+/// Samples valued by their count
+static std::vector<float> s_counting(uint64_t from, uint64_t nSamples)
+{
+    std::vector<float> samples(nSamples);
+    for (uint64_t i = 0; i < nSamples; ++i)
+    {
+        samples[i] = static_cast<float>(from + i);
+    }
+    return samples;
+}
+
+
+TEST(SampleRingTest, ReadTest)
+{
+    SampleRing ring;
+    ring.allocate(100);
+    ASSERT_EQ(ring.getCapacity(), 128u);
+
+    // zeros before the first sample
+    std::vector<float> latest(8, -1.0f);
+    ring.readLatest(latest.data(), 8);
+    EXPECT_EQ(latest, std::vector<float>(8, 0.0f));
+
+    ring.write(s_counting(0, 5).data(), 5);
+    ring.readLatest(latest.data(), 8);
+    EXPECT_EQ(latest, std::vector<float>({0, 0, 0, 0, 1, 2, 3, 4}));
+
+    // wraps around the end of the ring
+    ring.write(s_counting(5, 200).data(), 200);
+    EXPECT_EQ(ring.getWriteCount(), 205u);
+
+    std::vector<float> samples(128);
+    ASSERT_TRUE(ring.read(samples.data(), 77, 128));
+    EXPECT_EQ(samples, s_counting(77, 128));
+
+    ring.readLatest(samples.data(), 128);
+    EXPECT_EQ(samples, s_counting(77, 128));
+
+    // overwritten, or not written yet
+    EXPECT_FALSE(ring.read(samples.data(), 76, 10));
+    EXPECT_FALSE(ring.read(samples.data(), 200, 10));
+
+    // more than the ring at once keeps the last of them
+    ring.write(s_counting(205, 300).data(), 300);
+    EXPECT_EQ(ring.getWriteCount(), 505u);
+    ASSERT_TRUE(ring.read(samples.data(), 505 - 128, 128));
+    EXPECT_EQ(samples, s_counting(505 - 128, 128));
+}
+
+
+TEST(SampleRingTest, ThreadTest)
+{
+    SampleRing ring;
+    ring.allocate(4096);
+
+    const uint64_t nTotal = 1 << 22;
+    std::atomic_bool isDone(false);
+
+    // the producer never waits for the reader
+    std::thread producer([&]()
+    {
+        std::vector<float> block(256);
+        for (uint64_t count = 0; count < nTotal; count += block.size())
+        {
+            for (size_t i = 0; i < block.size(); ++i)
+            {
+                block[i] = static_cast<float>((count + i) & 0xFFFFF);
+            }
+            ring.write(block.data(), block.size());
+        }
+        isDone.store(true);
+    });
+
+    // every snapshot is a run of consecutive samples
+    std::vector<float> snapshot(2048);
+    int nSnapshots = 0;
+    while (!isDone.load())
+    {
+        uint64_t end = ring.getWriteCount();
+        if (end < snapshot.size())
+        {
+            continue;
+        }
+
+        // the ones asked for, or none if overwritten meanwhile
+        if (ring.read(snapshot.data(), end - snapshot.size(), snapshot.size()))
+        {
+            ASSERT_EQ(static_cast<uint64_t>(snapshot[0]), (end - snapshot.size()) & 0xFFFFF);
+        }
+        else
+        {
+            ring.readLatest(snapshot.data(), snapshot.size());
+        }
+
+        for (size_t i = 1; i < snapshot.size(); ++i)
+        {
+            uint64_t previous = static_cast<uint64_t>(snapshot[i - 1]);
+            ASSERT_EQ(static_cast<uint64_t>(snapshot[i]), (previous + 1) & 0xFFFFF);
+        }
+        ++nSnapshots;
+    }
+
+    producer.join();
+    EXPECT_EQ(ring.getWriteCount(), nTotal);
+    EXPECT_GT(nSnapshots, 0);
+}
+
+
+TEST(SampleRingTest, ReadNextTest)
+{
+    SampleRing ring;
+    ring.allocate(64);
+
+    std::vector<float> samples(64);
+    uint64_t from = 0;
+    uint64_t nSkipped = 0;
+
+    // nothing new
+    EXPECT_EQ(ring.readNext(samples.data(), &from, 64, 2, &nSkipped), 0u);
+
+    // in pieces of whole frames
+    ring.write(s_counting(0, 40).data(), 40);
+    ASSERT_EQ(ring.readNext(samples.data(), &from, 25, 2, &nSkipped), 24u);
+    EXPECT_EQ(std::vector<float>(samples.begin(), samples.begin() + 24),
+              s_counting(0, 24));
+    ASSERT_EQ(ring.readNext(samples.data(), &from, 64, 2, &nSkipped), 16u);
+    EXPECT_EQ(std::vector<float>(samples.begin(), samples.begin() + 16),
+              s_counting(24, 16));
+    EXPECT_EQ(from, 40u);
+    EXPECT_EQ(nSkipped, 0u);
+
+    // overwritten, resumes at the newest half of the ring
+    ring.write(s_counting(40, 100).data(), 100);
+    ASSERT_EQ(ring.readNext(samples.data(), &from, 64, 2, &nSkipped), 32u);
+    EXPECT_EQ(std::vector<float>(samples.begin(), samples.begin() + 32),
+              s_counting(108, 32));
+    EXPECT_EQ(nSkipped, 68u);
+    EXPECT_EQ(from, 140u);
+}
@@ -0,0 +1,209 @@
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+
+#include "../src/spectrum_feedback.hpp"
+#include "../src/fft.hpp"
+
+// headless OpenGL ES 3.0 context, e.g. on Mesa's llvmpipe
+// --------------------------------------------------------
+class SpectrumFeedbackTest : public testing::Test
+{
+protected:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint fbo = 0, rbo = 0;
+
+    void SetUp() override
+    {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+            eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+        if (getPlatformDisplay != nullptr)
+        {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                         EGL_DEFAULT_DISPLAY, nullptr);
+        }
+
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+        {
+            GTEST_SKIP() << "no surfaceless EGL display";
+        }
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+        const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                   contextAttribs);
+
+        if (context == EGL_NO_CONTEXT
+            || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)
+            || !gladLoadGLES2Loader((GLADloadproc)eglGetProcAddress))
+        {
+            GTEST_SKIP() << "no OpenGL ES 3.0 context";
+        }
+
+        // surfaceless has no default framebuffer, draws need a complete one
+        // even with the rasterizer discarded
+        glGenRenderbuffers(1, &rbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                  GL_RENDERBUFFER, rbo);
+
+        fftInit(s_FFT_LEN);
+    }
+
+    void TearDown() override
+    {
+        if (context != EGL_NO_CONTEXT)
+        {
+            fftCleanUp();
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteRenderbuffers(1, &rbo);
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY)
+        {
+            eglTerminate(display);
+        }
+    }
+
+    static constexpr int s_FFT_LEN = 256;
+    static constexpr int s_N_ROWS = 4;
+    static constexpr int s_N_COLS = s_FFT_LEN / 2 - 2;
+
+    /// Spectrum of a few sines over noise, the FFT scaling of pffft
+    void makeComplex(float* complex, int seed)
+    {
+        unsigned int state = 1234u + seed;
+        for (int i = 0; i < s_FFT_LEN; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            float noise = (state >> 8) / 16777216.0f - 0.5f;
+            complex[i] = noise * 1e-3f;
+        }
+        for (int k = 5 + seed; k < s_FFT_LEN / 2; k += 17)
+        {
+            complex[2 * k] = 0.3f * s_FFT_LEN / 2;
+        }
+    }
+
+    std::vector<float> readBuffer(GLuint buffer, int len)
+    {
+        std::vector<float> data(len);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        void* mapped = glMapBufferRange(GL_COPY_READ_BUFFER, 0,
+                                        len * sizeof(float), GL_MAP_READ_BIT);
+        memcpy(data.data(), mapped, len * sizeof(float));
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return data;
+    }
+
+    GLuint makeZBuffer()
+    {
+        std::vector<float> zeros(s_N_ROWS * s_N_COLS, 0.0f);
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, zeros.size() * sizeof(float),
+                     zeros.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return buffer;
+    }
+};
+
+
+TEST_F(SpectrumFeedbackTest, MatchesComplexToRealDBTest)
+{
+    SpectrumFeedback spectrum(SHADER_DIR "spectrum.vs", SHADER_DIR "spectrum.fs",
+                              s_N_ROWS, s_N_COLS, s_FFT_LEN);
+    spectrum.setRowKernel(0.0f, 1.0f, 0.0f);
+
+    GLuint zBuffer = makeZBuffer();
+
+    std::vector<float> complex(s_FFT_LEN);
+    std::vector<std::vector<float>> expected;
+
+    for (int row = 0; row < 3; ++row)
+    {
+        makeComplex(complex.data(), row);
+        spectrum.process(complex.data(), zBuffer);
+
+        std::vector<float> dB(s_FFT_LEN / 2);
+        fftComplexToRealDB(dB.data(), complex.data(), s_FFT_LEN / 2, true);
+        expected.push_back(dB);
+    }
+
+    std::vector<float> z = readBuffer(zBuffer, s_N_ROWS * s_N_COLS);
+    ASSERT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+    // row 0 is still empty, rows 1 to 3 are the three processed rows
+    float maxError = 0.0f;
+    for (int row = 0; row < s_N_ROWS; ++row)
+    {
+        for (int col = 0; col < s_N_COLS; ++col)
+        {
+            float value = z[row * s_N_COLS + col];
+            float reference = (row == 0) ? 0.0f : expected[row - 1][col + 1];
+            maxError = std::fmax(maxError, std::fabs(value - reference));
+        }
+    }
+    EXPECT_LE(maxError, 1e-4f);
+
+    glDeleteBuffers(1, &zBuffer);
+}
+
+
+TEST_F(SpectrumFeedbackTest, SmoothingTest)
+{
+    const float smoothing = 0.6f;
+    const float a = 0.25f, b = 0.5f, c = 0.25f;
+
+    SpectrumFeedback spectrum(SHADER_DIR "spectrum.vs", SHADER_DIR "spectrum.fs",
+                              s_N_ROWS, s_N_COLS, s_FFT_LEN);
+    spectrum.setSmoothing(smoothing);
+    spectrum.setRowKernel(a, b, c);
+
+    GLuint zBuffer = makeZBuffer();
+
+    std::vector<float> complex(s_FFT_LEN);
+    std::vector<float> previous(s_N_COLS, 0.0f);
+
+    for (int row = 0; row < 5; ++row)
+    {
+        makeComplex(complex.data(), row);
+        spectrum.process(complex.data(), zBuffer);
+
+        // bin 0 is the DC alone, the Nyquist is not a neighbour
+        std::vector<float> dB(s_FFT_LEN / 2);
+        complex[1] = 0.0f;
+        fftComplexToRealDB(dB.data(), complex.data(), s_FFT_LEN / 2, true);
+
+        for (int col = 0; col < s_N_COLS; ++col)
+        {
+            float blurred = a * dB[col] + b * dB[col + 1] + c * dB[col + 2];
+            previous[col] = blurred + (previous[col] - blurred) * smoothing;
+        }
+    }
+
+    std::vector<float> z = readBuffer(zBuffer, s_N_ROWS * s_N_COLS);
+
+    float maxError = 0.0f;
+    for (int col = 0; col < s_N_COLS; ++col)
+    {
+        float value = z[(s_N_ROWS - 1) * s_N_COLS + col];
+        maxError = std::fmax(maxError, std::fabs(value - previous[col]));
+    }
+    EXPECT_LE(maxError, 1e-4f);
+
+    glDeleteBuffers(1, &zBuffer);
+}
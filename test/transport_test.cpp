@@ -0,0 +1,169 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <gtest/gtest.h>
+#include "../src/transport.hpp"
+
+/// One callback block, the frames played in order
+static std::vector<uint64_t> s_playBlock(Transport& transport, uint64_t blockFrames)
+{
+    std::vector<uint64_t> frames;
+
+    transport.beginBlock();
+
+    uint64_t frame;
+    uint64_t n;
+    while (frames.size() < blockFrames
+           && (n = transport.nextSegment(&frame, blockFrames - frames.size())) > 0)
+    {
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            frames.push_back(frame + i);
+        }
+        transport.advance(n);
+    }
+
+    transport.endBlock();
+    return frames;
+}
+
+
+TEST(TransportTest, PlayTest)
+{
+    Transport transport;
+    transport.reset(1000);
+
+    // stopped until the next block
+    EXPECT_TRUE(s_playBlock(transport, 256).empty());
+    EXPECT_FALSE(transport.getIsPlaying());
+
+    transport.play();
+    std::vector<uint64_t> frames = s_playBlock(transport, 256);
+    ASSERT_EQ(frames.size(), 256u);
+    EXPECT_EQ(frames.front(), 0u);
+    EXPECT_EQ(frames.back(), 255u);
+    EXPECT_EQ(transport.getPosition(), 256u);
+
+    transport.pause();
+    EXPECT_TRUE(s_playBlock(transport, 256).empty());
+    EXPECT_EQ(transport.getPosition(), 256u);
+
+    // stops on the last frame
+    transport.seek(900);
+    transport.play();
+    frames = s_playBlock(transport, 256);
+    ASSERT_EQ(frames.size(), 100u);
+    EXPECT_EQ(frames.back(), 999u);
+
+    s_playBlock(transport, 256);
+    EXPECT_FALSE(transport.getIsPlaying());
+    EXPECT_EQ(transport.getPosition(), 1000u);
+
+    // from the beginning after the end
+    transport.play();
+    frames = s_playBlock(transport, 10);
+    ASSERT_EQ(frames.size(), 10u);
+    EXPECT_EQ(frames.front(), 0u);
+}
+
+
+TEST(TransportTest, CommandTest)
+{
+    Transport transport;
+    transport.reset(1000);
+
+    // posted together, applied together in the next block
+    transport.seek(500);
+    transport.play();
+    transport.seek(600);
+
+    EXPECT_EQ(transport.getPosition(), 600u);
+    EXPECT_TRUE(transport.getIsPlaying());
+
+    std::vector<uint64_t> frames = s_playBlock(transport, 4);
+    ASSERT_EQ(frames.size(), 4u);
+    EXPECT_EQ(frames.front(), 600u);
+
+    // the last of play and pause wins
+    transport.pause();
+    transport.play();
+    transport.pause();
+    EXPECT_TRUE(s_playBlock(transport, 4).empty());
+
+    // clamped to the length
+    transport.seek(5000);
+    s_playBlock(transport, 4);
+    EXPECT_EQ(transport.getPosition(), 1000u);
+}
+
+
+TEST(TransportTest, LoopTest)
+{
+    Transport transport;
+    transport.reset(1000);
+
+    EXPECT_FALSE(transport.setLoop(300, 300));
+    ASSERT_TRUE(transport.setLoop(100, 110));
+    transport.seek(95);
+    transport.play();
+
+    // wraps on the exact frame, within the block
+    std::vector<uint64_t> frames = s_playBlock(transport, 40);
+    ASSERT_EQ(frames.size(), 40u);
+    EXPECT_TRUE(transport.getIsLooping());
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        uint64_t expected = (i < 15) ? 95 + i : 100 + (i - 15) % 10;
+        ASSERT_EQ(frames[i], expected) << "frame " << i;
+    }
+
+    // plays through once cleared
+    transport.clearLoop();
+    frames = s_playBlock(transport, 40);
+    EXPECT_FALSE(transport.getIsLooping());
+    EXPECT_EQ(frames.back(), frames.front() + 39);
+
+    // past the loop end, plays to the end of the stream
+    transport.setLoop(100, 110);
+    transport.seek(990);
+    frames = s_playBlock(transport, 40);
+    EXPECT_EQ(frames.size(), 10u);
+    EXPECT_FALSE(transport.getIsPlaying());
+}
+
+
+TEST(TransportTest, ThreadTest)
+{
+    Transport transport;
+    transport.reset(1u << 30);
+
+    std::atomic_bool isDone(false);
+
+    // the callback plays contiguous frames whatever the UI posts
+    std::thread callback([&]()
+    {
+        while (!isDone.load())
+        {
+            std::vector<uint64_t> frames = s_playBlock(transport, 64);
+
+            for (size_t i = 1; i < frames.size(); ++i)
+            {
+                ASSERT_EQ(frames[i], frames[i - 1] + 1);
+            }
+        }
+    });
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        transport.seek(i * 1000);
+        transport.play();
+        if (i % 3 == 0)
+        {
+            transport.pause();
+        }
+    }
+
+    isDone.store(true);
+    callback.join();
+}
@@ -0,0 +1,212 @@
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "../src/wav_source.hpp"
+
+/// Write a little-endian WAV file with the given fmt chunk and sample bytes
+static void s_writeWav(const char* filepath, uint16_t formatTag, int channels,
+                       int sampleRate, int bytesPerSample,
+                       const std::vector<uint8_t>& sampleBytes,
+                       bool extensible = false)
+{
+    std::vector<uint8_t> bytes;
+
+    // little endian, nBytes up to 8
+    auto put = [&bytes](uint64_t value, int nBytes)
+    {
+        for (int i = 0; i < nBytes; ++i)
+        {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    };
+    auto putTag = [&bytes](const char* tag)
+    {
+        bytes.insert(bytes.end(), tag, tag + 4);
+    };
+
+    uint32_t fmtSize = extensible ? 40 : 16;
+    int blockAlign = channels * bytesPerSample;
+
+    putTag("RIFF");
+    put(4 + 8 + fmtSize + 8 + sampleBytes.size(), 4);
+    putTag("WAVE");
+
+    // an unknown chunk to skip, odd sized
+    putTag("LIST");
+    put(3, 4);
+    put(0, 4);
+
+    putTag("fmt ");
+    put(fmtSize, 4);
+    put(extensible ? 0xFFFE : formatTag, 2);
+    put(channels, 2);
+    put(sampleRate, 4);
+    put(sampleRate * blockAlign, 4);
+    put(blockAlign, 2);
+    put(bytesPerSample * 8, 2);
+    if (extensible)
+    {
+        put(22, 2);
+        put(bytesPerSample * 8, 2);
+        put(0, 4);
+        put(formatTag, 2);
+
+        // rest of the sub-format GUID
+        bytes.insert(bytes.end(), 14, 0);
+    }
+
+    putTag("data");
+    put(sampleBytes.size(), 4);
+    bytes.insert(bytes.end(), sampleBytes.begin(), sampleBytes.end());
+
+    FILE* file = fopen(filepath, "wb");
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+}
+
+
+TEST(WavSourceTest, Int16Test)
+{
+    // long enough for the SIMD path plus a scalar tail
+    const int channels = 2;
+    const int nFrames = 37;
+
+    std::vector<uint8_t> sampleBytes;
+    std::vector<float> expected;
+    for (int i = 0; i < nFrames * channels; ++i)
+    {
+        int16_t sample = static_cast<int16_t>(i * 1777 - 32768);
+        sampleBytes.push_back(static_cast<uint8_t>(sample & 0xFF));
+        sampleBytes.push_back(static_cast<uint8_t>((sample >> 8) & 0xFF));
+        expected.push_back(sample / 32768.0f);
+    }
+
+    const char* filepath = "wav_source_test_s16.wav";
+    s_writeWav(filepath, 1, channels, 44100, 2, sampleBytes);
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    EXPECT_EQ(source.getChannels(), channels);
+    EXPECT_EQ(source.getSampleRate(), 44100);
+    EXPECT_EQ(source.getTotalFrames(), static_cast<uint64_t>(nFrames));
+
+    // past the end is zero filled
+    std::vector<float> buffer((nFrames + 3) * channels, -1.0f);
+    EXPECT_EQ(source.readFrames(buffer.data(), 0, nFrames + 3),
+              static_cast<uint64_t>(nFrames));
+
+    for (int i = 0; i < nFrames * channels; ++i)
+    {
+        EXPECT_EQ(buffer[i], expected[i]);
+    }
+    for (int i = nFrames * channels; i < (nFrames + 3) * channels; ++i)
+    {
+        EXPECT_EQ(buffer[i], 0.0f);
+    }
+
+    // from the middle
+    EXPECT_EQ(source.peekFrames(buffer.data(), 30, 4), 4u);
+    EXPECT_EQ(buffer[0], expected[60]);
+    EXPECT_EQ(buffer[7], expected[67]);
+
+    source.close();
+    remove(filepath);
+}
+
+
+TEST(WavSourceTest, FormatsTest)
+{
+    const int nSamples = 21;
+    std::vector<float> buffer(nSamples);
+
+    // 8-bit unsigned
+    {
+        std::vector<uint8_t> sampleBytes;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            sampleBytes.push_back(static_cast<uint8_t>(i * 12));
+        }
+
+        const char* filepath = "wav_source_test_u8.wav";
+        s_writeWav(filepath, 1, 1, 8000, 1, sampleBytes);
+
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath));
+        source.readFrames(buffer.data(), 0, nSamples);
+        for (int i = 0; i < nSamples; ++i)
+        {
+            EXPECT_EQ(buffer[i], (i * 12 - 128) / 128.0f);
+        }
+        source.close();
+        remove(filepath);
+    }
+
+    // 24-bit in WAVE_FORMAT_EXTENSIBLE
+    {
+        std::vector<uint8_t> sampleBytes;
+        std::vector<float> expected;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            int32_t sample = (i - 10) * 800011;
+            sampleBytes.push_back(static_cast<uint8_t>(sample & 0xFF));
+            sampleBytes.push_back(static_cast<uint8_t>((sample >> 8) & 0xFF));
+            sampleBytes.push_back(static_cast<uint8_t>((sample >> 16) & 0xFF));
+            expected.push_back(sample / 8388608.0f);
+        }
+
+        const char* filepath = "wav_source_test_s24.wav";
+        s_writeWav(filepath, 1, 1, 96000, 3, sampleBytes, true);
+
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath));
+        EXPECT_EQ(source.getSampleRate(), 96000);
+        source.readFrames(buffer.data(), 0, nSamples);
+        for (int i = 0; i < nSamples; ++i)
+        {
+            EXPECT_EQ(buffer[i], expected[i]);
+        }
+        source.close();
+        remove(filepath);
+    }
+
+    // 32-bit float, as stored
+    {
+        std::vector<float> samples;
+        for (int i = 0; i < nSamples; ++i)
+        {
+            samples.push_back(0.1f * i - 1.0f);
+        }
+        std::vector<uint8_t> sampleBytes(nSamples * sizeof(float));
+        memcpy(sampleBytes.data(), samples.data(), sampleBytes.size());
+
+        const char* filepath = "wav_source_test_f32.wav";
+        s_writeWav(filepath, 3, 1, 48000, 4, sampleBytes);
+
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath));
+        source.readFrames(buffer.data(), 0, nSamples);
+        for (int i = 0; i < nSamples; ++i)
+        {
+            EXPECT_EQ(buffer[i], samples[i]);
+        }
+        source.close();
+        remove(filepath);
+    }
+}
+
+
+TEST(WavSourceTest, RejectTest)
+{
+    // compressed formats are not supported (mu-law)
+    const char* filepath = "wav_source_test_mulaw.wav";
+    s_writeWav(filepath, 7, 1, 8000, 1, std::vector<uint8_t>(16, 0));
+
+    WavSource source;
+    EXPECT_FALSE(source.open(filepath));
+    EXPECT_EQ(source.getTotalFrames(), 0u);
+    remove(filepath);
+
+    EXPECT_FALSE(source.open("wav_source_test_missing.wav"));
+}
@@ -0,0 +1,96 @@
+#include <vector>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include "../src/wav_writer.hpp"
+#include "../src/wav_source.hpp"
+
+TEST(WavWriterTest, RoundTripTest)
+{
+    const int channels = 3;
+    const int nFrames = 1001;
+
+    std::vector<float> frames(nFrames * channels);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        frames[i] = static_cast<float>(i) * 0.001f - 1.0f;
+    }
+
+    const char* filepath = "wav_writer_test.wav";
+
+    // in uneven pieces
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(filepath, channels, 22050));
+    EXPECT_TRUE(writer.write(frames.data(), 1));
+    EXPECT_TRUE(writer.write(frames.data() + channels, nFrames - 1));
+    EXPECT_EQ(writer.getFramesWritten(), static_cast<uint64_t>(nFrames));
+    EXPECT_TRUE(writer.close());
+    EXPECT_FALSE(writer.getIsOpen());
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    EXPECT_EQ(source.getChannels(), channels);
+    EXPECT_EQ(source.getSampleRate(), 22050);
+    ASSERT_EQ(source.getTotalFrames(), static_cast<uint64_t>(nFrames));
+
+    std::vector<float> read(frames.size());
+    EXPECT_EQ(source.readFrames(read.data(), 0, nFrames),
+              static_cast<uint64_t>(nFrames));
+    EXPECT_EQ(read, frames);
+
+    source.close();
+    remove(filepath);
+}
+
+
+TEST(WavWriterTest, EmptyTest)
+{
+    const char* filepath = "wav_writer_test_empty.wav";
+
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(filepath, 2, 48000));
+    EXPECT_TRUE(writer.close());
+
+    // a header and no frames
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    EXPECT_EQ(source.getTotalFrames(), 0u);
+
+    source.close();
+    remove(filepath);
+}
+
+
+TEST(WavWriterTest, FlushTest)
+{
+    const char* filepath = "wav_writer_test_flush.wav";
+
+    std::vector<float> frames(500, 0.25f);
+
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(filepath, 1, 44100));
+    EXPECT_TRUE(writer.write(frames.data(), 200));
+    EXPECT_TRUE(writer.flush());
+
+    // readable while still open, up to the flush
+    {
+        WavSource source;
+        ASSERT_TRUE(source.open(filepath));
+        EXPECT_EQ(source.getTotalFrames(), 200u);
+        source.close();
+    }
+
+    // later writes are appended, not over the header
+    EXPECT_TRUE(writer.write(frames.data(), 300));
+    EXPECT_TRUE(writer.close());
+
+    WavSource source;
+    ASSERT_TRUE(source.open(filepath));
+    ASSERT_EQ(source.getTotalFrames(), 500u);
+
+    std::vector<float> read(500);
+    EXPECT_EQ(source.readFrames(read.data(), 0, 500), 500u);
+    EXPECT_EQ(read, frames);
+
+    source.close();
+    remove(filepath);
+}